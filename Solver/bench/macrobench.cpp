@@ -0,0 +1,425 @@
+// Regression benchmark (make bench): every instance of a directory is solved
+// under a few fixed configurations (seeded random strategies included), each
+// run in a child process so that its peak RSS is its own. The results (nodes,
+// time, nodes/s, peak RSS) are written as JSON and compared against a stored
+// baseline: a changed search tree or solution count, a lower throughput or a
+// higher peak RSS beyond the tolerance fail the run.
+//
+// Long searches are cut by a node limit, so that their status, nodes and
+// solutions do not depend on the speed of the machine. The time limit is
+// only a safety net: a run that reaches it is compared on its throughput
+// and memory only, and a baseline is not written if one of its runs does.
+//
+//   macrobench --instances <dir> [--baseline baseline.json] [--output results.json]
+//              [--node-limit n] [--time-limit s] [--repeat n] [--tolerance fraction]
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "../src/api/cpsolver.h"
+#include "../src/io/json.h"
+
+using namespace std;
+
+namespace {
+
+// Search configurations of the suite (count_only: the solutions are not stored)
+struct BenchConfig {
+    const char* name;
+    const char* var_strategy;
+    const char* val_strategy;
+    bool mac;
+    unsigned int seed;
+};
+
+const BenchConfig CONFIGS[] = {
+    {"mac", "mrv", "lcv", true, 0},
+    {"fc", "mrv", "lcv", false, 0},
+    {"random", "random", "random", false, 12345},
+};
+
+struct BenchRun {
+    string instance;
+    string config;
+    string status;
+    unsigned long long solutions = 0;
+    long long nodes = 0;
+    long long backtracks = 0;
+    double load_ms = 0;
+    double time_ms = 0;       // Search only, fastest of the repetitions
+    double nodes_per_s = 0;
+    long peak_rss_kb = 0;     // Largest of the repetitions
+};
+
+struct MacroOptions {
+    string instances;
+    string baseline;
+    string output;
+    long long node_limit = 0;  // 0: that of the baseline, else DEFAULT_NODE_LIMIT
+    int time_limit_s = 0;      // 0: DEFAULT_TIME_LIMIT_S
+    int repeat = 3;            // Repetitions of the runs shorter than REPEAT_BELOW_MS
+    double tolerance = 0.25;   // Allowed throughput loss and RSS growth
+};
+
+const long long DEFAULT_NODE_LIMIT = 10000;
+const int DEFAULT_TIME_LIMIT_S = 60;
+// Runs longer than this are not repeated: their timing is stable enough
+const double REPEAT_BELOW_MS = 1000;
+// Timings below this are too coarse for a throughput comparison
+const double MIN_COMPARED_MS = 50;
+// RSS growth always tolerated (allocator and library noise)
+const long RSS_SLACK_KB = 2048;
+
+// Child process: one solve, results written on the pipe as one line
+void runChild(const string& path, const BenchConfig& config, const MacroOptions& options, int fd) {
+    ostringstream line;
+    try {
+        auto load_start = chrono::steady_clock::now();
+        CPModel model = CPModel::fromFile(path);
+        auto load_end = chrono::steady_clock::now();
+
+        SolverParams params;
+        params.var_strategy = config.var_strategy;
+        params.val_strategy = config.val_strategy;
+        params.ac3_at_each_node = config.mac;
+        params.count_only = true;
+        params.seed = config.seed;
+        params.num_threads = 1;
+        CPBudget budget;
+        budget.node_limit = options.node_limit;
+        budget.time_limit_ms = options.time_limit_s * 1000LL;
+
+        CPSession session(model);
+        session.setOptions(params);
+        session.setBudget(budget);
+        auto search_start = chrono::steady_clock::now();
+        CPStatus status = session.solve();
+        auto search_end = chrono::steady_clock::now();
+
+        line << "ok\t" << toString(status) << "\t" << session.getSolutionCount() << "\t"
+             << session.getNodesExplored() << "\t" << session.getBacktracks() << "\t"
+             << chrono::duration<double, milli>(load_end - load_start).count() << "\t"
+             << chrono::duration<double, milli>(search_end - search_start).count() << "\n";
+    } catch (const exception& e) {
+        line << "error\t" << e.what() << "\n";
+    }
+    string text = line.str();
+    ssize_t written = write(fd, text.data(), text.size());
+    _exit(written == static_cast<ssize_t>(text.size()) ? 0 : 1);
+}
+
+// Forks a child for one run; false (with the message in run.status) on failure
+bool runOnce(const string& path, const BenchConfig& config, const MacroOptions& options, BenchRun& run) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        run.status = "pipe() failed";
+        return false;
+    }
+    cout.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        run.status = "fork() failed";
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        runChild(path, config, options, fds[1]);
+    }
+    close(fds[1]);
+    string output;
+    char buffer[4096];
+    ssize_t count;
+    while ((count = read(fds[0], buffer, sizeof(buffer))) > 0) {
+        output.append(buffer, count);
+    }
+    close(fds[0]);
+
+    int wait_status = 0;
+    struct rusage usage;
+    if (wait4(pid, &wait_status, 0, &usage) < 0 || !WIFEXITED(wait_status) || WEXITSTATUS(wait_status) != 0) {
+        run.status = "child process failed";
+        return false;
+    }
+
+    istringstream in(output);
+    string kind;
+    getline(in, kind, '\t');
+    if (kind != "ok") {
+        getline(in, run.status);
+        return false;
+    }
+    BenchRun result;
+    getline(in, result.status, '\t');
+    in >> result.solutions >> result.nodes >> result.backtracks >> result.load_ms >> result.time_ms;
+    result.instance = run.instance;
+    result.config = run.config;
+    result.peak_rss_kb = usage.ru_maxrss; // Kilobytes on Linux
+    run = result;
+    return true;
+}
+
+bool runBenchmark(const string& path, const BenchConfig& config, const MacroOptions& options, BenchRun& run) {
+    run.instance = filesystem::path(path).filename().string();
+    run.config = config.name;
+    BenchRun best;
+    for (int attempt = 0; attempt < max(1, options.repeat); attempt++) {
+        BenchRun current = run;
+        if (!runOnce(path, config, options, current)) {
+            run.status = current.status;
+            return false;
+        }
+        if (attempt == 0 || current.time_ms < best.time_ms) {
+            long peak = max(best.peak_rss_kb, current.peak_rss_kb);
+            best = current;
+            best.peak_rss_kb = peak;
+        } else {
+            best.peak_rss_kb = max(best.peak_rss_kb, current.peak_rss_kb);
+        }
+        if (current.time_ms >= REPEAT_BELOW_MS) break;
+    }
+    best.nodes_per_s = best.time_ms > 0 ? best.nodes * 1000.0 / best.time_ms : 0;
+    run = best;
+    return true;
+}
+
+string runKey(const string& instance, const string& config) {
+    return instance + " [" + config + "]";
+}
+
+void writeResults(const string& path, const MacroOptions& options, const vector<BenchRun>& runs) {
+    ofstream file(path);
+    if (!file) {
+        cerr << "Cannot write " << path << endl;
+        return;
+    }
+    file << "{\"suite\": \"macro\", \"node_limit\": " << options.node_limit
+         << ", \"time_limit_s\": " << options.time_limit_s << ", \"runs\": [" << endl;
+    for (size_t i = 0; i < runs.size(); i++) {
+        const BenchRun& run = runs[i];
+        file << fixed << setprecision(2)
+             << "  {\"instance\": " << jsonString(run.instance)
+             << ", \"config\": " << jsonString(run.config)
+             << ", \"status\": " << jsonString(run.status)
+             << ", \"solutions\": " << run.solutions
+             << ", \"nodes\": " << run.nodes
+             << ", \"backtracks\": " << run.backtracks
+             << ", \"load_ms\": " << run.load_ms
+             << ", \"time_ms\": " << run.time_ms
+             << ", \"nodes_per_s\": " << setprecision(0) << run.nodes_per_s
+             << ", \"peak_rss_kb\": " << run.peak_rss_kb << "}"
+             << (i + 1 < runs.size() ? "," : "") << endl;
+    }
+    file << "]}" << endl;
+}
+
+map<string, BenchRun> readBaseline(const string& path, long long& node_limit) {
+    ifstream file(path);
+    if (!file) {
+        throw runtime_error("cannot read the baseline " + path + " (make bench-baseline creates it)");
+    }
+    stringstream content;
+    content << file.rdbuf();
+    JsonValue root = JsonValue::parse(content.str());
+    node_limit = root.has("node_limit") ? root["node_limit"].asInteger() : 0;
+    map<string, BenchRun> baseline;
+    for (const JsonValue& item : root["runs"].asArray()) {
+        BenchRun run;
+        run.instance = item["instance"].asString();
+        run.config = item["config"].asString();
+        run.status = item["status"].asString();
+        run.solutions = static_cast<unsigned long long>(item["solutions"].asInteger());
+        run.nodes = item["nodes"].asInteger();
+        run.time_ms = item["time_ms"].asNumber();
+        run.nodes_per_s = item["nodes_per_s"].asNumber();
+        run.peak_rss_kb = static_cast<long>(item["peak_rss_kb"].asInteger());
+        baseline[runKey(run.instance, run.config)] = run;
+    }
+    return baseline;
+}
+
+// Regressions of run against its baseline entry, one message each
+vector<string> compareRun(const BenchRun& run, const BenchRun& base, double tolerance) {
+    vector<string> failures;
+    // A run stopped by the clock explored a machine-dependent part of the
+    // tree: only its throughput and memory are compared
+    string timeout = toString(CPStatus::TIMEOUT);
+    bool deterministic = run.status != timeout && base.status != timeout;
+    if (deterministic && run.status != base.status) {
+        failures.push_back("status \"" + run.status + "\", baseline \"" + base.status + "\"");
+        return failures;
+    }
+    // Otherwise the search must explore the same tree (fixed seeds, node limit)
+    if (deterministic && run.solutions != base.solutions) {
+        failures.push_back(to_string(run.solutions) + " solutions, baseline " + to_string(base.solutions));
+    }
+    if (deterministic && run.nodes != base.nodes) {
+        failures.push_back(to_string(run.nodes) + " nodes, baseline " + to_string(base.nodes));
+    }
+    if (base.time_ms >= MIN_COMPARED_MS && run.nodes_per_s < base.nodes_per_s * (1 - tolerance)) {
+        ostringstream message;
+        message << fixed << setprecision(0) << run.nodes_per_s << " nodes/s, baseline " << base.nodes_per_s
+                << " (" << setprecision(1) << (run.nodes_per_s / base.nodes_per_s - 1) * 100 << "%)";
+        failures.push_back(message.str());
+    }
+    if (run.peak_rss_kb > base.peak_rss_kb * (1 + tolerance) + RSS_SLACK_KB) {
+        failures.push_back("peak RSS " + to_string(run.peak_rss_kb) + " KB, baseline " +
+                           to_string(base.peak_rss_kb) + " KB");
+    }
+    return failures;
+}
+
+bool parseOptions(int argc, char* argv[], MacroOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--instances" && i + 1 < argc) {
+            options.instances = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            options.baseline = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (arg == "--node-limit" && i + 1 < argc) {
+            options.node_limit = max(1LL, stoll(argv[++i]));
+        } else if (arg == "--time-limit" && i + 1 < argc) {
+            options.time_limit_s = max(1, stoi(argv[++i]));
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            options.repeat = max(1, stoi(argv[++i]));
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            options.tolerance = stod(argv[++i]);
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            return false;
+        }
+    }
+    if (options.instances.empty()) {
+        cerr << "Usage: macrobench --instances <dir> [--baseline baseline.json] [--output results.json]"
+                " [--node-limit n] [--time-limit s] [--repeat n] [--tolerance fraction]" << endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    MacroOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    vector<string> paths;
+    try {
+        for (const auto& entry : filesystem::directory_iterator(options.instances)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".csp") {
+                paths.push_back(entry.path().string());
+            }
+        }
+    } catch (const filesystem::filesystem_error& e) {
+        cerr << "Cannot list " << options.instances << ": " << e.what() << endl;
+        return 1;
+    }
+    sort(paths.begin(), paths.end());
+    if (paths.empty()) {
+        cerr << "No .csp instance in " << options.instances << endl;
+        return 1;
+    }
+
+    map<string, BenchRun> baseline;
+    if (!options.baseline.empty()) {
+        long long baseline_node_limit = 0;
+        try {
+            baseline = readBaseline(options.baseline, baseline_node_limit);
+        } catch (const exception& e) {
+            cerr << "Baseline error: " << e.what() << endl;
+            return 1;
+        }
+        // The statuses (and thus the node counts) depend on the node limit
+        if (options.node_limit == 0) {
+            options.node_limit = baseline_node_limit;
+        } else if (options.node_limit != baseline_node_limit) {
+            cerr << "Warning: node limit " << options.node_limit << ", baseline measured with "
+                 << baseline_node_limit << endl;
+        }
+    }
+    if (options.node_limit <= 0) {
+        options.node_limit = DEFAULT_NODE_LIMIT;
+    }
+    if (options.time_limit_s <= 0) {
+        options.time_limit_s = DEFAULT_TIME_LIMIT_S;
+    }
+
+    cout << "Regression benchmark: " << paths.size() << " instances x " << size(CONFIGS)
+         << " configurations, " << options.node_limit << " nodes (" << options.time_limit_s
+         << "s) per run" << endl;
+    cout << left << setw(40) << "  Instance [config]" << setw(26) << "Status" << right
+         << setw(12) << "Nodes" << setw(11) << "Time (ms)" << setw(13) << "Nodes/s"
+         << setw(11) << "RSS (KB)" << setw(10) << "vs base" << endl;
+
+    vector<BenchRun> runs;
+    vector<string> regressions;
+    for (const string& path : paths) {
+        for (const BenchConfig& config : CONFIGS) {
+            BenchRun run;
+            if (!runBenchmark(path, config, options, run)) {
+                regressions.push_back(runKey(run.instance, run.config) + ": " + run.status);
+                cout << "  " << runKey(run.instance, run.config) << ": ERROR " << run.status << endl;
+                continue;
+            }
+            runs.push_back(run);
+            // A baseline only holds runs that do not depend on the clock
+            if (options.baseline.empty() && run.status == toString(CPStatus::TIMEOUT)) {
+                regressions.push_back(runKey(run.instance, run.config) + ": reached the time limit before "
+                                      "the node limit (raise --time-limit or lower --node-limit)");
+            }
+
+            string versus = "new";
+            auto base = baseline.find(runKey(run.instance, run.config));
+            if (baseline.empty()) {
+                versus = "";
+            } else if (base != baseline.end()) {
+                ostringstream delta;
+                double ratio = base->second.nodes_per_s > 0 ? run.nodes_per_s / base->second.nodes_per_s : 1;
+                delta << showpos << fixed << setprecision(1) << (ratio - 1) * 100 << "%";
+                versus = delta.str();
+                for (const string& failure : compareRun(run, base->second, options.tolerance)) {
+                    regressions.push_back(runKey(run.instance, run.config) + ": " + failure);
+                }
+            }
+            cout << "  " << left << setw(38) << runKey(run.instance, run.config) << setw(26) << run.status
+                 << right << setw(12) << run.nodes << setw(11) << fixed << setprecision(1) << run.time_ms
+                 << setw(13) << setprecision(0) << run.nodes_per_s << setw(11) << run.peak_rss_kb
+                 << setw(10) << versus << endl;
+        }
+    }
+
+    if (!options.output.empty() && (!options.baseline.empty() || regressions.empty())) {
+        writeResults(options.output, options, runs);
+        cout << "Results written to " << options.output << endl;
+    }
+    if (!regressions.empty()) {
+        cout << endl << "REGRESSIONS (" << regressions.size() << "):" << endl;
+        for (const string& regression : regressions) {
+            cout << "  " << regression << endl;
+        }
+        if (!options.baseline.empty()) {
+            cout << "Intended changes: make bench-baseline, then commit " << options.baseline << endl;
+        }
+        return 1;
+    }
+    if (!baseline.empty()) {
+        cout << "No regression against " << options.baseline << " (tolerance "
+             << static_cast<int>(options.tolerance * 100) << "%)" << endl;
+    }
+    return 0;
+}
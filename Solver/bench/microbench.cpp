@@ -0,0 +1,282 @@
+// Microbenchmarks of the solver kernels (make bench): parsing, constraint
+// checks, AC-3 revisions, forward checking and the selection heuristics,
+// timed on one instance. Each benchmark runs in samples of a fixed number of
+// operations; the median time per operation is reported.
+//
+//   microbench [--instance file.csp] [--samples n] [--sample-ms ms]
+//              [--seed n] [--output results.json]
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <array>
+#include <chrono>
+#include <algorithm>
+#include "../src/parser/parser.h"
+#include "../src/algorithms/ac3.h"
+#include "../src/solver/solver.h"
+#include "../src/strategies/strategies.h"
+#include "../src/core/compiled_model.h"
+#include "../src/io/json.h"
+
+using namespace std;
+
+// Access to the private kernels (friend of AC3Algorithm and CSPSolver)
+struct BenchAccess {
+    static bool revise(AC3Algorithm& ac3, int var1, int var2) {
+        return ac3.revise(var1, var2);
+    }
+    // Forward checking of var = value from the current node, then undone
+    // as on backtrack
+    static int forwardCheck(CSPSolver& solver, int var, int value) {
+        size_t mark = solver.trail.mark();
+        bool consistent = solver.forwardCheckWithDomainReduction(var, value);
+        solver.trail.undo(solver.domains, mark);
+        return consistent ? 1 : 0;
+    }
+};
+
+namespace {
+
+struct MicroResult {
+    string name;
+    double ns_per_op;
+    long long ops_per_sample;
+};
+
+struct MicroOptions {
+    string instance = "../instances/instances/nqueens_10.csp";
+    int samples = 7;
+    double sample_ms = 50;
+    unsigned int seed = 1;
+    string output;
+};
+
+volatile long long sink; // Keeps the results of the measured calls alive
+
+template <typename Body>
+double timeBatch(Body& body, long long ops) {
+    long long local = 0;
+    auto start = chrono::steady_clock::now();
+    for (long long i = 0; i < ops; i++) {
+        local += body();
+    }
+    auto end = chrono::steady_clock::now();
+    sink = sink + local;
+    return static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(end - start).count());
+}
+
+// body() performs one operation and returns a value folded into the sink
+template <typename Body>
+MicroResult measure(const string& name, Body body, const MicroOptions& options) {
+    // Grow the batch until it lasts a quarter of a sample, then scale it
+    double target_ns = options.sample_ms * 1e6;
+    long long ops = 1;
+    double elapsed = timeBatch(body, ops);
+    while (elapsed < target_ns / 4 && ops < (1LL << 40)) {
+        ops *= 2;
+        elapsed = timeBatch(body, ops);
+    }
+    ops = max(1LL, static_cast<long long>(ops * target_ns / max(elapsed, 1.0)));
+
+    vector<double> per_op;
+    for (int s = 0; s < options.samples; s++) {
+        per_op.push_back(timeBatch(body, ops) / ops);
+    }
+    sort(per_op.begin(), per_op.end());
+    MicroResult result{name, per_op[per_op.size() / 2], ops};
+    cout << "  " << left << setw(52) << name << right << setw(14) << fixed << setprecision(1)
+         << result.ns_per_op << " ns/op" << endl;
+    return result;
+}
+
+bool parseOptions(int argc, char* argv[], MicroOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--instance" && i + 1 < argc) {
+            options.instance = argv[++i];
+        } else if (arg == "--samples" && i + 1 < argc) {
+            options.samples = max(1, stoi(argv[++i]));
+        } else if (arg == "--sample-ms" && i + 1 < argc) {
+            options.sample_ms = max(1.0, stod(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = static_cast<unsigned int>(stoul(argv[++i]));
+        } else if (arg == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            cerr << "Usage: microbench [--instance file.csp] [--samples n] [--sample-ms ms]"
+                    " [--seed n] [--output results.json]" << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void writeResults(const MicroOptions& options, const vector<MicroResult>& results) {
+    ofstream file(options.output);
+    if (!file) {
+        cerr << "Cannot write " << options.output << endl;
+        return;
+    }
+    file << "{\"suite\": \"micro\", \"instance\": " << jsonString(options.instance)
+         << ", \"samples\": " << options.samples << ", \"results\": [" << endl;
+    for (size_t i = 0; i < results.size(); i++) {
+        const MicroResult& result = results[i];
+        file << "  {\"name\": " << jsonString(result.name)
+             << ", \"ns_per_op\": " << fixed << setprecision(2) << result.ns_per_op
+             << ", \"ops_per_sample\": " << result.ops_per_sample << "}"
+             << (i + 1 < results.size() ? "," : "") << endl;
+    }
+    file << "]}" << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    MicroOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    CSPInstance csp;
+    try {
+        csp = parseCSPFile(options.instance);
+    } catch (const exception& e) {
+        cerr << "Cannot read " << options.instance << ": " << e.what() << endl;
+        return 1;
+    }
+    if (csp.num_variables == 0 || csp.constraints.empty()) {
+        cerr << options.instance << ": the microbenchmarks need variables and constraints" << endl;
+        return 1;
+    }
+
+    vector<Domain> full_domains;
+    for (int var = 0; var < csp.num_variables; var++) {
+        full_domains.push_back(csp.getDomain(var));
+    }
+    vector<pair<int, int>> arcs;
+    for (const auto& constraint : csp.constraints) {
+        arcs.push_back({constraint.var1, constraint.var2});
+        arcs.push_back({constraint.var2, constraint.var1});
+    }
+    vector<pair<int, int>> assignments; // Every (var, value) of the instance
+    for (int var = 0; var < csp.num_variables; var++) {
+        for (int value : full_domains[var]) {
+            assignments.push_back({var, value});
+        }
+    }
+
+    cout << "Microbenchmarks on " << options.instance << " (" << csp.num_variables << " variables, "
+         << csp.constraints.size() << " constraints), median of " << options.samples << " samples" << endl;
+    vector<MicroResult> results;
+
+    results.push_back(measure("parseCSPFile", [&]() {
+        return static_cast<long long>(parseCSPFile(options.instance).constraints.size());
+    }, options));
+
+    // Constraint checks on random pairs of values of constrained variables
+    mt19937 rng(options.seed);
+    vector<array<int, 4>> checks(4096);
+    for (auto& check : checks) {
+        const auto& constraint = csp.constraints[rng() % csp.constraints.size()];
+        // The initial domains are intervals
+        const Domain& domain1 = full_domains[constraint.var1];
+        const Domain& domain2 = full_domains[constraint.var2];
+        check = {constraint.var1, domain1.min() + static_cast<int>(rng() % domain1.size()),
+                 constraint.var2, domain2.min() + static_cast<int>(rng() % domain2.size())};
+    }
+    size_t check_index = 0;
+    results.push_back(measure("CSPInstance::isConsistent", [&]() {
+        const auto& check = checks[check_index++ & (checks.size() - 1)];
+        return static_cast<long long>(csp.isConsistent(check[0], check[1], check[2], check[3]));
+    }, options));
+
+    // Revisions of every arc on the initial domains
+    AC3Algorithm revise_ac3(csp);
+    revise_ac3.setDomains(full_domains);
+    size_t arc_index = 0;
+    results.push_back(measure("AC3Algorithm::revise", [&]() {
+        const auto& arc = arcs[arc_index];
+        arc_index = arc_index + 1 < arcs.size() ? arc_index + 1 : 0;
+        bool changed = BenchAccess::revise(revise_ac3, arc.first, arc.second);
+        if (changed) revise_ac3.setDomains(full_domains);
+        return static_cast<long long>(changed);
+    }, options));
+
+    // Full AC-3 after fixing one variable; the worklist is filled by the
+    // constructor, so each operation builds its AC3Algorithm as applyAC3() does
+    vector<Domain> fixed_domains = full_domains;
+    size_t apply_index = 0;
+    results.push_back(measure("AC3Algorithm::apply (one variable fixed)", [&]() {
+        const auto& fixed_value = assignments[apply_index];
+        apply_index = apply_index + 1 < assignments.size() ? apply_index + 1 : 0;
+        fixed_domains[fixed_value.first] = Domain(fixed_value.second, fixed_value.second);
+        AC3Algorithm ac3(csp);
+        ac3.setDomains(fixed_domains);
+        fixed_domains[fixed_value.first] = full_domains[fixed_value.first];
+        return static_cast<long long>(ac3.apply(false));
+    }, options));
+
+    // Forward checking at the root of a prepared search, undone on the trail
+    CSPSolver solver(csp);
+    solver.setRandomSeed(options.seed);
+    SolverParams search;
+    search.max_time = 3600;
+    search.val_strategy = "lexicographic";
+    search.ac3_at_each_node = false;
+    solver.beginSearch(search);
+    size_t fc_index = 0;
+    results.push_back(measure("CSPSolver::forwardCheckWithDomainReduction (+undo)", [&]() {
+        const auto& candidate = assignments[fc_index];
+        fc_index = fc_index + 1 < assignments.size() ? fc_index + 1 : 0;
+        return static_cast<long long>(BenchAccess::forwardCheck(solver, candidate.first, candidate.second));
+    }, options));
+
+    // Heuristics as called by the search kernels, on the initial domains
+    Assignment assignment(csp.num_variables);
+    CompiledModel model(csp);
+    SelectionStrategies strategies(csp, full_domains, assignment, solver.getInteractionGraph(), &model);
+    strategies.seed(options.seed);
+    results.push_back(measure("SelectionStrategies::selectVariable<MRV>", [&]() {
+        return static_cast<long long>(strategies.selectVariable<VariableStrategy::MRV>());
+    }, options));
+    results.push_back(measure("SelectionStrategies::selectVariable<DEGREE>", [&]() {
+        return static_cast<long long>(strategies.selectVariable<VariableStrategy::DEGREE>());
+    }, options));
+    results.push_back(measure("SelectionStrategies::selectVariable<RANDOM>", [&]() {
+        return static_cast<long long>(strategies.selectVariable<VariableStrategy::RANDOM>());
+    }, options));
+
+    size_t max_domain_size = 0;
+    for (const auto& domain : full_domains) {
+        max_domain_size = max(max_domain_size, domain.size());
+    }
+    FixedStack<int> ordered;
+    ordered.reserve(max_domain_size);
+    int order_var = 0;
+    auto orderValues = [&](auto strategy) {
+        return [&, strategy]() {
+            ordered.truncate(0);
+            int var = order_var;
+            order_var = order_var + 1 < csp.num_variables ? order_var + 1 : 0;
+            return static_cast<long long>(strategies.orderValues<decltype(strategy)::value>(var, ordered));
+        };
+    };
+    results.push_back(measure("SelectionStrategies::orderValues<LCV>",
+        orderValues(integral_constant<ValueStrategy, ValueStrategy::LCV>()), options));
+    results.push_back(measure("SelectionStrategies::orderValues<RANDOM>",
+        orderValues(integral_constant<ValueStrategy, ValueStrategy::RANDOM>()), options));
+    results.push_back(measure("SelectionStrategies::orderValues<LEXICOGRAPHIC>",
+        orderValues(integral_constant<ValueStrategy, ValueStrategy::LEXICOGRAPHIC>()), options));
+
+    if (!options.output.empty()) {
+        writeResults(options, results);
+        cout << "Results written to " << options.output << endl;
+    }
+    return 0;
+}
@@ -10,28 +10,34 @@
 #include <algorithm>
 #include <memory>
 #include <cstdlib> // For system()
-// #include <sys/resource.h> // For memory usage
+#include <unistd.h> // For STDIN_FILENO
 
 // Custom headers
 #include "src/parser/parser.h"
 #include "src/solver/solver.h"
+#include "src/solver/decomposition.h"
+#include "src/solver/model_counter.h"
+#include "src/solver/tree_decomposition.h"
+#include "src/solver/checkpoint.h"
+#include "src/core/compiled_model.h"
 #include "src/algorithms/ac3.h"
+#include "src/algorithms/interchangeability.h"
+#include "src/algorithms/symmetry.h"
 #include "src/strategies/strategies.h"
 #include "src/io/solution_writer.h"
+#include "src/io/stats_writer.h"
+#include "src/io/progress_reporter.h"
+#include "src/io/trace_writer.h"
+#include "src/io/batch.h"
+#include "src/io/server.h"
 #include "src/core/params.h"
+#include "src/core/alloc_counter.h"
+#include "src/core/stats.h"
+#include "src/core/thread_pool.h"
 #include "src/io/logo.h"
 
 using namespace std;
 
-// Function to get current memory usage in MB
-/*
-long getMemoryUsage() {
-    struct rusage usage;
-    getrusage(RUSAGE_SELF, &usage);
-    return usage.ru_maxrss / 1024; // Convert to MB
-}
-*/
-
 // Function to count lines in a file
 int countFileLines(const string& filename) {
     ifstream file(filename);
@@ -50,16 +56,55 @@ int countFileLines(const string& filename) {
 void printHelp() {
     cout << "Usage: " << endl;
     cout << "  CPSolver <file.csp> [options]" << endl;
+    cout << "  CPSolver --batch <directory|list> [options]" << endl;
+    cout << "  CPSolver --serve <socket> [options]" << endl;
+    cout << "  CPSolver --client <socket> < requests.jsonl" << endl;
     cout << endl;
     cout << "Options:" << endl;
     cout << "  -t <time>      Maximum solving time in seconds (default: 300)" << endl;
     cout << "  -f             Stop at first solution found" << endl;
+    cout << "  -C             Count the solutions without storing them" << endl;
     cout << "  -v <strategy>  Variable selection strategy: mrv, degree, random (default: mrv)" << endl;
     cout << "  -w <strategy>  Value selection strategy: lcv, random, lexicographic (default: lcv)" << endl;
+    cout << "  --seed <n>     Seed of the random strategies, for reproducible runs (default: 0 = random)" << endl;
     cout << "  -a             Disable AC-3" << endl;
     cout << "  -c             Disable forward checking" << endl;
     cout << "  -n             Disable AC-3 at each backtracking node" << endl;
+    cout << "  -s             Enable singleton arc consistency (SAC) preprocessing" << endl;
+    cout << "  -S <ms>        Time budget of the SAC preprocessing (default: 5000)" << endl;
+    cout << "  -I             Merge interchangeable values (same supports on every constraint): the" << endl;
+    cout << "                 search tries one value per class, solutions and counts are expanded" << endl;
+    cout << "  -B             Break symmetries: value symmetry (detected) or the symmetries declared" << endl;
+    cout << "                 in the instance header; counts include every symmetric solution" << endl;
+    cout << "  --orbits       With -B, output the whole orbit of each canonical solution" << endl;
+    cout << "  -p <threads>   Worker threads (default: 0 = all hardware threads)" << endl;
+    cout << "  -d             Solve the connected components independently (uses -p threads)" << endl;
+    cout << "  -T             Search along a tree decomposition (BTD) for low-treewidth instances" << endl;
+    cout << "  -j             Enable conflict-directed backjumping (CBJ)" << endl;
+    cout << "  -l             Enable nogood learning (implies -j)" << endl;
+    cout << "  -g <count>     Nogood database capacity (default: 10000)" << endl;
+    cout << "  -k             Count the solutions with the component caching counter (implies -C)" << endl;
+    cout << "  -K <MB>        Memory budget of the counter's cache and of the BTD records (default: 256)" << endl;
+    cout << "  --checkpoint <file>   Save the search state periodically, at timeout and at the end" << endl;
+    cout << "  --checkpoint-interval <s>  Seconds between two checkpoints (default: 60)" << endl;
+    cout << "  --resume <file>       Resume the search saved in a checkpoint (same instance and options)" << endl;
+    cout << "  --stats-json <file>   Write per-phase times, search counters (checks, wipeouts, depth)" << endl;
+    cout << "                 and peak memory as JSON" << endl;
+    cout << "  --progress <s>        Print the progress on stderr every s seconds: nodes/s, depth," << endl;
+    cout << "                 solutions, explored part of the tree and estimated nodes left" << endl;
+    cout << "  --progress-json       Progress lines as JSON (implies --progress 5 if not given)" << endl;
+    cout << "  --trace <file>        Record every node event (depth, variable, value, outcome, values" << endl;
+    cout << "                 pruned) in a binary trace; convert it with ./cptrace" << endl;
     cout << "  -o <path>      Output file path (default: ../solutions/solutions/<filename>.sol)" << endl;
+    cout << "                 With --batch: directory of the .sol files (default: ../solutions/solutions)" << endl;
+    cout << "  --batch <dir|list>  Solve every .csp of a directory or of a list file (one path per line)" << endl;
+    cout << "                 in parallel on -p threads; -t is the limit of each instance" << endl;
+    cout << "  --summary <file>    Batch summary table, CSV or JSON if it ends with .json" << endl;
+    cout << "                 (default: <output directory>/batch_summary.csv)" << endl;
+    cout << "  --serve <socket>    Answer JSON-line requests on a Unix socket, keeping compiled models" << endl;
+    cout << "                 in an LRU cache; the other options are the defaults of the requests" << endl;
+    cout << "  --cache <count>     Models kept by the server (default: 32)" << endl;
+    cout << "  --client <socket>   Send the requests read on stdin to a server, print the responses" << endl;
     cout << "  -V             Verbose mode (show detailed tracing)" << endl;
     cout << "  -h             Show this help" << endl;
     cout << endl;
@@ -80,31 +125,83 @@ void printHelp() {
     cout << "  CPSolver instance.csp -v degree -w random" << endl;
     cout << "  CPSolver instance.csp -o my_solution.sol" << endl;
     cout << "  CPSolver instance.csp -V" << endl;
+    cout << "  CPSolver --batch ../instances/instances -t 60 --summary results.json" << endl;
 }
 
-// Function to parse command line arguments
-SolverParams parseArguments(int argc, char* argv[], bool& B) {
+// Function to parse command line arguments (options start at argv[first_option])
+SolverParams parseArguments(int argc, char* argv[], bool& B, int first_option = 2) {
     SolverParams params;
     
-    for (int i = 2; i < argc; i++) {
+    for (int i = first_option; i < argc; i++) {
         string arg = argv[i];
         
         if (arg == "-t" && i + 1 < argc) {
             params.max_time = stoi(argv[++i]);
         } else if (arg == "-f") {
             params.first_solution_only = true;
+        } else if (arg == "-C") {
+            params.count_only = true;
+        } else if (arg == "-d") {
+            params.decompose = true;
+        } else if (arg == "-T") {
+            params.use_tree_decomposition = true;
         } else if (arg == "-v" && i + 1 < argc) {
             params.var_strategy = argv[++i];
         } else if (arg == "-w" && i + 1 < argc) {
             params.val_strategy = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            params.seed = static_cast<unsigned int>(stoul(argv[++i]));
         } else if (arg == "-a") {
             params.use_ac3 = false;
         } else if (arg == "-c") {
             params.use_forward_checking = false;
         } else if (arg == "-n") {
             params.ac3_at_each_node = false;
+        } else if (arg == "-s") {
+            params.use_sac = true;
+        } else if (arg == "-S" && i + 1 < argc) {
+            params.sac_max_time_ms = stoi(argv[++i]);
+        } else if (arg == "-I") {
+            params.merge_interchangeable = true;
+        } else if (arg == "-B") {
+            params.break_symmetries = true;
+        } else if (arg == "--orbits") {
+            params.break_symmetries = true;
+            params.expand_orbits = true;
+        } else if (arg == "-p" && i + 1 < argc) {
+            params.num_threads = stoi(argv[++i]);
+        } else if (arg == "-j") {
+            params.use_cbj = true;
+        } else if (arg == "-l") {
+            params.use_nogoods = true;
+            params.use_cbj = true;
+        } else if (arg == "-g" && i + 1 < argc) {
+            params.max_nogoods = stoi(argv[++i]);
+        } else if (arg == "-k") {
+            params.use_counter = true;
+            params.count_only = true;
+        } else if (arg == "-K" && i + 1 < argc) {
+            params.counter_cache_mb = stoi(argv[++i]);
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            params.checkpoint_path = argv[++i];
+        } else if (arg == "--checkpoint-interval" && i + 1 < argc) {
+            params.checkpoint_interval = stoi(argv[++i]);
+        } else if (arg == "--resume" && i + 1 < argc) {
+            params.resume_path = argv[++i];
         } else if (arg == "-o" && i + 1 < argc) {
             params.output_path = argv[++i];
+        } else if (arg == "--stats-json" && i + 1 < argc) {
+            params.stats_json_path = argv[++i];
+        } else if (arg == "--progress" && i + 1 < argc) {
+            params.progress_interval = stod(argv[++i]);
+        } else if (arg == "--progress-json") {
+            params.progress_json = true;
+        } else if (arg == "--trace" && i + 1 < argc) {
+            params.trace_path = argv[++i];
+        } else if (arg == "--summary" && i + 1 < argc) {
+            params.summary_path = argv[++i];
+        } else if (arg == "--cache" && i + 1 < argc) {
+            params.cache_models = stoi(argv[++i]);
         } else if (arg == "-V") {
             params.verbose = true;
             params.show_global_stats_only = false;
@@ -121,7 +218,88 @@ SolverParams parseArguments(int argc, char* argv[], bool& B) {
     return params;
 }
 
+// Batch mode: CPSolver --batch <directory|list> [options]
+int runBatchCommand(int argc, char* argv[]) {
+    if (argc < 3) {
+        cerr << "ERROR: --batch requires a directory or a list file" << endl;
+        printHelp();
+        return 1;
+    }
+    
+    bool B = false;
+    SolverParams params = parseArguments(argc, argv, B, 3);
+    if (B) return 1;
+    if (!params.use_ac3) {
+        params.ac3_at_each_node = false;
+    }
+    // Jobs run the chronological search of the embeddable API
+    if (params.use_cbj || params.decompose || params.use_counter || params.use_tree_decomposition ||
+        params.merge_interchangeable || params.break_symmetries ||
+        !params.checkpoint_path.empty() || !params.resume_path.empty()) {
+        cerr << "ERROR: --batch uses the chronological search (not -j, -l, -d, -k, -T, -I, -B, --checkpoint or --resume)" << endl;
+        return 1;
+    }
+    if (!params.stats_json_path.empty() || params.progress_interval > 0 || params.progress_json ||
+        !params.trace_path.empty()) {
+        cerr << "ERROR: --stats-json, --progress and --trace apply to a single instance (the batch summary has the statistics)" << endl;
+        return 1;
+    }
+    
+    vector<string> instances;
+    string error;
+    if (!listBatchInstances(argv[2], instances, error)) {
+        cerr << "ERROR: " << error << endl;
+        return 1;
+    }
+    if (instances.empty()) {
+        cerr << "ERROR: No .csp instance in " << argv[2] << endl;
+        return 1;
+    }
+    string output_dir = params.output_path.empty() ? "../solutions/solutions" : params.output_path;
+    string summary_file = params.summary_path.empty() ? output_dir + "/batch_summary.csv" : params.summary_path;
+    
+    cout << "┌─────────────────────────────────────────────────────────────────────────────┐" << endl;
+    cout << "│                              BATCH SOLVING                                  │" << endl;
+    cout << "└─────────────────────────────────────────────────────────────────────────────┘" << endl;
+    cout << instances.size() << " instances, " << ThreadPool::resolveThreadCount(params.num_threads)
+         << " in parallel, time limit per instance: " << params.max_time << "s" << endl << endl;
+    
+    auto start_time = chrono::high_resolution_clock::now();
+    vector<BatchResult> results = runBatch(instances, params, output_dir);
+    long long wall_ms = chrono::duration_cast<chrono::milliseconds>(
+        chrono::high_resolution_clock::now() - start_time).count();
+    
+    map<string, int> status_counts;
+    long long total_job_ms = 0;
+    for (const BatchResult& result : results) {
+        status_counts[result.status]++;
+        total_job_ms += result.time_ms;
+    }
+    
+    cout << endl;
+    cout << "┌─────────────────────────────────────────────────────────────────────────────┐" << endl;
+    cout << "│                                RESULTS                                      │" << endl;
+    cout << "└─────────────────────────────────────────────────────────────────────────────┘" << endl;
+    for (const auto& entry : status_counts) {
+        cout << entry.first << ": " << entry.second << endl;
+    }
+    cout << "Wall time: " << wall_ms << "ms (sum of the instance times: " << total_job_ms << "ms)" << endl;
+    cout << "Peak memory (process): " << peakRssKb() << " KB" << endl;
+    
+    if (!writeBatchSummary(summary_file, results)) {
+        cerr << "ERROR: Cannot write batch summary: " << summary_file << endl;
+        return 1;
+    }
+    cerr << "Solutions saved to: " << output_dir << endl;
+    cerr << "Summary saved to: " << summary_file << endl;
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
+    // The client's output is the server's JSON lines only
+    if (argc >= 3 && string(argv[1]) == "--client") {
+        return runClient(argv[2], STDIN_FILENO, cout);
+    }
     printLogo(cout);
     // Check arguments
     if (argc < 2) {
@@ -136,15 +314,39 @@ int main(int argc, char* argv[]) {
         return 0;
     }
     
+    if (string(argv[1]) == "--batch") {
+        return runBatchCommand(argc, argv);
+    }
+    if ((string(argv[1]) == "--serve" || string(argv[1]) == "--client") && argc < 3) {
+        cerr << "ERROR: " << argv[1] << " requires a socket path" << endl;
+        return 1;
+    }
+    if (string(argv[1]) == "--serve") {
+        bool B = false;
+        SolverParams params = parseArguments(argc, argv, B, 3);
+        if (B) return 1;
+        if (params.use_cbj || params.decompose || params.use_counter || params.use_tree_decomposition ||
+            params.merge_interchangeable || params.break_symmetries ||
+            !params.checkpoint_path.empty() || !params.resume_path.empty()) {
+            cerr << "ERROR: --serve uses the chronological search (not -j, -l, -d, -k, -T, -I, -B, --checkpoint or --resume)" << endl;
+            return 1;
+        }
+        if (!params.stats_json_path.empty() || params.progress_interval > 0 || params.progress_json ||
+            !params.trace_path.empty()) {
+            cerr << "ERROR: --stats-json, --progress and --trace apply to a single instance" << endl;
+            return 1;
+        }
+        return runServer(argv[2], params, params.cache_models);
+    }
+    
     string filename = argv[1];
     
-    // Check file existence
-    ifstream file(filename);
-    if (!file.good()) {
+    // Opened once: the parser reads this stream
+    ifstream file(filename, ios::binary);
+    if (!file.is_open()) {
         cerr << "ERROR: Cannot open file '" << filename << "'" << endl;
         return 1;
     }
-    file.close();
     
     // Parse parameters
     bool B = false;
@@ -156,7 +358,62 @@ int main(int argc, char* argv[]) {
     if (!params.use_ac3) {
         params.ac3_at_each_node = false;
     }
+    
+    // Checkpoints hold the decision stack of the chronological search; a
+    // resumed search keeps checkpointing to the same file by default
+    if (!params.resume_path.empty() && params.checkpoint_path.empty()) {
+        params.checkpoint_path = params.resume_path;
+    }
+    if (!params.checkpoint_path.empty() &&
+        (params.use_cbj || params.decompose || params.use_counter || params.use_tree_decomposition)) {
+        cerr << "ERROR: --checkpoint and --resume require the chronological search (not -j, -l, -d, -k or -T)" << endl;
+        return 1;
+    }
+    // Merged classes are expanded from the solutions of the chronological
+    // and CBJ searches; checkpoints do not record them
+    if (params.merge_interchangeable &&
+        (params.decompose || params.use_counter || params.use_tree_decomposition || !params.checkpoint_path.empty())) {
+        cerr << "ERROR: -I requires the chronological or CBJ search (not -d, -k, -T, --checkpoint or --resume)" << endl;
+        return 1;
+    }
+    // Symmetry breaking refutes values of the chronological search's nodes
+    if (params.break_symmetries &&
+        (params.use_cbj || params.decompose || params.use_counter || params.use_tree_decomposition ||
+         params.merge_interchangeable || !params.checkpoint_path.empty())) {
+        cerr << "ERROR: -B requires the chronological search (not -j, -l, -d, -k, -T, -I, --checkpoint or --resume)" << endl;
+        return 1;
+    }
+    // Progress and traces come from the chronological and CBJ searches only
+    if (params.progress_json && params.progress_interval <= 0) {
+        params.progress_interval = 5;
+    }
+    if ((params.progress_interval > 0 || !params.trace_path.empty()) &&
+        (params.decompose || params.use_counter || params.use_tree_decomposition)) {
+        cerr << "ERROR: --progress and --trace require the chronological or CBJ search (not -d, -k or -T)" << endl;
+        return 1;
+    }
+    TraceWriter trace_writer;
+    if (!params.trace_path.empty()) {
+        string error;
+        if (!trace_writer.open(params.trace_path, error)) {
+            cerr << "ERROR: Cannot record the trace: " << error << endl;
+            return 1;
+        }
+    }
+    SearchCheckpoint resume_checkpoint;
+    if (!params.resume_path.empty()) {
+        string error;
+        if (!readCheckpoint(params.resume_path, resume_checkpoint, error)) {
+            cerr << "ERROR: Cannot read checkpoint: " << error << endl;
+            return 1;
+        }
+    }
 
+    // Phase timers run only when the statistics are written
+    PhaseTimes phase_times;
+    PhaseTimes* timing = params.stats_json_path.empty() ? nullptr : &phase_times;
+    SearchCounters counters;
+    
     // --- Initial parsing and setup ---
     CSPInstance csp;
     string resolution_status = "Unknown";
@@ -167,14 +424,20 @@ int main(int argc, char* argv[]) {
         cout << "└─────────────────────────────────────────────────────────────────────────────┘" << endl;
         cout << "Parsing CSP file..." << endl;
         
-        csp = parseCSPFile(filename);
+        {
+            ScopedTimer timer(timing, Phase::PARSE);
+            csp = parseCSP(file);
+            file.close();
+        }
         parsing_ok = true;
 
         if (params.verbose) {
             cout << "   Variables: " << csp.num_variables << endl;
             cout << "   Constraints: " << csp.constraints.size() << endl;
+            cout << "   Distinct relations: " << csp.countRelations() << endl;
         } else {
-            cout << "   Variables: " << csp.num_variables << ", Constraints: " << csp.constraints.size() << endl;
+            cout << "   Variables: " << csp.num_variables << ", Constraints: " << csp.constraints.size()
+                 << " (" << csp.countRelations() << " distinct relations)" << endl;
         }
         cout << endl;
 
@@ -183,27 +446,127 @@ int main(int argc, char* argv[]) {
         resolution_status = "Parsing Error";
         // We will proceed to write an empty solution file
     }
+    
+    // A rejected resume leaves the solution file of the previous runs untouched
+    if (!params.resume_path.empty()) {
+        string error;
+        if (!parsing_ok) {
+            return 1;
+        }
+        if (!checkCheckpoint(resume_checkpoint, csp, checkpointOptions(params), error)) {
+            cerr << "ERROR: Cannot resume from checkpoint: " << error << endl;
+            return 1;
+        }
+    }
 
     // --- Solver execution ---
     vector<map<int, int>> solutions;
+    BigInt solution_count(0);
+    unique_ptr<ComponentSolver> decomposition; // Solutions combined lazily from the components
+    unique_ptr<InterchangeableValues> interchangeable; // Classes merged before the search (-I)
+    unique_ptr<Symmetries> symmetries;      // Symmetries broken during the search (-B)
+    unsigned long long canonical_solutions = 0;
+    long long symmetry_prunings = 0;
     long long solve_duration = 0;
-    int nodes_explored = 0;
-    int backtracks = 0;
+    long long nodes_explored = 0;
+    long long backtracks = 0;
+    long long backjumps = 0;
+    int max_jump_distance = 0;
+    double average_jump_distance = 0.0;
+    long long nogoods_learned = 0;
+    long long nogood_prunings = 0;
+    long long nogood_conflicts = 0;
+    size_t nogoods_stored = 0;
+    unsigned long long search_allocations = 0;
+    unsigned long long resumed_solutions = 0; // Solutions found before the resume (not listed again)
 
     if (parsing_ok) {
         cout << "Initializing solver..." << endl;
         CSPSolver solver(csp);
+        solver.setRandomSeed(params.seed);
+        solver.setPhaseTimes(timing);
+        
+        // A resumed search starts from the domains saved in the checkpoint
+        if (!params.resume_path.empty()) {
+            cout << "Resuming from checkpoint " << params.resume_path << ": "
+                 << resume_checkpoint.solution_count << " solutions, "
+                 << resume_checkpoint.nodes_explored << " nodes, "
+                 << resume_checkpoint.elapsed_ms << "ms of previous search" << endl << endl;
+        }
         
         // Apply AC-3 if requested
-        if (params.use_ac3) {
+        if (params.use_ac3 && params.resume_path.empty()) {
             cout << "Applying AC-3..." << endl;
-            if (!solver.applyAC3(params.verbose)) {
+            bool consistent;
+            {
+                ScopedTimer timer(timing, Phase::INITIAL_AC);
+                consistent = solver.applyAC3(params.verbose);
+            }
+            if (!consistent) {
                 cout << "   Inconsistent instance detected by AC-3" << endl;
                 resolution_status = "Inconsistent (AC-3)";
             }
             cout << "   AC-3 completed successfully" << endl << endl;
         }
         
+        // Apply SAC if requested
+        if (params.use_sac && params.resume_path.empty() && resolution_status == "Unknown") {
+            cout << "Applying SAC..." << endl;
+            bool consistent;
+            {
+                ScopedTimer timer(timing, Phase::PRESOLVE);
+                consistent = solver.applySAC(params.num_threads, params.sac_max_time_ms, params.verbose);
+            }
+            if (!consistent) {
+                cout << "   Inconsistent instance detected by SAC" << endl;
+                resolution_status = "Inconsistent (SAC)";
+            }
+            cout << endl;
+        }
+        
+        // Merge interchangeable values if requested
+        if (params.merge_interchangeable && resolution_status == "Unknown") {
+            cout << "Merging interchangeable values..." << endl;
+            {
+                ScopedTimer timer(timing, Phase::PRESOLVE);
+                // The search reuses the compiled model for LCV
+                auto model = make_shared<const CompiledModel>(csp);
+                solver.setCompiledModel(model);
+                interchangeable.reset(new InterchangeableValues(*model, solver.getDomains()));
+                solver.setDomains(interchangeable->compress(solver.getDomains()));
+                solver.setInterchangeableValues(interchangeable.get());
+            }
+            cout << "   " << interchangeable->getMergedValueCount() << " values merged into their class representative ("
+                 << interchangeable->getMergedVariables().size() << " variables)" << endl << endl;
+        }
+        
+        // Detect the symmetries to break if requested
+        if (params.break_symmetries && resolution_status == "Unknown") {
+            cout << "Detecting symmetries..." << endl;
+            string error;
+            symmetries.reset(new Symmetries());
+            {
+                ScopedTimer timer(timing, Phase::PRESOLVE);
+                if (symmetries->detect(csp, error) && !symmetries->empty()) {
+                    solver.setSymmetries(symmetries.get());
+                }
+            }
+            if (!error.empty()) {
+                cerr << "ERROR: " << error << endl;
+                resolution_status = "Symmetry Error";
+            } else if (symmetries->hasValueSymmetry()) {
+                cout << "   Value symmetry: every permutation of the " << symmetries->getValueCount()
+                     << " values [" << symmetries->getValueMin() << ", "
+                     << symmetries->getValueMin() + symmetries->getValueCount() - 1 << "]" << endl;
+            } else if (symmetries->getGroupSize() > 1) {
+                cout << "   Declared symmetries: group of " << symmetries->getGroupSize() << " elements ("
+                     << symmetries->getGeneratorCount() << " generators)" << endl;
+            } else {
+                cout << "   No symmetry found" << endl;
+            }
+            cout << endl;
+        }
+        
         if (resolution_status == "Unknown") { // Proceed only if consistent so far
             // Backtracking resolution
             cout << "┌─────────────────────────────────────────────────────────────────────────────┐" << endl;
@@ -212,62 +575,212 @@ int main(int argc, char* argv[]) {
             cout << "Starting backtracking resolution..." << endl;
             
             auto start_time = chrono::high_resolution_clock::now();
+            bool success = false;
+            bool timeout = false;
             
-            bool success = solver.solve(
-                solutions,
-                params.max_time,
-                params.first_solution_only,
-                params.var_strategy,
-                params.val_strategy,
-                params.use_forward_checking,
-                params.verbose,
-                params.ac3_at_each_node,
-                params.max_depth_trace,
-                params.max_depth_ac3_trace,
-                params.show_global_stats_only
-            );
+            if (params.use_counter) {
+                // Exact count: components are re-detected after each decision
+                CompiledModel model(csp);
+                ModelCounter counter(model, params.counter_cache_mb, params.max_time);
+                solution_count = counter.count(model.toBits(solver.getDomains()));
+                nodes_explored = counter.getDecisions();
+                timeout = counter.wasTimeout();
+                success = !timeout;
+                counter.printStats();
+            } else if (params.use_tree_decomposition) {
+                // Search exponential in the width of the decomposition only
+                CompiledModel model(csp);
+                TreeDecomposition tree(solver.getInteractionGraph());
+                cout << "   Tree decomposition: width " << tree.getWidth()
+                     << ", " << tree.getRoots().size() << " tree(s)" << endl;
+                
+                TreeSolver btd(model, tree, params.counter_cache_mb, params.max_time);
+                success = btd.solve(model.toBits(solver.getDomains()), params.first_solution_only, params.count_only);
+                solutions = btd.getSolutions();
+                solution_count = btd.getSolutionCount();
+                nodes_explored = btd.getNodesExplored();
+                backtracks = btd.getBacktracks();
+                timeout = btd.wasTimeout();
+                btd.printStats();
+            } else if (params.decompose) {
+                // Components of the filtered instance are searched independently
+                decomposition.reset(new ComponentSolver(csp, solver.getDomains(), solver.getInteractionGraph()));
+                cout << "   Components: " << decomposition->getComponentCount()
+                     << " (largest: " << decomposition->getLargestComponentSize() << " variables)" << endl;
+                
+                success = decomposition->solve(params);
+                solution_count = decomposition->getSolutionCount();
+                nodes_explored = decomposition->getNodesExplored();
+                backtracks = decomposition->getBacktracks();
+                timeout = decomposition->wasTimeout();
+            } else {
+                if (!params.checkpoint_path.empty()) {
+                    solver.setCheckpointing(params.checkpoint_path, params.checkpoint_interval);
+                }
+                if (!params.resume_path.empty()) {
+                    solver.setResumePoint(&resume_checkpoint);
+                }
+                if (!params.trace_path.empty()) {
+                    solver.setTraceBuffer(trace_writer.addBuffer());
+                    trace_writer.start(csp.num_variables);
+                }
+                // The reporter thread only reads what the search publishes
+                SearchProgress progress;
+                unique_ptr<ProgressReporter> reporter;
+                if (params.progress_interval > 0) {
+                    solver.setProgress(&progress);
+                    reporter.reset(new ProgressReporter(progress, params.progress_interval, params.progress_json, cerr));
+                    reporter->start();
+                }
+                success = solver.solve(solutions, params);
+                if (reporter) {
+                    reporter->stop();
+                    solver.setProgress(nullptr);
+                }
+                if (!params.trace_path.empty()) {
+                    solver.setTraceBuffer(nullptr);
+                    if (trace_writer.stop()) {
+                        cout << "   Trace: " << trace_writer.getEventsWritten() << " events written to "
+                             << params.trace_path << " (" << trace_writer.getStalls() << " waits for the writer)" << endl;
+                    } else {
+                        cerr << "ERROR: Cannot write the trace to " << params.trace_path << endl;
+                    }
+                }
+                solution_count = solver.getSolutionCount();
+                if ((interchangeable || (symmetries && !symmetries->empty())) && !params.first_solution_only) {
+                    // Each solution found stands for a product of classes
+                    // or for its orbit
+                    solution_count = solver.getRepresentedSolutionCount();
+                }
+                canonical_solutions = solver.getSolutionCount();
+                symmetry_prunings = solver.getSymmetryPrunings();
+                nodes_explored = solver.getNodesExplored();
+                backtracks = solver.getBacktracks();
+                backjumps = solver.getBackjumps();
+                max_jump_distance = solver.getMaxJumpDistance();
+                average_jump_distance = solver.getAverageJumpDistance();
+                if (const NogoodStore* store = solver.getNogoodStore()) {
+                    nogoods_learned = store->getLearnedCount();
+                    nogood_prunings = store->getPruningsCount();
+                    nogood_conflicts = store->getConflictsCount();
+                    nogoods_stored = store->size();
+                }
+                search_allocations = solver.getSearchAllocations();
+                resumed_solutions = solver.getResumedSolutionCount();
+                timeout = solver.wasTimeout();
+                if (!solver.getResumeError().empty()) {
+                    // Corrupted decisions: found while replaying them, nothing written yet
+                    cerr << "ERROR: Cannot resume from checkpoint: " << solver.getResumeError() << endl;
+                    return 1;
+                }
+            }
             
             auto end_time = chrono::high_resolution_clock::now();
             solve_duration = chrono::duration_cast<chrono::milliseconds>(end_time - start_time).count();
-            nodes_explored = solver.getNodesExplored();
-            backtracks = solver.getBacktracks();
+            if (timing) {
+                timing->add(Phase::SEARCH, chrono::duration_cast<chrono::nanoseconds>(end_time - start_time).count());
+            }
 
-            // Determine resolution status
-            if (success) {
-                if (solutions.empty()) {
-                    resolution_status = "No solution found";
+            // Determine resolution status (after a timeout, the solutions found
+            // so far are only part of them)
+            if (timeout && !(success && params.first_solution_only)) {
+                resolution_status = "Timeout";
+            } else if (success) {
+                if (solution_count.isZero()) {
+                    resolution_status = "No solution (full exploration)";
                 } else if (params.first_solution_only) {
                     resolution_status = "First solution found";
                 } else {
                     resolution_status = "All solutions found";
                 }
             } else {
-                if (solver.wasTimeout()) {
-                    resolution_status = "Timeout";
-                } else {
-                    resolution_status = "No solution (full exploration)";
-                }
+                resolution_status = "No solution (full exploration)";
             }
         }
+        counters = solver.getCounters();
     }
+    // The other engines (-k, -T, -d) only report their nodes and backtracks
+    counters.nodes = nodes_explored;
+    counters.backtracks = backtracks;
     
     // --- Display results ---
+    auto output_start = chrono::steady_clock::now();
     cout << endl;
     cout << "┌─────────────────────────────────────────────────────────────────────────────┐" << endl;
     cout << "│                                RESULTS                                      │" << endl;
     cout << "└─────────────────────────────────────────────────────────────────────────────┘" << endl;
     
     cout << "Resolution status: " << resolution_status << endl;
-    cout << "Solutions found: " << solutions.size() << endl;
+    cout << "Solutions found: " << solution_count;
+    if (params.count_only && resolution_status == "Timeout") {
+        cout << " (lower bound)";
+    }
+    cout << endl;
     cout << "Solving time: " << solve_duration << "ms" << endl;
     cout << "Nodes explored: " << nodes_explored << endl;
+    if (solve_duration > 0) {
+        // Only the nodes of this run count (a resumed search starts from the checkpoint's)
+        long long run_nodes = nodes_explored;
+        if (!params.resume_path.empty()) {
+            run_nodes = max(0LL, run_nodes - resume_checkpoint.nodes_explored);
+        }
+        cout << "Nodes per second: " << (run_nodes * 1000 / solve_duration) << endl;
+    }
+    if (heapAllocationCountEnabled()) {
+        // Both kernels work on the trail; CBJ also allocates conflict sets and nogoods
+        cout << "Heap allocations during search (" << (params.use_cbj ? "CBJ" : "chronological")
+             << " kernel): " << search_allocations << " ("
+             << (nodes_explored > 0 ? static_cast<double>(search_allocations) / nodes_explored : 0.0)
+             << " per node)" << endl;
+    }
     cout << "Backtracks: " << backtracks << endl;
+    if (params.use_cbj) {
+        cout << "Backjumps: " << backjumps << " (max distance: " << max_jump_distance
+             << ", average distance: " << average_jump_distance << ")" << endl;
+    }
+    if (symmetries && !symmetries->empty()) {
+        cout << "Canonical solutions: " << canonical_solutions << " (values pruned by symmetry: "
+             << symmetry_prunings << ")" << endl;
+    }
+    if (params.use_nogoods) {
+        cout << "Nogoods learned: " << nogoods_learned << " (stored: " << nogoods_stored
+             << ", prunings: " << nogood_prunings << ", conflicts: " << nogood_conflicts << ")" << endl;
+    }
+    if (params.show_memory_usage) {
+        cout << "Peak memory usage: " << peakRssKb() / 1024 << " MB" << endl;
+    }
     
-    if (!solutions.empty()) {
+    // Solutions come either from the stored list, from the lazy product
+    // of the component solutions, from the expansion of the merged classes
+    // or from the orbits of the canonical solutions
+    unique_ptr<SolutionProduct> product;
+    if (decomposition) {
+        product.reset(new SolutionProduct(decomposition->getSolutions()));
+    }
+    unique_ptr<ExpandedSolutions> expansion;
+    if (interchangeable && !params.first_solution_only) {
+        expansion.reset(new ExpandedSolutions(*interchangeable, solutions));
+    }
+    unique_ptr<SymmetricSolutions> orbits;
+    if (symmetries && !symmetries->empty() && params.expand_orbits && !params.first_solution_only) {
+        orbits.reset(new SymmetricSolutions(*symmetries, solutions));
+    }
+    size_t next_index = 0;
+    auto next_solution = [&](map<int, int>& solution) {
+        if (product) return product->next(solution);
+        if (expansion) return expansion->next(solution);
+        if (orbits) return orbits->next(solution);
+        if (next_index >= solutions.size()) return false;
+        solution = solutions[next_index++];
+        return true;
+    };
+    
+    if (!solution_count.isZero() && !params.count_only) {
         cout << endl << "Solutions:" << endl;
-        for (size_t i = 0; i < solutions.size(); i++) {
+        map<int, int> solution;
+        for (unsigned long long i = resumed_solutions; next_solution(solution); i++) {
             cout << "Solution " << (i + 1) << ": ";
-            for (const auto& assignment : solutions[i]) {
+            for (const auto& assignment : solution) {
                 cout << assignment.first << "=" << assignment.second << " ";
             }
             cout << endl;
@@ -291,8 +804,27 @@ int main(int argc, char* argv[]) {
         system("mkdir -p ../solutions/solutions");
     }
     
-    writeSolutions(output_file, solutions, csp, params, solve_duration, nodes_explored, resolution_status);
+    // Rewind the solution source before streaming it to the file
+    next_index = 0;
+    if (product) product->reset();
+    if (expansion) expansion->reset();
+    if (orbits) orbits->reset();
+    // Without --orbits, the file lists the canonical solutions only
+    bool canonical_listed = symmetries && !symmetries->empty() && !orbits && !params.count_only &&
+                            !params.first_solution_only;
+    writeSolutions(output_file, next_solution, canonical_listed ? BigInt(canonical_solutions) : solution_count,
+                   csp, params, solve_duration, nodes_explored, resolution_status, resumed_solutions,
+                   canonical_listed ? &solution_count : nullptr);
     cerr << "Solutions saved to: " << output_file << endl;
     
+    if (timing) {
+        timing->add(Phase::OUTPUT, chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - output_start).count());
+        if (writeStatsJson(params.stats_json_path, filename, csp, params, resolution_status, solution_count,
+                           phase_times, counters, peakRssKb())) {
+            cerr << "Statistics saved to: " << params.stats_json_path << endl;
+        }
+    }
+    
     return 0;
 }
\ No newline at end of file
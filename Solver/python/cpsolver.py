@@ -0,0 +1,231 @@
+"""In-process bindings of CPSolver (libcpsolver.so) for the benchmark notebooks.
+
+The module talks to the C interface of libcpsolver (src/api/cpsolver_c.h)
+through ctypes: no compilation step beyond ``make lib``. ctypes releases the
+GIL while the solver runs, so sweeps can be spread over Python threads, and
+solutions are returned as numpy arrays that view the solver's buffer.
+
+    import cpsolver
+    model = cpsolver.Model.from_file("../instances/instances/nqueens_8.csp")
+    result = model.solve(time_limit_ms=2000, solution_limit=10)
+    result.status          # "Solution limit reached"
+    result.solutions       # numpy int32 array (10, 8), no copy
+    result.stats           # {"solutions": 10, "nodes": ..., ...}
+
+The library is looked up in $CPSOLVER_LIB, then next to this file's parent
+directory (Solver/libcpsolver.so).
+"""
+
+import ctypes
+import os
+
+try:
+    import numpy as np
+except ImportError:  # Lists of lists instead of arrays
+    np = None
+
+__all__ = ["Model", "Session", "Result", "CPSolverError", "STATUSES"]
+
+STATUSES = ["All solutions found", "Solution limit reached", "Node limit reached",
+            "Timeout", "Cancelled", "Inconsistent"]
+
+
+class CPSolverError(RuntimeError):
+    pass
+
+
+def _load_library():
+    path = os.environ.get("CPSOLVER_LIB")
+    if not path:
+        here = os.path.dirname(os.path.abspath(__file__))
+        path = os.path.join(os.path.dirname(here), "libcpsolver.so")
+    lib = ctypes.CDLL(path)  # CDLL (not PyDLL): the GIL is released during calls
+
+    c_int_p = ctypes.POINTER(ctypes.c_int)
+    signatures = {
+        "cps_last_error": (ctypes.c_char_p, []),
+        "cps_status_name": (ctypes.c_char_p, [ctypes.c_int]),
+        "cps_model_new": (ctypes.c_void_p, []),
+        "cps_model_from_file": (ctypes.c_void_p, [ctypes.c_char_p]),
+        "cps_model_free": (None, [ctypes.c_void_p]),
+        "cps_model_add_variables": (ctypes.c_int, [ctypes.c_void_p, c_int_p, c_int_p, ctypes.c_size_t]),
+        "cps_model_add_constraint": (ctypes.c_int, [ctypes.c_void_p, ctypes.c_int, ctypes.c_int,
+                                                    c_int_p, ctypes.c_size_t]),
+        "cps_model_num_variables": (ctypes.c_int, [ctypes.c_void_p]),
+        "cps_model_compile": (None, [ctypes.c_void_p]),
+        "cps_session_new": (ctypes.c_void_p, [ctypes.c_void_p]),
+        "cps_session_free": (None, [ctypes.c_void_p]),
+        "cps_session_set_option": (ctypes.c_int, [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_char_p]),
+        "cps_session_restrict": (ctypes.c_int, [ctypes.c_void_p, ctypes.c_int, c_int_p, ctypes.c_size_t]),
+        "cps_session_solve": (ctypes.c_int, [ctypes.c_void_p]),
+        "cps_session_cancel": (None, [ctypes.c_void_p]),
+        "cps_session_solutions": (c_int_p, [ctypes.c_void_p, ctypes.POINTER(ctypes.c_size_t)]),
+        "cps_session_solution_count": (ctypes.c_ulonglong, [ctypes.c_void_p]),
+        "cps_session_nodes": (ctypes.c_longlong, [ctypes.c_void_p]),
+        "cps_session_backtracks": (ctypes.c_longlong, [ctypes.c_void_p]),
+        "cps_session_elapsed_ms": (ctypes.c_longlong, [ctypes.c_void_p]),
+    }
+    for name, (restype, argtypes) in signatures.items():
+        function = getattr(lib, name)
+        function.restype = restype
+        function.argtypes = argtypes
+    return lib
+
+
+_lib = _load_library()
+
+
+def _check(result):
+    if result is None or result == -1:
+        raise CPSolverError(_lib.cps_last_error().decode())
+    return result
+
+
+def _int_buffer(values, columns=None):
+    """Contiguous int32 buffer of values (numpy array or sequence) and its length."""
+    if np is not None:
+        array = np.ascontiguousarray(values, dtype=np.int32)
+        if columns is not None and array.size and (array.ndim != 2 or array.shape[1] != columns):
+            raise ValueError("expected an array of shape (n, %d)" % columns)
+        return array, array.ctypes.data_as(ctypes.POINTER(ctypes.c_int)), array.size
+    flat = []
+    for value in values:
+        if columns is None:
+            flat.append(int(value))
+        else:
+            if len(value) != columns:
+                raise ValueError("expected rows of %d values" % columns)
+            flat.extend(int(v) for v in value)
+    buffer = (ctypes.c_int * len(flat))(*flat)
+    return buffer, ctypes.cast(buffer, ctypes.POINTER(ctypes.c_int)), len(flat)
+
+
+class Model:
+    """Binary CSP: integer variables with interval domains and allowed pairs."""
+
+    def __init__(self, handle=None):
+        self._handle = handle if handle is not None else _check(_lib.cps_model_new())
+
+    @classmethod
+    def from_file(cls, path):
+        return cls(_check(_lib.cps_model_from_file(os.fsencode(path))))
+
+    @classmethod
+    def from_arrays(cls, mins, maxs, constraints=()):
+        """mins/maxs: domain bounds per variable; constraints: (var1, var2, pairs)
+        with pairs an (n, 2) array of allowed (var1 value, var2 value)."""
+        model = cls()
+        model.add_variables(mins, maxs)
+        for var1, var2, pairs in constraints:
+            model.add_constraint(var1, var2, pairs)
+        return model
+
+    def __del__(self):
+        if getattr(self, "_handle", None):
+            _lib.cps_model_free(self._handle)
+            self._handle = None
+
+    @property
+    def num_variables(self):
+        return _lib.cps_model_num_variables(self._handle)
+
+    def add_variables(self, mins, maxs):
+        """Adds len(mins) variables; returns the id of the first one."""
+        mins_buffer, mins_pointer, count = _int_buffer(mins)
+        maxs_buffer, maxs_pointer, max_count = _int_buffer(maxs)
+        if count != max_count:
+            raise ValueError("mins and maxs differ in length")
+        return _check(_lib.cps_model_add_variables(self._handle, mins_pointer, maxs_pointer, count))
+
+    def add_variable(self, min_value, max_value):
+        return self.add_variables([min_value], [max_value])
+
+    def add_constraint(self, var1, var2, pairs):
+        buffer, pointer, size = _int_buffer(pairs, columns=2)
+        _check(_lib.cps_model_add_constraint(self._handle, var1, var2, pointer, size // 2))
+
+    def compile(self):
+        """Builds the bitset form once for every later solve (LCV support counts)."""
+        _lib.cps_model_compile(self._handle)
+
+    def solve(self, restrict=None, **options):
+        """Shortcut for Session(self, restrict, **options).solve()."""
+        return Session(self, restrict, **options).solve()
+
+
+class Result:
+    """Outcome of a solve. solutions is an int32 array (count, num_variables)
+    viewing the session's buffer, or a list of lists without numpy."""
+
+    def __init__(self, session, status):
+        self.status = STATUSES[status]
+        handle = session._handle
+        self.stats = {
+            "status": self.status,
+            "solutions": _lib.cps_session_solution_count(handle),
+            "nodes": _lib.cps_session_nodes(handle),
+            "backtracks": _lib.cps_session_backtracks(handle),
+            "time_ms": _lib.cps_session_elapsed_ms(handle),
+        }
+        count = ctypes.c_size_t(0)
+        pointer = _lib.cps_session_solutions(handle, ctypes.byref(count))
+        width = session.model.num_variables
+        total = count.value * width
+        if np is None:
+            if width == 0:
+                # A model without variables has empty solutions
+                self.solutions = [[] for _ in range(count.value)]
+            else:
+                flat = pointer[:total] if total else []
+                self.solutions = [list(flat[i:i + width]) for i in range(0, total, width)]
+        elif total == 0:
+            self.solutions = np.zeros((count.value, width), dtype=np.int32)
+        else:
+            # The ctypes array keeps the session (and its buffer) alive for
+            # as long as the numpy view exists
+            buffer = (ctypes.c_int * total).from_address(ctypes.addressof(pointer.contents))
+            buffer._owner = session
+            self.solutions = np.ctypeslib.as_array(buffer).reshape(count.value, width)
+
+    def __repr__(self):
+        return "Result(%s)" % ", ".join("%s=%r" % item for item in self.stats.items())
+
+
+class Session:
+    """One search over a model. solve() may run in a Python thread while another
+    thread calls cancel(). The model must not change while sessions exist."""
+
+    _OPTIONS = {"time_limit_ms", "node_limit", "solution_limit", "var_strategy", "val_strategy",
+                "ac3", "mac", "forward_checking", "sac", "sac_time_ms", "threads", "count_only",
+                "seed"}
+
+    def __init__(self, model, restrict=None, **options):
+        self.model = model
+        self._handle = _check(_lib.cps_session_new(model._handle))
+        self._solved = False
+        for name, value in options.items():
+            if name not in self._OPTIONS:
+                raise TypeError("unknown option %r" % name)
+            if isinstance(value, bool):
+                value = int(value)
+            _check(_lib.cps_session_set_option(self._handle, name.encode(), str(value).encode()))
+        for var, values in (restrict or {}).items():
+            buffer, pointer, size = _int_buffer(values)
+            _check(_lib.cps_session_restrict(self._handle, var, pointer, size))
+
+    def __del__(self):
+        if getattr(self, "_handle", None):
+            _lib.cps_session_free(self._handle)
+            self._handle = None
+
+    def solve(self):
+        """Runs the search (without the GIL). A session is solved once: its
+        solutions buffer is shared with the Result."""
+        if self._solved:
+            raise CPSolverError("a session is solved once; create a new Session")
+        self._solved = True
+        status = _check(_lib.cps_session_solve(self._handle))
+        return Result(self, status)
+
+    def cancel(self):
+        _lib.cps_session_cancel(self._handle)
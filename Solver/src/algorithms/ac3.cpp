@@ -6,17 +6,24 @@
 
 using namespace std;
 
+// Values separated by ", " (verbose traces)
+static void printValues(const Domain& domain) {
+    bool first = true;
+    for (int value : domain) {
+        if (!first) cout << ", ";
+        cout << value;
+        first = false;
+    }
+}
+
 AC3Algorithm::AC3Algorithm(const CSPInstance& instance) 
-    : csp(instance), revisions_count(0) {
+    : csp(instance), revisions_count(0), checks_count(0), track_explanations(false),
+      wipeout_variable(-1), wipeout_support(-1) {
     
-    // Initialize domains from CSP instance
-    domains.resize(csp.num_variables);
+    // Initialize domains from CSP instance (intervals: no value is stored)
+    domains.reserve(csp.num_variables);
     for (int i = 0; i < csp.num_variables; i++) {
-        int min_val = csp.domains[i].first;
-        int max_val = csp.domains[i].second;
-        for (int val = min_val; val <= max_val; val++) {
-            domains[i].push_back(val);
-        }
+        domains.push_back(csp.getDomain(i));
     }
     
     // Initialize worklist with all arcs
@@ -30,7 +37,7 @@ bool AC3Algorithm::revise(int var1, int var2) {
     assert(var1 >= 0 && var1 < csp.num_variables && "revise(): var1 is out of bounds");
     assert(var2 >= 0 && var2 < csp.num_variables && "revise(): var2 is out of bounds");
     bool revised = false;
-    vector<int> new_domain;
+    vector<int> removed;
     
     for (int val1 : domains[var1]) {
         bool has_support = false;
@@ -42,16 +49,26 @@ bool AC3Algorithm::revise(int var1, int var2) {
             }
         }
         
-        if (has_support) {
-            new_domain.push_back(val1);
-        } else {
+        if (!has_support) {
+            removed.push_back(val1);
             revised = true;
         }
     }
     
     if (revised) {
-        domains[var1] = new_domain;
+        domains[var1].removeSorted(removed.data(), removed.size());
         revisions_count++;
+        
+        // The values removed from var1 lost their support in var2's current
+        // domain, so whatever reduced var2 also explains var1's reduction
+        if (track_explanations) {
+            vector<int>& target = explanations[var1];
+            for (int culprit : explanations[var2]) {
+                if (culprit != var1 && find(target.begin(), target.end(), culprit) == target.end()) {
+                    target.push_back(culprit);
+                }
+            }
+        }
     }
     
     return revised;
@@ -71,25 +88,31 @@ vector<Arc> AC3Algorithm::getArcs(int var) const {
     return arcs;
 }
 
-void AC3Algorithm::setDomains(const std::vector<std::vector<int>>& new_domains) {
+void AC3Algorithm::setDomains(const std::vector<Domain>& new_domains) {
     domains = new_domains;
 }
 
+void AC3Algorithm::setExplanations(const std::vector<std::vector<int>>& initial_explanations) {
+    explanations = initial_explanations;
+    track_explanations = true;
+}
+
+const vector<vector<int>>& AC3Algorithm::getExplanations() const {
+    return explanations;
+}
+
+int AC3Algorithm::getWipeoutVariable() const {
+    return wipeout_variable;
+}
+
 bool AC3Algorithm::isConsistent(int var1, int val1, int var2, int val2) const {
+    checks_count++;
     for (const auto& constraint : csp.constraints) {
         if ((constraint.var1 == var1 && constraint.var2 == var2) ||
             (constraint.var1 == var2 && constraint.var2 == var1)) {
             
             // Check if the pair (val1, val2) is in the allowed pairs
-            bool found = false;
-            for (const auto& pair : constraint.allowed_pairs) {
-                if ((pair.first == val1 && pair.second == val2) ||
-                    (pair.first == val2 && pair.second == val1)) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) return false;
+            if (!constraint.allows(val1, val2) && !constraint.allows(val2, val1)) return false;
         }
     }
     return true;
@@ -112,24 +135,20 @@ bool AC3Algorithm::apply(bool verbose) {
         if (verbose) {
             cout << "   Iteration " << iteration << ": Processing arc (" << arc.var1 << " -> " << arc.var2 << ")" << endl;
             cout << "     Domain " << arc.var1 << " before: [";
-            for (size_t i = 0; i < domains[arc.var1].size(); i++) {
-                cout << domains[arc.var1][i];
-                if (i < domains[arc.var1].size() - 1) cout << ", ";
-            }
+            printValues(domains[arc.var1]);
             cout << "]" << endl;
         }
         
         if (revise(arc.var1, arc.var2)) {
             if (verbose) {
                 cout << "     Domain " << arc.var1 << " after:  [";
-                for (size_t i = 0; i < domains[arc.var1].size(); i++) {
-                    cout << domains[arc.var1][i];
-                    if (i < domains[arc.var1].size() - 1) cout << ", ";
-                }
+                printValues(domains[arc.var1]);
                 cout << "] (REVISED)" << endl;
             }
             
             if (domains[arc.var1].empty()) {
+                wipeout_variable = arc.var1;
+                wipeout_support = arc.var2;
                 if (verbose) {
                     cout << "     Domain " << arc.var1 << " is empty - instance inconsistent!" << endl;
                 }
@@ -166,11 +185,95 @@ bool AC3Algorithm::apply(bool verbose) {
     return true; // Instance consistent
 }
 
-vector<vector<int>> AC3Algorithm::getDomains() const {
+void AC3Algorithm::prepareSearch(const vector<Domain>& initial_domains) {
+    search_arcs.clear();
+    search_arcs_from.assign(csp.num_variables, vector<int>());
+    for (const auto& constraint : csp.constraints) {
+        search_arcs_from[constraint.var1].push_back(search_arcs.size());
+        search_arcs.push_back(Arc(constraint.var1, constraint.var2));
+        if (constraint.var2 != constraint.var1) {
+            search_arcs_from[constraint.var2].push_back(search_arcs.size());
+        }
+        search_arcs.push_back(Arc(constraint.var2, constraint.var1));
+    }
+    
+    // Every revision removes at least one value and pushes at most the arcs
+    // leaving the revised variable: this bounds the pushes of one call
+    size_t total_values = 0;
+    for (const auto& domain : initial_domains) total_values += domain.size();
+    size_t max_arcs_from = 0;
+    for (const auto& arcs : search_arcs_from) max_arcs_from = max(max_arcs_from, arcs.size());
+    search_queue.reserve(search_arcs.size() + total_values * max_arcs_from);
+}
+
+bool AC3Algorithm::enforce(vector<Domain>& target, DomainTrail& trail, bool verbose,
+                           vector<vector<int>>* explanations, ExplanationTrail* explanation_trail) {
+    assert(search_arcs_from.size() == static_cast<size_t>(csp.num_variables) && "enforce(): prepareSearch() was not called");
+    size_t head = 0;
+    search_queue.truncate(0);
+    for (size_t i = 0; i < search_arcs.size(); i++) {
+        search_queue.push(i);
+    }
+    
+    int iteration = 0;
+    int call_revisions = 0;
+    while (head < search_queue.size()) {
+        iteration++;
+        const Arc& arc = search_arcs[search_queue[head++]];
+        const Domain& support_domain = target[arc.var2];
+        
+        int removed = trail.filter(target, arc.var1, [&](int val1) {
+            for (int val2 : support_domain) {
+                if (isConsistent(arc.var1, val1, arc.var2, val2)) return true;
+            }
+            return false;
+        });
+        if (removed == 0) continue;
+        
+        revisions_count++;
+        call_revisions++;
+        
+        // Same explanations as revise(): whatever reduced var2 also
+        // explains the reduction of var1
+        if (explanations) {
+            explanation_trail->save(*explanations, arc.var1);
+            vector<int>& reduced = (*explanations)[arc.var1];
+            for (int culprit : (*explanations)[arc.var2]) {
+                if (culprit != arc.var1 && find(reduced.begin(), reduced.end(), culprit) == reduced.end()) {
+                    reduced.push_back(culprit);
+                }
+            }
+        }
+        if (target[arc.var1].empty()) {
+            wipeout_variable = arc.var1;
+            wipeout_support = arc.var2;
+            if (verbose) {
+                cout << "   AC-3: domain " << arc.var1 << " wiped out by " << arc.var2
+                     << " after " << iteration << " iterations" << endl;
+            }
+            return false;
+        }
+        
+        // Add arcs from neighbors of var1 (except var2)
+        for (int arc_index : search_arcs_from[arc.var1]) {
+            if (search_arcs[arc_index].var2 != arc.var2) {
+                search_queue.push(arc_index);
+            }
+        }
+    }
+    
+    if (verbose) {
+        cout << "   AC-3 completed after " << iteration << " iterations ("
+             << call_revisions << " revisions)" << endl;
+    }
+    return true;
+}
+
+vector<Domain> AC3Algorithm::getDomains() const {
     return domains;
 }
 
-int AC3Algorithm::getRevisionsCount() const {
+long long AC3Algorithm::getRevisionsCount() const {
     return revisions_count;
 }
 
@@ -191,10 +294,7 @@ void AC3Algorithm::printStats() const {
         cout << "       " << i << ": [" << domains[i].size() << " values]";
         if (domains[i].size() <= 10) {
             cout << " = [";
-            for (size_t j = 0; j < domains[i].size(); j++) {
-                cout << domains[i][j];
-                if (j < domains[i].size() - 1) cout << ", ";
-            }
+            printValues(domains[i]);
             cout << "]";
         }
         cout << endl;
@@ -7,6 +7,7 @@
 #include <queue>
 #include <set>
 #include "../parser/parser.h"
+#include "../core/search_arena.h"
 
 // Structure pour représenter un arc
 struct Arc {
@@ -23,30 +24,70 @@ struct Arc {
 // Classe pour l'algorithme AC-3
 class AC3Algorithm {
 private:
-    CSPInstance csp;
-    std::vector<std::vector<int>> domains;
+    const CSPInstance& csp;
+    std::vector<Domain> domains;
     std::queue<Arc> worklist;
-    int revisions_count;
+    long long revisions_count;
+    mutable long long checks_count; // Tests de compatibilité (isConsistent)
+    
+    // Explications des retraits (pour le backjumping) : variables affectées
+    // responsables des réductions de chaque domaine
+    bool track_explanations;
+    std::vector<std::vector<int>> explanations;
+    int wipeout_variable;
+    int wipeout_support; // Autre variable de l'arc qui a vidé le domaine
+    
+    // Version en place pour la recherche (prepareSearch) : arcs précalculés
+    // et file préallouée, même ordre de traitement que apply()
+    std::vector<Arc> search_arcs;                   // Arcs dans l'ordre des contraintes
+    std::vector<std::vector<int>> search_arcs_from; // Indices des arcs sortant de chaque variable
+    FixedStack<int> search_queue;                   // File d'indices d'arcs (sans recyclage)
     
     // Méthodes privées
     bool revise(int var1, int var2);
     std::vector<Arc> getArcs(int var) const;
     bool isConsistent(int var1, int val1, int var2, int val2) const;
     
+    // Les microbenchmarks (bench/microbench.cpp) mesurent revise() seule
+    friend struct BenchAccess;
+    
 public:
     AC3Algorithm(const CSPInstance& instance);
     
     // Appliquer AC-3 et retourner true si l'instance est consistante
     bool apply(bool verbose = true);
     
+    // Précalculer les arcs et la file pour enforce() (domaines triés)
+    void prepareSearch(const std::vector<Domain>& initial_domains);
+    
+    // Appliquer AC-3 directement sur des domaines externes, les retraits
+    // étant enregistrés dans la trail (aucune allocation). Avec explanations
+    // (CBJ), chaque révision complète l'explication du domaine réduit,
+    // chaque ajout étant enregistré dans explanation_trail.
+    bool enforce(std::vector<Domain>& target, DomainTrail& trail, bool verbose = false,
+                 std::vector<std::vector<int>>* explanations = nullptr,
+                 ExplanationTrail* explanation_trail = nullptr);
+    
     // Initialiser avec des domaines spécifiques
-    void setDomains(const std::vector<std::vector<int>>& new_domains);
+    void setDomains(const std::vector<Domain>& new_domains);
     
     // Obtenir les domaines après AC-3
-    std::vector<std::vector<int>> getDomains() const;
+    std::vector<Domain> getDomains() const;
+    
+    // Activer le suivi des explications à partir des explications courantes
+    void setExplanations(const std::vector<std::vector<int>>& initial_explanations);
+    
+    // Obtenir les explications après AC-3
+    const std::vector<std::vector<int>>& getExplanations() const;
+    
+    // Variable dont le domaine a été vidé (-1 si aucune) et variable de la
+    // contrainte qui l'a vidé
+    int getWipeoutVariable() const;
+    int getWipeoutSupport() const { return wipeout_support; }
     
-    // Obtenir le nombre de révisions effectuées
-    int getRevisionsCount() const;
+    // Obtenir le nombre de révisions effectuées et de tests de compatibilité
+    long long getRevisionsCount() const;
+    long long getChecksCount() const { return checks_count; }
     
     // Vérifier si un domaine est vide
     bool hasEmptyDomain() const;
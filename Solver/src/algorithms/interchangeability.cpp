@@ -0,0 +1,154 @@
+#include "interchangeability.h"
+#include <unordered_map>
+
+using namespace std;
+
+// Hash of the supports of var=index in the current domains of its neighbors
+static uint64_t supportSignature(const CompiledModel& model, const vector<DomainBits>& bits,
+                                 int var, int index) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (int arc_index : model.getArcsFrom(var)) {
+        const CompiledArc& arc = model.getArc(arc_index);
+        const uint64_t* row = model.supports(arc, index);
+        const DomainBits& neighbor = bits[arc.neighbor];
+        hash = (hash ^ static_cast<uint64_t>(arc.neighbor)) * 1099511628211ULL;
+        for (size_t w = 0; w < neighbor.size(); w++) {
+            hash = (hash ^ (row[w] & neighbor[w])) * 1099511628211ULL;
+            hash ^= hash >> 29;
+        }
+    }
+    return hash;
+}
+
+bool InterchangeableValues::sameSupports(const CompiledModel& model, const vector<DomainBits>& bits,
+                                         int var, int index1, int index2) const {
+    for (int arc_index : model.getArcsFrom(var)) {
+        const CompiledArc& arc = model.getArc(arc_index);
+        const uint64_t* row1 = model.supports(arc, index1);
+        const uint64_t* row2 = model.supports(arc, index2);
+        const DomainBits& neighbor = bits[arc.neighbor];
+        for (size_t w = 0; w < neighbor.size(); w++) {
+            if ((row1[w] ^ row2[w]) & neighbor[w]) return false;
+        }
+    }
+    return true;
+}
+
+InterchangeableValues::InterchangeableValues(const CompiledModel& model, const vector<Domain>& domains)
+    : merged_values(0) {
+    int num_variables = model.getNumVariables();
+    vector<DomainBits> bits = model.toBits(domains);
+    offsets.resize(num_variables);
+    class_of.resize(num_variables);
+    classes.resize(num_variables);
+
+    unordered_map<uint64_t, vector<int>> buckets; // Signature -> classes with it
+    for (int var = 0; var < num_variables; var++) {
+        int offset = model.getOffset(var);
+        offsets[var] = offset;
+        class_of[var].assign(model.getSize(var), -1);
+        vector<vector<int>>& var_classes = classes[var];
+        buckets.clear();
+
+        // Values in increasing order: the first value of a class is its smallest
+        for (int value : domains[var]) {
+            int index = value - offset;
+            vector<int>& candidates = buckets[supportSignature(model, bits, var, index)];
+            int found = -1;
+            for (int candidate : candidates) {
+                if (sameSupports(model, bits, var, var_classes[candidate][0] - offset, index)) {
+                    found = candidate;
+                    break;
+                }
+            }
+            if (found < 0) {
+                found = static_cast<int>(var_classes.size());
+                var_classes.emplace_back();
+                candidates.push_back(found);
+            }
+            var_classes[found].push_back(value);
+            class_of[var][index] = found;
+        }
+
+        if (var_classes.size() < domains[var].size()) {
+            merged_vars.push_back(var);
+            merged_values += domains[var].size() - var_classes.size();
+        }
+    }
+}
+
+vector<Domain> InterchangeableValues::compress(const vector<Domain>& domains) const {
+    vector<Domain> compressed = domains;
+    for (int var : merged_vars) {
+        // Representatives come in increasing order, like the classes
+        vector<int> representatives;
+        for (const auto& members : classes[var]) {
+            representatives.push_back(members[0]);
+        }
+        compressed[var] = Domain(representatives);
+    }
+    return compressed;
+}
+
+void InterchangeableValues::addWeight(const Assignment& assignment, SolutionWeightSum& sum) const {
+    unsigned long long product = 1;
+    for (size_t i = 0; i < merged_vars.size(); i++) {
+        int var = merged_vars[i];
+        unsigned long long size = getClass(var, assignment.valueOf(var)).size();
+        unsigned long long next;
+        if (__builtin_mul_overflow(product, size, &next)) {
+            // Beyond 64 bits: the rest of the product in arbitrary precision
+            BigInt weight(product);
+            for (size_t j = i; j < merged_vars.size(); j++) {
+                int other = merged_vars[j];
+                weight *= BigInt(getClass(other, assignment.valueOf(other)).size());
+            }
+            sum.add(weight);
+            return;
+        }
+        product = next;
+    }
+    sum.add(product);
+}
+
+BigInt InterchangeableValues::weight(const map<int, int>& solution) const {
+    BigInt product(1);
+    for (int var : merged_vars) {
+        product *= BigInt(getClass(var, solution.at(var)).size());
+    }
+    return product;
+}
+
+ExpandedSolutions::ExpandedSolutions(const InterchangeableValues& interchangeable,
+                                     const vector<map<int, int>>& representative_solutions)
+    : values(interchangeable), solutions(representative_solutions), index(0),
+      cursor(interchangeable.getMergedVariables().size(), 0) {}
+
+void ExpandedSolutions::reset() {
+    index = 0;
+    cursor.assign(cursor.size(), 0);
+}
+
+bool ExpandedSolutions::next(map<int, int>& solution) {
+    if (index >= solutions.size()) {
+        return false;
+    }
+    const map<int, int>& representative = solutions[index];
+    const vector<int>& merged_vars = values.getMergedVariables();
+    solution = representative;
+    for (size_t i = 0; i < merged_vars.size(); i++) {
+        int var = merged_vars[i];
+        solution[var] = values.getClass(var, representative.at(var))[cursor[i]];
+    }
+
+    // Odometer over the classes, the last merged variable fastest
+    for (size_t i = merged_vars.size(); i-- > 0;) {
+        int var = merged_vars[i];
+        if (++cursor[i] < values.getClass(var, representative.at(var)).size()) {
+            return true;
+        }
+        cursor[i] = 0;
+    }
+    index++;
+    return true;
+}
@@ -0,0 +1,71 @@
+#ifndef INTERCHANGEABILITY_H
+#define INTERCHANGEABILITY_H
+
+#include <vector>
+#include <map>
+#include "../core/compiled_model.h"
+#include "../core/domain.h"
+#include "../core/assignment.h"
+#include "../core/bigint.h"
+
+// Valeurs interchangeables par voisinage (Freuder) : deux valeurs d'une
+// variable sont interchangeables quand elles ont exactement les mêmes
+// supports dans le domaine courant de chaque voisin. Les classes sont
+// trouvées en hachant la signature des supports (lignes des matrices
+// compilées restreintes aux domaines), puis vérifiées mot à mot. Calculées
+// en une passe sur les mêmes domaines, elles se combinent : la recherche ne
+// garde que le représentant de chaque classe (sa plus petite valeur), et
+// toute combinaison de membres des classes d'une solution trouvée est une
+// solution, chacune obtenue une seule fois.
+class InterchangeableValues {
+private:
+    std::vector<int> offsets;                     // Smallest value of each variable's range
+    std::vector<std::vector<int>> class_of;       // Class of each value index (-1: not in the domain)
+    std::vector<std::vector<std::vector<int>>> classes; // Classes of each variable, sorted (representative first)
+    std::vector<int> merged_vars;                 // Variables with a class of at least 2 values
+    size_t merged_values;                         // Values removed from the domains
+
+    bool sameSupports(const CompiledModel& model, const std::vector<DomainBits>& bits,
+                      int var, int index1, int index2) const;
+
+public:
+    // Detects the classes of the given domains (typically after AC-3/SAC)
+    InterchangeableValues(const CompiledModel& model, const std::vector<Domain>& domains);
+
+    // Domains reduced to the representative of each class
+    std::vector<Domain> compress(const std::vector<Domain>& domains) const;
+
+    // Values of the class of a representative (the representative first)
+    const std::vector<int>& getClass(int var, int representative) const {
+        return classes[var][class_of[var][representative - offsets[var]]];
+    }
+    const std::vector<int>& getMergedVariables() const { return merged_vars; }
+    size_t getMergedValueCount() const { return merged_values; }
+
+    // Solutions of the instance represented by a solution on representatives:
+    // the product of the sizes of the classes of its values
+    void addWeight(const Assignment& assignment, SolutionWeightSum& sum) const;
+    BigInt weight(const std::map<int, int>& solution) const;
+};
+
+// Lazy expansion of solutions on representatives: every combination of the
+// members of their classes, the solutions themselves first
+class ExpandedSolutions {
+private:
+    const InterchangeableValues& values;
+    const std::vector<std::map<int, int>>& solutions;
+    size_t index;
+    std::vector<size_t> cursor; // Member of each merged variable's class
+
+public:
+    ExpandedSolutions(const InterchangeableValues& interchangeable,
+                      const std::vector<std::map<int, int>>& representative_solutions);
+
+    // Restart from the first solution
+    void reset();
+
+    // Build the next solution; returns false once all have been produced
+    bool next(std::map<int, int>& solution);
+};
+
+#endif // INTERCHANGEABILITY_H
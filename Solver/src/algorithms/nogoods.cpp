@@ -0,0 +1,191 @@
+#include "nogoods.h"
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+// Activity decay: recent nogoods weigh more than old ones
+static const double ACTIVITY_DECAY = 0.95;
+static const double ACTIVITY_RESCALE_LIMIT = 1e100;
+
+NogoodStore::NogoodStore(const CSPInstance& instance, size_t max_nogoods)
+    : csp(instance), max_nogoods(max_nogoods), live_count(0), activity_increment(1.0),
+      learned_count(0), prunings_count(0), conflicts_count(0), deleted_count(0) {
+
+    watches.resize(csp.num_variables);
+    for (int i = 0; i < csp.num_variables; i++) {
+        int size = csp.domains[i].second - csp.domains[i].first + 1;
+        watches[i].resize(max(size, 0));
+    }
+}
+
+vector<int>& NogoodStore::watchList(const Literal& lit) {
+    return watches[lit.var][lit.value - csp.domains[lit.var].first];
+}
+
+bool NogoodStore::isTrue(const Literal& lit, const Assignment& assignment) const {
+    return assignment.isAssigned(lit.var) && assignment.valueOf(lit.var) == lit.value;
+}
+
+void NogoodStore::bumpActivity(Nogood& nogood) {
+    nogood.activity += activity_increment;
+    if (nogood.activity > ACTIVITY_RESCALE_LIMIT) {
+        for (auto& ng : nogoods) {
+            ng.activity /= ACTIVITY_RESCALE_LIMIT;
+        }
+        activity_increment /= ACTIVITY_RESCALE_LIMIT;
+    }
+}
+
+void NogoodStore::add(const vector<Literal>& literals, const vector<int>& var_depth) {
+    if (literals.empty()) {
+        return;
+    }
+
+    Nogood nogood;
+    nogood.literals = literals;
+    // The deepest decisions are undone first, so watching them keeps the
+    // watches on non-true literals once the search backjumps
+    sort(nogood.literals.begin(), nogood.literals.end(), [&](const Literal& a, const Literal& b) {
+        return var_depth[a.var] > var_depth[b.var];
+    });
+    nogood.watch1 = 0;
+    nogood.watch2 = nogood.literals.size() > 1 ? 1 : 0;
+    nogood.activity = activity_increment;
+    nogood.deleted = false;
+
+    int id = nogoods.size();
+    nogoods.push_back(nogood);
+    watchList(nogoods[id].literals[nogoods[id].watch1]).push_back(id);
+    if (nogoods[id].watch2 != nogoods[id].watch1) {
+        watchList(nogoods[id].literals[nogoods[id].watch2]).push_back(id);
+    }
+    live_count++;
+    learned_count++;
+    activity_increment /= ACTIVITY_DECAY;
+
+    if (live_count > max_nogoods) {
+        reduce();
+    }
+}
+
+// Deletes the least active half of the database (binary nogoods are kept)
+void NogoodStore::reduce() {
+    vector<int> candidates;
+    for (size_t i = 0; i < nogoods.size(); i++) {
+        if (!nogoods[i].deleted && nogoods[i].literals.size() > 2) {
+            candidates.push_back(i);
+        }
+    }
+    sort(candidates.begin(), candidates.end(), [&](int a, int b) {
+        return nogoods[a].activity < nogoods[b].activity;
+    });
+
+    size_t target = max_nogoods / 2;
+    for (int id : candidates) {
+        if (live_count <= target) break;
+        nogoods[id].deleted = true;
+        live_count--;
+        deleted_count++;
+    }
+
+    // Compact the database and renumber the watch lists
+    vector<int> remap(nogoods.size(), -1);
+    vector<Nogood> kept;
+    kept.reserve(live_count);
+    for (size_t i = 0; i < nogoods.size(); i++) {
+        if (!nogoods[i].deleted) {
+            remap[i] = kept.size();
+            kept.push_back(std::move(nogoods[i]));
+        }
+    }
+    nogoods.swap(kept);
+
+    for (auto& var_watches : watches) {
+        for (auto& list : var_watches) {
+            size_t out = 0;
+            for (int id : list) {
+                if (remap[id] != -1) {
+                    list[out++] = remap[id];
+                }
+            }
+            list.resize(out);
+        }
+    }
+}
+
+bool NogoodStore::propagate(int var, int value, const Assignment& assignment,
+                            vector<Domain>& domains, DomainTrail& trail,
+                            vector<vector<int>>& explanations,
+                            ExplanationTrail& explanation_trail,
+                            vector<int>& conflict) {
+    vector<int>& list = watches[var][value - csp.domains[var].first];
+
+    size_t i = 0;
+    while (i < list.size()) {
+        int id = list[i];
+        Nogood& nogood = nogoods[id];
+        assert(!nogood.deleted && "propagate(): deleted nogood still watched");
+
+        int& self = (nogood.literals[nogood.watch1].var == var) ? nogood.watch1 : nogood.watch2;
+        int other_index = (&self == &nogood.watch1) ? nogood.watch2 : nogood.watch1;
+        const Literal& other = nogood.literals[other_index];
+
+        // Satisfied: the other watched decision was taken differently
+        bool other_assigned = assignment.isAssigned(other.var);
+        if (other_assigned && assignment.valueOf(other.var) != other.value) {
+            i++;
+            continue;
+        }
+
+        // Look for another literal that is not true yet
+        int replacement = -1;
+        for (size_t k = 0; k < nogood.literals.size(); k++) {
+            int index = static_cast<int>(k);
+            if (index != nogood.watch1 && index != nogood.watch2 && !isTrue(nogood.literals[k], assignment)) {
+                replacement = index;
+                break;
+            }
+        }
+        if (replacement != -1) {
+            self = replacement;
+            watchList(nogood.literals[replacement]).push_back(id);
+            list[i] = list.back();
+            list.pop_back();
+            continue;
+        }
+
+        // Every literal but the other watch is true
+        bumpActivity(nogood);
+        if (other_assigned) {
+            conflict.clear();
+            for (const Literal& lit : nogood.literals) {
+                conflict.push_back(lit.var);
+            }
+            conflicts_count++;
+            return false;
+        }
+
+        const Domain& domain = domains[other.var];
+        int forbidden = other.value;
+        if (domain.contains(forbidden)) {
+            trail.filter(domains, other.var, [forbidden](int v) { return v != forbidden; });
+            prunings_count++;
+
+            explanation_trail.save(explanations, other.var);
+            vector<int>& explanation = explanations[other.var];
+            for (const Literal& lit : nogood.literals) {
+                if (lit.var != other.var && find(explanation.begin(), explanation.end(), lit.var) == explanation.end()) {
+                    explanation.push_back(lit.var);
+                }
+            }
+            if (domain.empty()) {
+                conflict = explanation;
+                conflicts_count++;
+                return false;
+            }
+        }
+        i++;
+    }
+    return true;
+}
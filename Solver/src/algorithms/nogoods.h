@@ -0,0 +1,73 @@
+#ifndef NOGOODS_H
+#define NOGOODS_H
+
+#include <vector>
+#include "../parser/parser.h"
+#include "../core/assignment.h"
+#include "../core/search_arena.h"
+
+// Littéral d'un nogood : la décision var = value
+struct Literal {
+    int var;
+    int value;
+
+    Literal(int v, int val) : var(v), value(val) {}
+};
+
+// Nogood appris : la conjonction de ses littéraux ne peut pas être étendue
+// en solution
+struct Nogood {
+    std::vector<Literal> literals;
+    int watch1;         // Indices des deux littéraux surveillés
+    int watch2;
+    double activity;    // Activité (utilité récente) pour la réduction de la base
+    bool deleted;
+};
+
+// Base de nogoods avec deux littéraux surveillés (watched literals).
+// Un nogood n'est visité que lorsqu'un de ses littéraux surveillés devient
+// vrai ; il n'y a rien à restaurer lors du retour arrière.
+class NogoodStore {
+private:
+    const CSPInstance& csp;
+    size_t max_nogoods;
+    std::vector<Nogood> nogoods;
+    std::vector<std::vector<std::vector<int>>> watches; // [var][value - min] -> nogoods surveillant var=value
+    size_t live_count;
+    double activity_increment;
+
+    // Statistiques
+    long long learned_count;
+    long long prunings_count;
+    long long conflicts_count;
+    long long deleted_count;
+
+    std::vector<int>& watchList(const Literal& lit);
+    bool isTrue(const Literal& lit, const Assignment& assignment) const;
+    void bumpActivity(Nogood& nogood);
+    void reduce();
+
+public:
+    NogoodStore(const CSPInstance& instance, size_t max_nogoods);
+
+    // Enregistrer un nogood ; les deux littéraux les plus profonds sont surveillés
+    void add(const std::vector<Literal>& literals, const std::vector<int>& var_depth);
+
+    // Propager après l'affectation var = value. Retire des domaines les valeurs
+    // interdites (dans la trail, en complétant leurs explications) ; retourne
+    // false en cas de conflit, conflict contenant alors les variables responsables.
+    bool propagate(int var, int value, const Assignment& assignment,
+                   std::vector<Domain>& domains, DomainTrail& trail,
+                   std::vector<std::vector<int>>& explanations,
+                   ExplanationTrail& explanation_trail,
+                   std::vector<int>& conflict);
+
+    // Statistiques
+    size_t size() const { return live_count; }
+    long long getLearnedCount() const { return learned_count; }
+    long long getPruningsCount() const { return prunings_count; }
+    long long getConflictsCount() const { return conflicts_count; }
+    long long getDeletedCount() const { return deleted_count; }
+};
+
+#endif // NOGOODS_H
@@ -0,0 +1,117 @@
+#include "sac.h"
+#include "../core/thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+
+using namespace std;
+
+SACAlgorithm::SACAlgorithm(const CompiledModel& compiled_model, int num_threads, int max_time_ms)
+    : model(compiled_model), num_threads(num_threads), max_time_ms(max_time_ms),
+      rounds_count(0), probes_count(0), removals_count(0), timed_out(false) {}
+
+bool SACAlgorithm::apply(vector<DomainBits>& domains, bool verbose) {
+    auto deadline = chrono::steady_clock::now() + chrono::milliseconds(max_time_ms);
+
+    if (!model.enforceArcConsistency(domains)) {
+        return false;
+    }
+
+    ThreadPool pool(num_threads);
+
+    while (true) {
+        rounds_count++;
+
+        // Every value of every non-singleton domain is probed against the
+        // domains at the start of the round
+        vector<pair<int, int>> probes;
+        for (int var = 0; var < model.getNumVariables(); var++) {
+            if (countBits(domains[var]) <= 1) continue;
+            for (int index = 0; index < model.getSize(var); index++) {
+                if (testBit(domains[var].data(), index)) {
+                    probes.push_back(make_pair(var, index));
+                }
+            }
+        }
+        if (probes.empty()) {
+            break;
+        }
+
+        const vector<DomainBits>& snapshot = domains;
+        vector<char> failed(probes.size(), 0);
+        atomic<bool> expired(false);
+        atomic<long long> probes_done(0);
+
+        size_t chunk = max<size_t>(1, probes.size() / (static_cast<size_t>(pool.size()) * 8));
+        for (size_t start = 0; start < probes.size(); start += chunk) {
+            size_t end = min(probes.size(), start + chunk);
+            pool.submit([&, start, end] {
+                vector<DomainBits> work;
+                for (size_t i = start; i < end; i++) {
+                    if (expired.load(memory_order_relaxed) || chrono::steady_clock::now() >= deadline) {
+                        expired.store(true, memory_order_relaxed);
+                        return;
+                    }
+                    int var = probes[i].first;
+                    int index = probes[i].second;
+                    work = snapshot;
+                    fill(work[var].begin(), work[var].end(), 0);
+                    work[var][index >> 6] |= 1ULL << (index & 63);
+                    failed[i] = !model.enforceArcConsistency(work, vector<int>(1, var));
+                    probes_done.fetch_add(1, memory_order_relaxed);
+                }
+            });
+        }
+        pool.wait();
+        probes_count += probes_done.load();
+
+        // Remove the values whose probe wiped out a domain
+        vector<int> changed;
+        int round_removals = 0;
+        for (size_t i = 0; i < probes.size(); i++) {
+            if (failed[i]) {
+                int var = probes[i].first;
+                int index = probes[i].second;
+                domains[var][index >> 6] &= ~(1ULL << (index & 63));
+                if (changed.empty() || changed.back() != var) {
+                    changed.push_back(var);
+                }
+                round_removals++;
+            }
+        }
+        removals_count += round_removals;
+
+        if (verbose) {
+            cout << "   SAC round " << rounds_count << ": " << probes_done.load() << " probes, "
+                 << round_removals << " values removed" << endl;
+        }
+
+        if (round_removals > 0) {
+            for (int var : changed) {
+                if (countBits(domains[var]) == 0) {
+                    return false;
+                }
+            }
+            if (!model.enforceArcConsistency(domains, changed)) {
+                return false;
+            }
+        }
+
+        if (expired.load()) {
+            timed_out = true;
+            break;
+        }
+        if (round_removals == 0) {
+            break;
+        }
+    }
+    return true;
+}
+
+void SACAlgorithm::printStats() const {
+    cout << "   SAC Statistics:" << endl;
+    cout << "     Rounds: " << rounds_count << endl;
+    cout << "     Probes: " << probes_count << endl;
+    cout << "     Values removed: " << removals_count << endl;
+    cout << "     Time budget exhausted: " << (timed_out ? "Yes" : "No") << endl;
+}
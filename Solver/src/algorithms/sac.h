@@ -0,0 +1,39 @@
+#ifndef SAC_H
+#define SAC_H
+
+#include <vector>
+#include "../core/compiled_model.h"
+
+// Singleton arc consistency (SAC-1) par rondes : chaque valeur var=value est
+// testée en réduisant le domaine de var à {value} puis en appliquant AC sur une
+// copie ; la valeur est retirée si un domaine est vidé. Les tests d'une ronde
+// sont indépendants et répartis sur un pool de threads qui partagent le modèle
+// compilé (immuable). Les rondes se répètent jusqu'au point fixe ou jusqu'à
+// l'épuisement du budget de temps.
+class SACAlgorithm {
+private:
+    const CompiledModel& model;
+    int num_threads;
+    int max_time_ms;
+
+    // Statistiques
+    int rounds_count;
+    long long probes_count;
+    int removals_count;
+    bool timed_out;
+
+public:
+    SACAlgorithm(const CompiledModel& compiled_model, int num_threads, int max_time_ms);
+
+    // Appliquer SAC ; retourne false si l'instance est inconsistante
+    bool apply(std::vector<DomainBits>& domains, bool verbose = false);
+
+    int getRoundsCount() const { return rounds_count; }
+    long long getProbesCount() const { return probes_count; }
+    int getRemovalsCount() const { return removals_count; }
+    bool wasTimedOut() const { return timed_out; }
+
+    void printStats() const;
+};
+
+#endif // SAC_H
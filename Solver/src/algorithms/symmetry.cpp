@@ -0,0 +1,297 @@
+#include "symmetry.h"
+#include "../core/compiled_model.h"
+#include <algorithm>
+#include <set>
+#include <unordered_set>
+
+using namespace std;
+
+Symmetries::Symmetries()
+    : value_symmetry(false), value_min(0), value_count(0), generator_count(0) {}
+
+bool Symmetries::detect(const CSPInstance& csp, string& error) {
+    if (!csp.symmetries.empty()) {
+        return loadDeclared(csp, error);
+    }
+    value_symmetry = detectValueSymmetry(csp);
+    return true;
+}
+
+// Every variable has the same domain D and every relation, restricted to D,
+// is a union of the diagonal (a = b) and of the rest (a != b): the two
+// orbits of the permutations of D on the pairs
+bool Symmetries::detectValueSymmetry(const CSPInstance& csp) {
+    if (csp.num_variables == 0) return false;
+    int min_value = csp.domains[0].first;
+    int max_value = csp.domains[0].second;
+    long long d = static_cast<long long>(max_value) - min_value + 1;
+    if (d < 2) return false;
+    for (const auto& domain : csp.domains) {
+        if (domain.first != min_value || domain.second != max_value) return false;
+    }
+
+    unordered_set<const Relation*> checked;
+    for (const Constraint& c : csp.constraints) {
+        if (!checked.insert(c.relation.get()).second) continue;
+        long long equal = 0, different = 0;
+        for (const auto& p : c.relation->getPairs()) {
+            if (p.first < min_value || p.first > max_value || p.second < min_value || p.second > max_value) {
+                continue;
+            }
+            if (p.first == p.second) {
+                equal++;
+            } else {
+                different++;
+            }
+        }
+        if ((equal != 0 && equal != d) || (different != 0 && different != d * (d - 1))) {
+            return false;
+        }
+    }
+
+    value_min = min_value;
+    value_count = static_cast<int>(d);
+    orbit_sizes.assign(1, 1);
+    int max_used = static_cast<int>(min(d, static_cast<long long>(csp.num_variables)));
+    for (int k = 1; k <= max_used; k++) {
+        unsigned long long next;
+        if (__builtin_mul_overflow(orbit_sizes.back(), static_cast<unsigned long long>(d - k + 1), &next)) {
+            break;
+        }
+        orbit_sizes.push_back(next);
+    }
+    return true;
+}
+
+bool Symmetries::loadDeclared(const CSPInstance& csp, string& error) {
+    // Literal indices over the initial domains
+    int num_literals = 0;
+    offsets.resize(csp.num_variables);
+    minima.resize(csp.num_variables);
+    for (int var = 0; var < csp.num_variables; var++) {
+        offsets[var] = num_literals;
+        minima[var] = csp.domains[var].first;
+        long long size = max(0LL, static_cast<long long>(csp.domains[var].second) - csp.domains[var].first + 1);
+        if (num_literals + size > MAX_CHECKED_LITERALS) {
+            error = "declared symmetries are limited to " + to_string(MAX_CHECKED_LITERALS) +
+                    " (variable, value) literals";
+            return false;
+        }
+        num_literals += static_cast<int>(size);
+        for (int value = csp.domains[var].first; value <= csp.domains[var].second; value++) {
+            literal_var.push_back(var);
+            literal_value.push_back(value);
+        }
+    }
+    auto literalOf = [&](int var, int value) {
+        if (var < 0 || var >= csp.num_variables || value < csp.domains[var].first ||
+            value > csp.domains[var].second) {
+            return -1;
+        }
+        return offsets[var] + value - minima[var];
+    };
+
+    // Compatibility of each pair of literals: never within a variable,
+    // otherwise the conjunction of the constraints between the two variables
+    CompiledModel model(csp);
+    size_t words = (static_cast<size_t>(num_literals) + 63) / 64;
+    vector<uint64_t> compatible(static_cast<size_t>(num_literals) * words, 0);
+    for (int l1 = 0; l1 < num_literals; l1++) {
+        uint64_t* row = &compatible[l1 * words];
+        for (int l2 = 0; l2 < num_literals; l2++) {
+            if (literal_var[l2] != literal_var[l1]) row[l2 >> 6] |= 1ULL << (l2 & 63);
+        }
+        int var = literal_var[l1];
+        for (int arc_index : model.getArcsFrom(var)) {
+            const CompiledArc& arc = model.getArc(arc_index);
+            const uint64_t* supports = model.supports(arc, literal_value[l1] - minima[var]);
+            for (int b = 0; b < model.getSize(arc.neighbor); b++) {
+                if (!testBit(supports, b)) {
+                    int l2 = offsets[arc.neighbor] + b;
+                    row[l2 >> 6] &= ~(1ULL << (l2 & 63));
+                }
+            }
+        }
+    }
+    auto compatibleLiterals = [&](int l1, int l2) { return testBit(&compatible[l1 * words], l2); };
+
+    // Each generator: a permutation of the literals preserving compatibility
+    vector<vector<int>> generators;
+    for (size_t s = 0; s < csp.symmetries.size(); s++) {
+        string name = "declared symmetry " + to_string(s + 1);
+        vector<int> permutation(num_literals);
+        for (int l = 0; l < num_literals; l++) permutation[l] = l;
+        vector<char> listed(num_literals, 0);
+        for (const LiteralImage& image : csp.symmetries[s]) {
+            int from = literalOf(image.var, image.value);
+            int to = literalOf(image.image_var, image.image_value);
+            if (from < 0 || to < 0) {
+                error = name + " maps a literal outside the domains";
+                return false;
+            }
+            if (listed[from]) {
+                error = name + " maps (" + to_string(image.var) + "," + to_string(image.value) + ") twice";
+                return false;
+            }
+            listed[from] = 1;
+            permutation[from] = to;
+        }
+        vector<char> reached(num_literals, 0);
+        for (int l = 0; l < num_literals; l++) {
+            if (reached[permutation[l]]) {
+                error = name + " is not a permutation of the literals";
+                return false;
+            }
+            reached[permutation[l]] = 1;
+        }
+        for (int l1 = 0; l1 < num_literals; l1++) {
+            for (int l2 = l1 + 1; l2 < num_literals; l2++) {
+                if (compatibleLiterals(l1, l2) != compatibleLiterals(permutation[l1], permutation[l2])) {
+                    error = name + " does not preserve the constraints: (" + to_string(literal_var[l1]) + "," +
+                            to_string(literal_value[l1]) + ") and (" + to_string(literal_var[l2]) + "," +
+                            to_string(literal_value[l2]) + ")";
+                    return false;
+                }
+            }
+        }
+        generators.push_back(move(permutation));
+    }
+    generator_count = generators.size();
+
+    // Closure under composition, from the identity
+    vector<int> identity(num_literals);
+    for (int l = 0; l < num_literals; l++) identity[l] = l;
+    set<vector<int>> elements = {identity};
+    vector<vector<int>> pending = {identity};
+    while (!pending.empty()) {
+        vector<int> element = move(pending.back());
+        pending.pop_back();
+        for (const vector<int>& generator : generators) {
+            vector<int> product(num_literals);
+            for (int l = 0; l < num_literals; l++) product[l] = generator[element[l]];
+            if (elements.insert(product).second) {
+                if (elements.size() > MAX_GROUP_SIZE) {
+                    error = "the declared symmetries generate more than " + to_string(MAX_GROUP_SIZE) + " elements";
+                    return false;
+                }
+                pending.push_back(move(product));
+            }
+        }
+    }
+    for (const vector<int>& element : elements) {
+        if (element != identity) group.push_back(element);
+    }
+    return true;
+}
+
+void Symmetries::addWeight(const Assignment& assignment, int used_values, SolutionWeightSum& sum) const {
+    if (value_symmetry) {
+        if (static_cast<size_t>(used_values) < orbit_sizes.size()) {
+            sum.add(orbit_sizes[used_values]);
+            return;
+        }
+        // d!/(d-k)! beyond 64 bits
+        BigInt weight(orbit_sizes.back());
+        for (int k = static_cast<int>(orbit_sizes.size()); k <= used_values; k++) {
+            weight *= BigInt(static_cast<unsigned long long>(value_count - k + 1));
+        }
+        sum.add(weight);
+        return;
+    }
+
+    // Orbit size: group size / elements fixing the solution
+    unsigned long long stabilizer = 1;
+    for (const vector<int>& element : group) {
+        bool fixed = true;
+        for (size_t var = 0; var < offsets.size() && fixed; var++) {
+            int literal = element[offsets[var] + assignment.valueOf(static_cast<int>(var)) - minima[var]];
+            fixed = assignment.valueOf(literal_var[literal]) == literal_value[literal];
+        }
+        if (fixed) stabilizer++;
+    }
+    sum.add(getGroupSize() / stabilizer);
+}
+
+void Symmetries::orbit(const map<int, int>& solution, vector<map<int, int>>& images) const {
+    images.assign(1, solution);
+    for (size_t element = 0; element < group.size(); element++) {
+        map<int, int> symmetric;
+        for (const auto& assignment : solution) {
+            int image_var, image_value;
+            image(element, assignment.first, assignment.second, image_var, image_value);
+            symmetric[image_var] = image_value;
+        }
+        images.push_back(move(symmetric));
+    }
+    sort(images.begin(), images.end());
+    images.erase(unique(images.begin(), images.end()), images.end());
+}
+
+SymmetricSolutions::SymmetricSolutions(const Symmetries& symmetry_group,
+                                       const vector<map<int, int>>& canonical_solutions)
+    : symmetries(symmetry_group), solutions(canonical_solutions), index(0), prepared(false), image_index(0) {}
+
+void SymmetricSolutions::reset() {
+    index = 0;
+    prepared = false;
+}
+
+bool SymmetricSolutions::next(map<int, int>& solution) {
+    if (index >= solutions.size()) {
+        return false;
+    }
+    const map<int, int>& canonical = solutions[index];
+
+    if (!symmetries.hasValueSymmetry()) {
+        if (!prepared) {
+            symmetries.orbit(canonical, images);
+            image_index = 0;
+            prepared = true;
+        }
+        solution = images[image_index++];
+        if (image_index == images.size()) {
+            index++;
+            prepared = false;
+        }
+        return true;
+    }
+
+    // Value symmetry: every injection of the values used into the domain
+    if (!prepared) {
+        used.clear();
+        for (const auto& assignment : canonical) used.push_back(assignment.second);
+        sort(used.begin(), used.end());
+        used.erase(unique(used.begin(), used.end()), used.end());
+        cursor.assign(used.size(), 0);
+        prepared = true;
+    }
+    int d = symmetries.getValueCount();
+    int min_value = symmetries.getValueMin();
+    vector<char> taken(d, 0);
+    vector<int> mapped(used.size());
+    for (size_t i = 0; i < used.size(); i++) {
+        int free_values = -1;
+        int v = 0;
+        for (; v < d; v++) {
+            if (!taken[v] && ++free_values == cursor[i]) break;
+        }
+        taken[v] = 1;
+        mapped[i] = min_value + v;
+    }
+    solution = canonical;
+    for (auto& assignment : solution) {
+        size_t i = lower_bound(used.begin(), used.end(), assignment.second) - used.begin();
+        assignment.second = mapped[i];
+    }
+
+    // Odometer over the choices, the last value fastest
+    for (size_t i = used.size(); i-- > 0;) {
+        if (++cursor[i] < d - static_cast<int>(i)) {
+            return true;
+        }
+        cursor[i] = 0;
+    }
+    index++;
+    prepared = false;
+    return true;
+}
@@ -0,0 +1,98 @@
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+#include <vector>
+#include <map>
+#include <string>
+#include "../parser/parser.h"
+#include "../core/assignment.h"
+#include "../core/bigint.h"
+
+// Symétries de l'instance, cassées pendant la recherche (-B). Chaque classe
+// de solutions symétriques n'est trouvée qu'une fois, par sa solution
+// canonique, qui compte pour la taille de son orbite.
+// - Symétrie de valeurs, détectée automatiquement : toutes les variables ont
+//   le même domaine D et chaque relation ne dépend que de l'égalité des deux
+//   valeurs (coloriage, n-tours). Toute permutation de D envoie une solution
+//   sur une solution : à chaque nœud, la recherche n'essaie que les valeurs
+//   déjà prises et une seule valeur neuve. Une solution qui utilise k
+//   valeurs représente d!/(d-k)! solutions.
+// - Symétries déclarées dans l'en-tête (# symmetry), prioritaires sur la
+//   détection : permutations des littéraux (variable, valeur), vérifiées sur
+//   les contraintes (elles doivent préserver la compatibilité de chaque paire
+//   de littéraux) puis fermées par composition. Elles sont cassées par SBDS
+//   sur le groupe entier : quand une valeur a été réfutée sous des décisions
+//   A, son image par g est interdite tant que g(A) tient.
+class Symmetries {
+private:
+    bool value_symmetry;
+    int value_min;                               // Common domain [value_min, value_min + value_count - 1]
+    int value_count;
+    std::vector<unsigned long long> orbit_sizes; // d!/(d-k)! for k values used, while it fits on 64 bits
+
+    // Declared symmetries: literal index = offset of the variable + value - minimum
+    std::vector<int> offsets;
+    std::vector<int> minima;
+    std::vector<int> literal_var;
+    std::vector<int> literal_value;
+    std::vector<std::vector<int>> group;         // Image of each literal, every element but the identity
+    size_t generator_count;
+
+    bool detectValueSymmetry(const CSPInstance& csp);
+    bool loadDeclared(const CSPInstance& csp, std::string& error);
+
+public:
+    static const size_t MAX_GROUP_SIZE = 4096;
+    static const int MAX_CHECKED_LITERALS = 4096;
+
+    Symmetries();
+
+    // Declared symmetries if the instance has some, value symmetry otherwise.
+    // Returns false if a declared map is not a symmetry of the constraints.
+    bool detect(const CSPInstance& csp, std::string& error);
+
+    bool empty() const { return !value_symmetry && group.empty(); }
+    bool hasValueSymmetry() const { return value_symmetry; }
+    int getValueMin() const { return value_min; }
+    int getValueCount() const { return value_count; }
+    size_t getGroupSize() const { return group.size() + 1; }  // Declared group, identity included
+    size_t getGeneratorCount() const { return generator_count; }
+
+    // Image of var=value by an element of the declared group other than the identity
+    void image(size_t element, int var, int value, int& image_var, int& image_value) const {
+        int literal = group[element][offsets[var] + value - minima[var]];
+        image_var = literal_var[literal];
+        image_value = literal_value[literal];
+    }
+
+    // Size of the orbit of a canonical solution (used_values: distinct
+    // values it takes, read for the value symmetry only)
+    void addWeight(const Assignment& assignment, int used_values, SolutionWeightSum& sum) const;
+
+    // Distinct images of a solution by the declared group, sorted
+    void orbit(const std::map<int, int>& solution, std::vector<std::map<int, int>>& images) const;
+};
+
+// Lazy expansion of canonical solutions into their orbits (--orbits)
+class SymmetricSolutions {
+private:
+    const Symmetries& symmetries;
+    const std::vector<std::map<int, int>>& solutions;
+    size_t index;
+    bool prepared;                              // Orbit of solutions[index] started
+    std::vector<int> used;                      // Value symmetry: values of the solution, sorted
+    std::vector<int> cursor;                    // Image of used[i]: cursor[i]-th value not yet taken
+    std::vector<std::map<int, int>> images;     // Declared symmetries: orbit of the solution
+    size_t image_index;
+
+public:
+    SymmetricSolutions(const Symmetries& symmetries, const std::vector<std::map<int, int>>& canonical_solutions);
+
+    // Restart from the first solution
+    void reset();
+
+    // Build the next solution; returns false once all have been produced
+    bool next(std::map<int, int>& solution);
+};
+
+#endif // SYMMETRY_H
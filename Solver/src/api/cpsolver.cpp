@@ -0,0 +1,202 @@
+#include "cpsolver.h"
+#include "../solver/solver.h"
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include <sstream>
+#include <iterator>
+
+using namespace std;
+
+CPModel::CPModel() {
+    instance.num_variables = 0;
+}
+
+CPModel::CPModel(const CSPInstance& csp) : instance(csp) {}
+
+CPModel CPModel::fromFile(const string& filename) {
+    return CPModel(parseCSPFile(filename));
+}
+
+CPModel CPModel::fromText(const string& text) {
+    istringstream input(text);
+    return CPModel(parseCSP(input));
+}
+
+void CPModel::compile() {
+    if (!compiled) {
+        compiled = make_shared<const CompiledModel>(instance);
+    }
+}
+
+int CPModel::addVariable(int min_value, int max_value) {
+    if (min_value > max_value) {
+        throw invalid_argument("addVariable(): empty domain [" + to_string(min_value) + ", " +
+                               to_string(max_value) + "]");
+    }
+    compiled.reset();
+    instance.domains.push_back({min_value, max_value});
+    return instance.num_variables++;
+}
+
+void CPModel::addConstraint(int var1, int var2, const vector<pair<int, int>>& allowed_pairs) {
+    if (var1 < 0 || var1 >= instance.num_variables || var2 < 0 || var2 >= instance.num_variables) {
+        throw invalid_argument("addConstraint(): unknown variable in (" + to_string(var1) + ", " +
+                               to_string(var2) + ")");
+    }
+    compiled.reset();
+    instance.addConstraint(var1, var2, allowed_pairs);
+}
+
+const char* toString(CPStatus status) {
+    switch (status) {
+        case CPStatus::ALL_SOLUTIONS: return "All solutions found";
+        case CPStatus::SOLUTION_LIMIT: return "Solution limit reached";
+        case CPStatus::NODE_LIMIT: return "Node limit reached";
+        case CPStatus::TIMEOUT: return "Timeout";
+        case CPStatus::CANCELLED: return "Cancelled";
+        case CPStatus::INCONSISTENT: return "Inconsistent";
+    }
+    return "Unknown";
+}
+
+CPSession::CPSession(const CPModel& solved_model)
+    : model(solved_model), progress_interval(100000), cancel_requested(false),
+      solution_count(0), nodes_explored(0), backtracks(0), elapsed_ms(0), search_memory(0) {}
+
+CPSession::~CPSession() = default;
+
+void CPSession::onProgress(ProgressCallback callback, long long every_nodes) {
+    progress_callback = move(callback);
+    progress_interval = max(1LL, every_nodes);
+}
+
+void CPSession::restrictDomain(int var, const vector<int>& values) {
+    if (var < 0 || var >= model.getNumVariables()) {
+        throw invalid_argument("restrictDomain(): unknown variable " + to_string(var));
+    }
+    vector<int> sorted_values(values);
+    sort(sorted_values.begin(), sorted_values.end());
+    restrictions.push_back({var, sorted_values});
+}
+
+CPStatus CPSession::solve() {
+    auto start = chrono::high_resolution_clock::now();
+    auto elapsed = [&]() {
+        return static_cast<long long>(chrono::duration_cast<chrono::milliseconds>(
+            chrono::high_resolution_clock::now() - start).count());
+    };
+    
+    CSPSolver solver(model.getInstance());
+    solver.setStopFlag(&cancel_requested);
+    solver.setRandomSeed(options.seed);
+    if (model.getCompiledModel()) {
+        solver.setCompiledModel(model.getCompiledModel());
+    }
+    
+    CPStatus status = CPStatus::ALL_SOLUTIONS;
+    bool consistent = true;
+    if (!restrictions.empty()) {
+        // Domains stay sorted: keep the values present in every restriction
+        vector<Domain> domains = solver.getDomains();
+        for (const auto& restriction : restrictions) {
+            Domain& domain = domains[restriction.first];
+            vector<int> kept;
+            set_intersection(domain.begin(), domain.end(),
+                             restriction.second.begin(), restriction.second.end(), back_inserter(kept));
+            domain = Domain(kept);
+            consistent = consistent && !domain.empty();
+        }
+        solver.setDomains(domains);
+    }
+    if (consistent && options.use_ac3) {
+        consistent = solver.applyAC3(false);
+    }
+    if (consistent && options.use_sac) {
+        consistent = solver.applySAC(options.num_threads, options.sac_max_time_ms, false, false);
+    }
+    
+    if (!consistent) {
+        status = CPStatus::INCONSISTENT;
+    } else {
+        // Solutions go to the callback: the solver only counts them
+        SolverParams search = options;
+        search.max_time = numeric_limits<int>::max();
+        search.first_solution_only = false;
+        search.ac3_at_each_node = options.use_ac3 && options.ac3_at_each_node;
+        search.verbose = false;
+        search.show_global_stats_only = true;
+        search.count_only = true;
+        solver.beginSearch(search);
+        if (budget.time_limit_ms > 0) {
+            solver.setDeadline(start + chrono::milliseconds(budget.time_limit_ms));
+        }
+        
+        vector<int> values(model.getNumVariables());
+        long long next_progress = progress_interval;
+        bool searching = true;
+        while (searching) {
+            long long nodes = solver.getNodesExplored();
+            if (budget.node_limit > 0 && nodes >= budget.node_limit) {
+                status = CPStatus::NODE_LIMIT;
+                break;
+            }
+            
+            // Stop at the node limit and at each progress report
+            long long step_budget = numeric_limits<long long>::max();
+            if (budget.node_limit > 0) {
+                step_budget = budget.node_limit - nodes;
+            }
+            if (progress_callback) {
+                step_budget = min(step_budget, next_progress - nodes);
+            }
+            
+            CSPSolver::SearchStatus step_status = solver.step(step_budget);
+            
+            if (progress_callback && solver.getNodesExplored() >= next_progress) {
+                progress_callback(CPProgress{solver.getNodesExplored(), solver.getSolutionCount(),
+                                             solver.getSearchDepth(), elapsed()});
+                next_progress += progress_interval;
+            }
+            
+            switch (step_status) {
+                case CSPSolver::SearchStatus::RUNNING:
+                    break;
+                case CSPSolver::SearchStatus::SOLUTION: {
+                    const Assignment& assignment = solver.getAssignment();
+                    for (size_t var = 0; var < values.size(); var++) {
+                        values[var] = assignment.valueOf(static_cast<int>(var));
+                    }
+                    bool keep_going = !solution_callback || solution_callback(values);
+                    if (!keep_going || (budget.solution_limit > 0 &&
+                                        solver.getSolutionCount() >= budget.solution_limit)) {
+                        status = CPStatus::SOLUTION_LIMIT;
+                        searching = false;
+                    }
+                    break;
+                }
+                case CSPSolver::SearchStatus::EXHAUSTED:
+                    status = CPStatus::ALL_SOLUTIONS;
+                    searching = false;
+                    break;
+                case CSPSolver::SearchStatus::TIMEOUT:
+                    status = CPStatus::TIMEOUT;
+                    searching = false;
+                    break;
+                case CSPSolver::SearchStatus::CANCELLED:
+                    status = CPStatus::CANCELLED;
+                    searching = false;
+                    break;
+            }
+        }
+    }
+    
+    solution_count = solver.getSolutionCount();
+    nodes_explored = solver.getNodesExplored();
+    backtracks = solver.getBacktracks();
+    elapsed_ms = elapsed();
+    search_memory = solver.getMemoryUsage();
+    cancel_requested.store(false, memory_order_relaxed);
+    return status;
+}
@@ -0,0 +1,130 @@
+#ifndef CPSOLVER_API_H
+#define CPSOLVER_API_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include "../parser/parser.h"
+#include "../core/params.h"
+#include "../core/compiled_model.h"
+
+// API embarquable de CPSolver (libcpsolver) : aucune sortie console, aucun
+// état global. Un CPModel peut être partagé par plusieurs sessions ; une
+// session ne résout qu'une recherche à la fois, cancel() peut être appelé
+// depuis n'importe quel thread.
+
+// Modèle construit en mémoire ou lu depuis un fichier .csp
+class CPModel {
+private:
+    CSPInstance instance;
+    std::shared_ptr<const CompiledModel> compiled; // Set by compile(), reset by any change
+
+public:
+    CPModel();
+    explicit CPModel(const CSPInstance& csp);
+    
+    // Throws std::runtime_error like the parser
+    static CPModel fromFile(const std::string& filename);
+    // Contents of a .csp file already in memory
+    static CPModel fromText(const std::string& text);
+    
+    // Returns the id of the new variable (domain [min_value, max_value])
+    int addVariable(int min_value, int max_value);
+    // Binary constraint given by its allowed pairs (var1 value, var2 value);
+    // throws std::invalid_argument on unknown variables
+    void addConstraint(int var1, int var2, const std::vector<std::pair<int, int>>& allowed_pairs);
+    
+    // Builds the bitset form of the model once; the sessions of a compiled
+    // model share it instead of compiling it again (LCV support counts).
+    // Not thread-safe: compile before sharing the model.
+    void compile();
+    
+    int getNumVariables() const { return instance.num_variables; }
+    const CSPInstance& getInstance() const { return instance; }
+    const std::shared_ptr<const CompiledModel>& getCompiledModel() const { return compiled; }
+};
+
+// Limites d'une recherche (0 = pas de limite)
+struct CPBudget {
+    long long time_limit_ms = 0;            // Wall-clock deadline from the start of solve()
+    long long node_limit = 0;               // Nodes explored
+    unsigned long long solution_limit = 0;  // Solutions reported
+};
+
+// Avancement transmis au callback de progression
+struct CPProgress {
+    long long nodes_explored;
+    unsigned long long solutions;
+    int depth;                              // Open decisions
+    long long elapsed_ms;
+};
+
+enum class CPStatus {
+    ALL_SOLUTIONS,      // Search space exhausted
+    SOLUTION_LIMIT,     // solution_limit reached, or the solution callback returned false
+    NODE_LIMIT,
+    TIMEOUT,
+    CANCELLED,          // cancel() was called
+    INCONSISTENT        // Wiped out by the restrictions or the preprocessing (AC-3 / SAC)
+};
+
+const char* toString(CPStatus status);
+
+class CPSession {
+public:
+    // Solution values indexed by variable; return false to stop the search
+    using SolutionCallback = std::function<bool(const std::vector<int>& values)>;
+    using ProgressCallback = std::function<void(const CPProgress& progress)>;
+    
+    explicit CPSession(const CPModel& model);
+    ~CPSession();
+    
+    // Strategies and propagation are read from the SolverParams fields
+    // var_strategy, val_strategy, use_ac3, ac3_at_each_node,
+    // use_forward_checking, use_sac, sac_max_time_ms and num_threads
+    void setOptions(const SolverParams& params) { options = params; }
+    void setBudget(const CPBudget& new_budget) { budget = new_budget; }
+    void onSolution(SolutionCallback callback) { solution_callback = std::move(callback); }
+    void onProgress(ProgressCallback callback, long long every_nodes = 100000);
+    
+    // Unary restriction for the next solves: var keeps only the given values
+    // (throws std::invalid_argument on an unknown variable)
+    void restrictDomain(int var, const std::vector<int>& values);
+    void clearRestrictions() { restrictions.clear(); }
+    
+    // Chronological search with the options and budget; blocks until it stops
+    CPStatus solve();
+    
+    // Thread-safe: the running solve() returns CANCELLED at its next node.
+    // The request is cleared when solve() returns, so a cancel() issued
+    // before solve() cancels that solve().
+    void cancel() { cancel_requested.store(true, std::memory_order_relaxed); }
+    
+    // Statistics of the last solve()
+    unsigned long long getSolutionCount() const { return solution_count; }
+    long long getNodesExplored() const { return nodes_explored; }
+    long long getBacktracks() const { return backtracks; }
+    long long getElapsedMs() const { return elapsed_ms; }
+    // Approximate bytes of the search state (CSPSolver::getMemoryUsage())
+    size_t getSearchMemory() const { return search_memory; }
+
+private:
+    const CPModel& model;
+    SolverParams options;
+    CPBudget budget;
+    SolutionCallback solution_callback;
+    ProgressCallback progress_callback;
+    long long progress_interval;
+    std::vector<std::pair<int, std::vector<int>>> restrictions;
+    std::atomic<bool> cancel_requested;
+    
+    unsigned long long solution_count;
+    long long nodes_explored;
+    long long backtracks;
+    long long elapsed_ms;
+    size_t search_memory;
+};
+
+#endif // CPSOLVER_API_H
@@ -0,0 +1,206 @@
+#include "cpsolver_c.h"
+#include "cpsolver.h"
+#include "../strategies/strategies.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+
+using namespace std;
+
+struct cps_model {
+    CPModel model;
+};
+
+struct cps_session {
+    const cps_model* owner;
+    CPSession session;
+    SolverParams params;
+    CPBudget budget;
+    int num_variables;
+    vector<int> solutions; // Row-major, num_variables values per solution
+    size_t solution_rows = 0;
+
+    explicit cps_session(const cps_model* model)
+        : owner(model), session(model->model), num_variables(model->model.getNumVariables()) {}
+};
+
+namespace {
+
+thread_local string last_error;
+
+// Exceptions must not cross the C boundary
+template <typename F>
+auto guarded(F body, decltype(body()) failure) -> decltype(body()) {
+    try {
+        last_error.clear();
+        return body();
+    } catch (const exception& e) {
+        last_error = e.what();
+    } catch (...) {
+        last_error = "unknown error";
+    }
+    return failure;
+}
+
+long long parseInteger(const string& name, const string& value) {
+    size_t end = 0;
+    long long number = stoll(value, &end);
+    if (end != value.size()) throw invalid_argument("invalid value '" + value + "' for " + name);
+    return number;
+}
+
+bool parseFlag(const string& name, const string& value) {
+    if (value == "1" || value == "true") return true;
+    if (value == "0" || value == "false") return false;
+    throw invalid_argument("invalid value '" + value + "' for " + name + " (expected 0 or 1)");
+}
+
+const string& parseStrategy(const string& name, const string& value, bool (*known)(const string&),
+                            const char* expected) {
+    if (!known(value)) {
+        throw invalid_argument("invalid value '" + value + "' for " + name + " (expected " + expected + ")");
+    }
+    return value;
+}
+
+} // namespace
+
+extern "C" {
+
+const char* cps_last_error(void) {
+    return last_error.c_str();
+}
+
+const char* cps_status_name(int status) {
+    if (status < CPS_ALL_SOLUTIONS || status > CPS_INCONSISTENT) return "Unknown";
+    return toString(static_cast<CPStatus>(status));
+}
+
+cps_model* cps_model_new(void) {
+    return guarded([]() { return new cps_model(); }, static_cast<cps_model*>(nullptr));
+}
+
+cps_model* cps_model_from_file(const char* path) {
+    return guarded([path]() { return new cps_model{CPModel::fromFile(path)}; }, static_cast<cps_model*>(nullptr));
+}
+
+void cps_model_free(cps_model* model) {
+    delete model;
+}
+
+int cps_model_add_variables(cps_model* model, const int* mins, const int* maxs, size_t count) {
+    return guarded([=]() {
+        int first = model->model.getNumVariables();
+        for (size_t i = 0; i < count; i++) {
+            model->model.addVariable(mins[i], maxs[i]);
+        }
+        return first;
+    }, -1);
+}
+
+int cps_model_add_constraint(cps_model* model, int var1, int var2, const int* pairs, size_t pair_count) {
+    return guarded([=]() {
+        vector<pair<int, int>> allowed(pair_count);
+        for (size_t i = 0; i < pair_count; i++) {
+            allowed[i] = {pairs[2 * i], pairs[2 * i + 1]};
+        }
+        model->model.addConstraint(var1, var2, allowed);
+        return 0;
+    }, -1);
+}
+
+int cps_model_num_variables(const cps_model* model) {
+    return model->model.getNumVariables();
+}
+
+void cps_model_compile(cps_model* model) {
+    guarded([model]() { model->model.compile(); return 0; }, -1);
+}
+
+cps_session* cps_session_new(const cps_model* model) {
+    return guarded([model]() { return new cps_session(model); }, static_cast<cps_session*>(nullptr));
+}
+
+void cps_session_free(cps_session* session) {
+    delete session;
+}
+
+int cps_session_set_option(cps_session* session, const char* name, const char* value) {
+    return guarded([=]() {
+        string key = name;
+        string text = value;
+        SolverParams& params = session->params;
+        CPBudget& budget = session->budget;
+        if (key == "time_limit_ms") budget.time_limit_ms = parseInteger(key, text);
+        else if (key == "node_limit") budget.node_limit = parseInteger(key, text);
+        else if (key == "solution_limit") budget.solution_limit = parseInteger(key, text);
+        else if (key == "var_strategy") params.var_strategy = parseStrategy(key, text, isVariableStrategy, "mrv, degree, random");
+        else if (key == "val_strategy") params.val_strategy = parseStrategy(key, text, isValueStrategy, "lcv, random, lexicographic");
+        else if (key == "ac3") params.use_ac3 = parseFlag(key, text);
+        else if (key == "mac") params.ac3_at_each_node = parseFlag(key, text);
+        else if (key == "forward_checking") params.use_forward_checking = parseFlag(key, text);
+        else if (key == "sac") params.use_sac = parseFlag(key, text);
+        else if (key == "sac_time_ms") params.sac_max_time_ms = static_cast<int>(parseInteger(key, text));
+        else if (key == "threads") params.num_threads = static_cast<int>(parseInteger(key, text));
+        else if (key == "count_only") params.count_only = parseFlag(key, text);
+        else if (key == "seed") params.seed = static_cast<unsigned int>(parseInteger(key, text));
+        else throw invalid_argument("unknown option '" + key + "'");
+        return 0;
+    }, -1);
+}
+
+int cps_session_restrict(cps_session* session, int var, const int* values, size_t count) {
+    return guarded([=]() {
+        session->session.restrictDomain(var, vector<int>(values, values + count));
+        return 0;
+    }, -1);
+}
+
+int cps_session_solve(cps_session* session) {
+    return guarded([session]() {
+        SolverParams params = session->params;
+        if (!params.use_ac3) params.ac3_at_each_node = false;
+        session->session.setOptions(params);
+        session->session.setBudget(session->budget);
+        session->solutions.clear();
+        session->solution_rows = 0;
+        if (params.count_only) {
+            session->session.onSolution(nullptr);
+        } else {
+            session->session.onSolution([session](const vector<int>& values) {
+                session->solutions.insert(session->solutions.end(), values.begin(), values.end());
+                session->solution_rows++;
+                return true;
+            });
+        }
+        return static_cast<int>(session->session.solve());
+    }, -1);
+}
+
+void cps_session_cancel(cps_session* session) {
+    session->session.cancel();
+}
+
+const int* cps_session_solutions(const cps_session* session, size_t* count) {
+    *count = session->solution_rows;
+    return session->solutions.data();
+}
+
+unsigned long long cps_session_solution_count(const cps_session* session) {
+    return session->session.getSolutionCount();
+}
+
+long long cps_session_nodes(const cps_session* session) {
+    return session->session.getNodesExplored();
+}
+
+long long cps_session_backtracks(const cps_session* session) {
+    return session->session.getBacktracks();
+}
+
+long long cps_session_elapsed_ms(const cps_session* session) {
+    return session->session.getElapsedMs();
+}
+
+} // extern "C"
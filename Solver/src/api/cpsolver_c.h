@@ -0,0 +1,69 @@
+#ifndef CPSOLVER_C_H
+#define CPSOLVER_C_H
+
+#include <stddef.h>
+
+// Interface C de libcpsolver, pour les langages qui chargent la bibliothèque
+// partagée (module Python ctypes de python/cpsolver.py). Les fonctions qui
+// échouent renvoient -1 ou NULL ; cps_last_error() donne alors le message
+// (propre à chaque thread).
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct cps_model cps_model;
+typedef struct cps_session cps_session;
+
+// Statuses returned by cps_session_solve (same order as CPStatus)
+enum {
+    CPS_ALL_SOLUTIONS = 0,
+    CPS_SOLUTION_LIMIT = 1,
+    CPS_NODE_LIMIT = 2,
+    CPS_TIMEOUT = 3,
+    CPS_CANCELLED = 4,
+    CPS_INCONSISTENT = 5
+};
+
+const char* cps_last_error(void);
+const char* cps_status_name(int status);
+
+// Models
+cps_model* cps_model_new(void);
+cps_model* cps_model_from_file(const char* path);
+void cps_model_free(cps_model* model);
+// count variables with domains [mins[i], maxs[i]]; returns the id of the first one
+int cps_model_add_variables(cps_model* model, const int* mins, const int* maxs, size_t count);
+// Allowed pairs as a row-major (pair_count x 2) array of (var1 value, var2 value)
+int cps_model_add_constraint(cps_model* model, int var1, int var2, const int* pairs, size_t pair_count);
+int cps_model_num_variables(const cps_model* model);
+// Compiles the model once for all its sessions (see CPModel::compile)
+void cps_model_compile(cps_model* model);
+
+// Sessions: the model must outlive its sessions
+cps_session* cps_session_new(const cps_model* model);
+void cps_session_free(cps_session* session);
+// Options by name: time_limit_ms, node_limit, solution_limit, var_strategy,
+// val_strategy, ac3, mac, forward_checking, sac, sac_time_ms, threads,
+// count_only, seed (booleans are "0"/"1"). Returns 0, or -1 on an unknown name or value.
+int cps_session_set_option(cps_session* session, const char* name, const char* value);
+int cps_session_restrict(cps_session* session, int var, const int* values, size_t count);
+// Blocks until the search stops; callable from any thread (no global state)
+int cps_session_solve(cps_session* session);
+// Thread-safe: stops the running cps_session_solve
+void cps_session_cancel(cps_session* session);
+
+// Solutions of the last solve, row-major (count x variables), owned by the
+// session and valid until its next solve or its destruction. Not stored
+// with count_only.
+const int* cps_session_solutions(const cps_session* session, size_t* count);
+unsigned long long cps_session_solution_count(const cps_session* session);
+long long cps_session_nodes(const cps_session* session);
+long long cps_session_backtracks(const cps_session* session);
+long long cps_session_elapsed_ms(const cps_session* session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CPSOLVER_C_H
@@ -0,0 +1,48 @@
+#include "alloc_counter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+#ifdef CPSOLVER_COUNT_ALLOCS
+
+static atomic<unsigned long long> allocation_count(0);
+
+// Replacement of the global allocation functions: the array forms forward
+// to these by default
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, memory_order_relaxed);
+    if (void* pointer = malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    free(pointer);
+}
+
+bool heapAllocationCountEnabled() {
+    return true;
+}
+
+unsigned long long heapAllocationCount() {
+    return allocation_count.load(memory_order_relaxed);
+}
+
+#else
+
+bool heapAllocationCountEnabled() {
+    return false;
+}
+
+unsigned long long heapAllocationCount() {
+    return 0;
+}
+
+#endif
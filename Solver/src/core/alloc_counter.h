@@ -0,0 +1,9 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+// Compteur d'allocations sur le tas, actif seulement dans le build de
+// diagnostic (make alloc-check, -DCPSOLVER_COUNT_ALLOCS)
+bool heapAllocationCountEnabled();
+unsigned long long heapAllocationCount();
+
+#endif // ALLOC_COUNTER_H
@@ -0,0 +1,56 @@
+#ifndef ASSIGNMENT_H
+#define ASSIGNMENT_H
+
+#include <vector>
+#include <map>
+
+// Affectation courante indexée par variable : contrairement à std::map,
+// affecter ou désaffecter une variable n'alloue jamais de mémoire
+class Assignment {
+private:
+    std::vector<int> values;
+    std::vector<char> assigned;
+    int count;
+
+public:
+    explicit Assignment(int num_variables = 0)
+        : values(num_variables, 0), assigned(num_variables, 0), count(0) {}
+
+    void reset(int num_variables) {
+        values.assign(num_variables, 0);
+        assigned.assign(num_variables, 0);
+        count = 0;
+    }
+
+    bool isAssigned(int var) const { return assigned[var] != 0; }
+    int valueOf(int var) const { return values[var]; }
+    int size() const { return count; }
+
+    void assign(int var, int value) {
+        if (!assigned[var]) {
+            assigned[var] = 1;
+            count++;
+        }
+        values[var] = value;
+    }
+
+    void unassign(int var) {
+        if (assigned[var]) {
+            assigned[var] = 0;
+            count--;
+        }
+    }
+
+    // Copy as variable -> value (stored solutions)
+    std::map<int, int> toMap() const {
+        std::map<int, int> result;
+        for (size_t var = 0; var < values.size(); var++) {
+            if (assigned[var]) {
+                result.emplace_hint(result.end(), static_cast<int>(var), values[var]);
+            }
+        }
+        return result;
+    }
+};
+
+#endif // ASSIGNMENT_H
@@ -0,0 +1,77 @@
+#include "bigint.h"
+#include <cstdio>
+
+using namespace std;
+
+static const uint32_t LIMB_BASE = 1000000000;
+
+BigInt::BigInt(unsigned long long value) {
+    while (value > 0) {
+        limbs.push_back(static_cast<uint32_t>(value % LIMB_BASE));
+        value /= LIMB_BASE;
+    }
+}
+
+void BigInt::trim() {
+    while (!limbs.empty() && limbs.back() == 0) {
+        limbs.pop_back();
+    }
+}
+
+BigInt& BigInt::operator+=(const BigInt& other) {
+    if (limbs.size() < other.limbs.size()) {
+        limbs.resize(other.limbs.size(), 0);
+    }
+    uint32_t carry = 0;
+    for (size_t i = 0; i < limbs.size(); i++) {
+        uint64_t sum = static_cast<uint64_t>(limbs[i]) + carry + (i < other.limbs.size() ? other.limbs[i] : 0);
+        limbs[i] = static_cast<uint32_t>(sum % LIMB_BASE);
+        carry = static_cast<uint32_t>(sum / LIMB_BASE);
+        if (carry == 0 && i >= other.limbs.size()) {
+            break;
+        }
+    }
+    if (carry) {
+        limbs.push_back(carry);
+    }
+    return *this;
+}
+
+BigInt& BigInt::operator*=(const BigInt& other) {
+    if (isZero() || other.isZero()) {
+        limbs.clear();
+        return *this;
+    }
+    vector<uint64_t> product(limbs.size() + other.limbs.size(), 0);
+    for (size_t i = 0; i < limbs.size(); i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < other.limbs.size(); j++) {
+            uint64_t current = product[i + j] + static_cast<uint64_t>(limbs[i]) * other.limbs[j] + carry;
+            product[i + j] = current % LIMB_BASE;
+            carry = current / LIMB_BASE;
+        }
+        size_t k = i + other.limbs.size();
+        while (carry) {
+            uint64_t current = product[k] + carry;
+            product[k] = current % LIMB_BASE;
+            carry = current / LIMB_BASE;
+            k++;
+        }
+    }
+    limbs.assign(product.begin(), product.end());
+    trim();
+    return *this;
+}
+
+string BigInt::toString() const {
+    if (limbs.empty()) {
+        return "0";
+    }
+    string result = to_string(limbs.back());
+    char buffer[16];
+    for (size_t i = limbs.size() - 1; i-- > 0;) {
+        snprintf(buffer, sizeof(buffer), "%09u", limbs[i]);
+        result += buffer;
+    }
+    return result;
+}
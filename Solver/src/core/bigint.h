@@ -0,0 +1,65 @@
+#ifndef BIGINT_H
+#define BIGINT_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <ostream>
+
+// Arbitrary-precision unsigned integer (solution counts)
+// Stored as base 10^9 limbs, least significant first
+class BigInt {
+private:
+    std::vector<uint32_t> limbs;
+
+    void trim();
+
+public:
+    BigInt(unsigned long long value = 0);
+
+    bool isZero() const { return limbs.empty(); }
+
+    BigInt& operator+=(const BigInt& other);
+    BigInt& operator*=(const BigInt& other);
+    friend BigInt operator+(BigInt a, const BigInt& b) { return a += b; }
+    friend BigInt operator*(BigInt a, const BigInt& b) { return a *= b; }
+
+    bool operator==(const BigInt& other) const { return limbs == other.limbs; }
+    bool operator!=(const BigInt& other) const { return limbs != other.limbs; }
+
+    // Decimal representation
+    std::string toString() const;
+
+    // Approximate size in bytes (cache accounting)
+    size_t memoryUsage() const { return sizeof(BigInt) + limbs.capacity() * sizeof(uint32_t); }
+
+    friend std::ostream& operator<<(std::ostream& out, const BigInt& value) {
+        return out << value.toString();
+    }
+};
+
+// Exact sum of solution weights: weights are added on 64 bits and carried
+// into the BigInt only when the sum overflows, so that adding a solution
+// does not allocate
+class SolutionWeightSum {
+private:
+    BigInt total;
+    unsigned long long pending = 0;
+
+public:
+    void clear() {
+        total = BigInt(0);
+        pending = 0;
+    }
+    void add(unsigned long long weight) {
+        if (weight > ~0ULL - pending) {
+            total += BigInt(pending);
+            pending = 0;
+        }
+        pending += weight;
+    }
+    void add(const BigInt& weight) { total += weight; }
+    BigInt value() const { return total + BigInt(pending); }
+};
+
+#endif // BIGINT_H
@@ -0,0 +1,301 @@
+#include "compiled_model.h"
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <tuple>
+#include <queue>
+#include <cassert>
+
+using namespace std;
+
+static int wordsFor(int bits) {
+    return (max(bits, 0) + 63) / 64;
+}
+
+CompiledRelation::CompiledRelation(int r, int c)
+    : rows(max(r, 0)), cols(max(c, 0)), row_words(wordsFor(c)), col_words(wordsFor(r)),
+      bits(static_cast<size_t>(rows) * row_words, 0),
+      transposed_bits(static_cast<size_t>(cols) * col_words, 0) {}
+
+void CompiledRelation::allow(int a, int b) {
+    bits[static_cast<size_t>(a) * row_words + (b >> 6)] |= 1ULL << (b & 63);
+    transposed_bits[static_cast<size_t>(b) * col_words + (a >> 6)] |= 1ULL << (a & 63);
+}
+
+bool CompiledRelation::allows(int a, int b) const {
+    return testBit(row(a), b);
+}
+
+// Hash of a support matrix, with its dimensions
+static uint64_t hashBits(int rows, int cols, const vector<uint64_t>& bits) {
+    uint64_t hash = 14695981039346656037ULL ^ (static_cast<uint64_t>(rows) << 32 | static_cast<uint32_t>(cols));
+    for (uint64_t word : bits) {
+        hash = (hash ^ word) * 1099511628211ULL;
+        hash ^= hash >> 29;
+    }
+    return hash;
+}
+
+CompiledModel::CompiledModel(const CSPInstance& csp) : num_variables(csp.num_variables) {
+    offsets.resize(num_variables);
+    sizes.resize(num_variables);
+    for (int i = 0; i < num_variables; i++) {
+        offsets[i] = csp.domains[i].first;
+        sizes[i] = max(csp.domains[i].second - csp.domains[i].first + 1, 0);
+    }
+    arcs_from.resize(num_variables);
+
+    // One relation per pair of variables, oriented from the smaller id, in
+    // the order of their first constraint
+    vector<pair<int, int>> scopes;
+    vector<vector<int>> scope_constraints;
+    map<pair<int, int>, int> pair_scope;
+    for (size_t i = 0; i < csp.constraints.size(); i++) {
+        const Constraint& c = csp.constraints[i];
+        if (c.var1 == c.var2) {
+            continue; // Self-loops are ignored by the search as well
+        }
+        pair<int, int> scope(min(c.var1, c.var2), max(c.var1, c.var2));
+        auto inserted = pair_scope.emplace(scope, static_cast<int>(scopes.size()));
+        if (inserted.second) {
+            scopes.push_back(scope);
+            scope_constraints.emplace_back();
+        }
+        scope_constraints[inserted.first->second].push_back(static_cast<int>(i));
+    }
+
+    // Identical matrices are stored once: an arc reads its relation
+    // transposed when its variable indexes the relation's columns. A pair
+    // with a single constraint whose table and domains were already seen
+    // reuses the earlier result without compiling it again.
+    unordered_multimap<uint64_t, int> by_hash;
+    map<tuple<const Relation*, bool, int, int, int, int>, pair<int, bool>> compiled_tables;
+    for (size_t s = 0; s < scopes.size(); s++) {
+        int first = scopes[s].first;
+        int second = scopes[s].second;
+        const vector<int>& ids = scope_constraints[s];
+        tuple<const Relation*, bool, int, int, int, int> table_key;
+        if (ids.size() == 1) {
+            const Constraint& c = csp.constraints[ids[0]];
+            table_key = make_tuple(c.relation.get(), c.transposed != (c.var1 != first),
+                                   offsets[first], sizes[first], offsets[second], sizes[second]);
+            auto known = compiled_tables.find(table_key);
+            if (known != compiled_tables.end()) {
+                addArcs(first, second, known->second.first, known->second.second);
+                continue;
+            }
+        }
+
+        // Several constraints on the same pair: keep their conjunction
+        CompiledRelation relation(sizes[first], sizes[second]);
+        for (size_t k = 0; k < ids.size(); k++) {
+            const Constraint& c = csp.constraints[ids[k]];
+            // Relation pairs (p.first, p.second) read as (first, second) or reversed
+            bool reversed = c.transposed != (c.var1 != first);
+            CompiledRelation single(sizes[first], sizes[second]);
+            CompiledRelation& target = k == 0 ? relation : single;
+            for (const auto& p : c.relation->getPairs()) {
+                int a = (reversed ? p.second : p.first) - offsets[first];
+                int b = (reversed ? p.first : p.second) - offsets[second];
+                if (a >= 0 && a < sizes[first] && b >= 0 && b < sizes[second]) {
+                    target.allow(a, b);
+                }
+            }
+            if (k > 0) {
+                for (size_t w = 0; w < relation.bits.size(); w++) relation.bits[w] &= single.bits[w];
+                for (size_t w = 0; w < relation.transposed_bits.size(); w++) relation.transposed_bits[w] &= single.transposed_bits[w];
+            }
+        }
+
+        int index = -1;
+        bool transposed = false;
+        auto range = by_hash.equal_range(hashBits(relation.rows, relation.cols, relation.bits));
+        for (auto it = range.first; it != range.second && index < 0; ++it) {
+            const CompiledRelation& known = relations[it->second];
+            if (known.rows == relation.rows && known.cols == relation.cols && known.bits == relation.bits) {
+                index = it->second;
+            }
+        }
+        range = by_hash.equal_range(hashBits(relation.cols, relation.rows, relation.transposed_bits));
+        for (auto it = range.first; it != range.second && index < 0; ++it) {
+            const CompiledRelation& known = relations[it->second];
+            if (known.rows == relation.cols && known.cols == relation.rows && known.bits == relation.transposed_bits) {
+                index = it->second;
+                transposed = true;
+            }
+        }
+        if (index < 0) {
+            index = relations.size();
+            by_hash.emplace(hashBits(relation.rows, relation.cols, relation.bits), index);
+            relations.push_back(move(relation));
+        }
+        if (ids.size() == 1) {
+            compiled_tables[table_key] = make_pair(index, transposed);
+        }
+        addArcs(first, second, index, transposed);
+    }
+}
+
+void CompiledModel::addArcs(int first, int second, int relation, bool transposed) {
+    // Arcs are stored in pairs so that arc i and arc i^1 are reverse
+    arcs_from[first].push_back(arcs.size());
+    arcs.push_back(CompiledArc{first, second, relation, transposed});
+    arcs_from[second].push_back(arcs.size());
+    arcs.push_back(CompiledArc{second, first, relation, !transposed});
+}
+
+const uint64_t* CompiledModel::supports(const CompiledArc& arc, int value_index) const {
+    const CompiledRelation& relation = relations[arc.relation];
+    return arc.transposed ? relation.column(value_index) : relation.row(value_index);
+}
+
+bool CompiledModel::isConsistent(int var1, int val1, int var2, int val2) const {
+    int a = val1 - offsets[var1];
+    int b = val2 - offsets[var2];
+    if (a < 0 || a >= sizes[var1] || b < 0 || b >= sizes[var2]) {
+        return false;
+    }
+    for (int index : arcs_from[var1]) {
+        const CompiledArc& arc = arcs[index];
+        if (arc.neighbor == var2) {
+            return testBit(supports(arc, a), b);
+        }
+    }
+    return true;
+}
+
+vector<DomainBits> CompiledModel::toBits(const vector<Domain>& domains) const {
+    vector<DomainBits> bits(num_variables);
+    for (int i = 0; i < num_variables; i++) {
+        bits[i].assign(wordsFor(sizes[i]), 0);
+        for (int value : domains[i]) {
+            int index = value - offsets[i];
+            if (index >= 0 && index < sizes[i]) {
+                bits[i][index >> 6] |= 1ULL << (index & 63);
+            }
+        }
+    }
+    return bits;
+}
+
+vector<Domain> CompiledModel::toValues(const vector<DomainBits>& domains) const {
+    vector<Domain> values;
+    values.reserve(num_variables);
+    vector<int> domain_values;
+    for (int i = 0; i < num_variables; i++) {
+        domain_values.clear();
+        for (int index = 0; index < sizes[i]; index++) {
+            if (testBit(domains[i].data(), index)) {
+                domain_values.push_back(index + offsets[i]);
+            }
+        }
+        values.emplace_back(domain_values);
+    }
+    return values;
+}
+
+bool CompiledModel::reviseArc(const CompiledArc& arc, vector<DomainBits>& domains) const {
+    DomainBits& domain = domains[arc.var];
+    const DomainBits& neighbor_domain = domains[arc.neighbor];
+    bool revised = false;
+
+    for (size_t w = 0; w < domain.size(); w++) {
+        uint64_t word = domain[w];
+        while (word) {
+            int bit = __builtin_ctzll(word);
+            word &= word - 1;
+            int index = static_cast<int>(w * 64) + bit;
+
+            const uint64_t* row = supports(arc, index);
+            bool has_support = false;
+            for (size_t k = 0; k < neighbor_domain.size(); k++) {
+                if (row[k] & neighbor_domain[k]) {
+                    has_support = true;
+                    break;
+                }
+            }
+            if (!has_support) {
+                domain[w] &= ~(1ULL << bit);
+                revised = true;
+            }
+        }
+    }
+    return revised;
+}
+
+bool CompiledModel::enforceArcConsistency(vector<DomainBits>& domains,
+                                          const vector<int>& changed_vars) const {
+    queue<int> worklist;
+    vector<char> in_queue(num_variables, 0);
+    if (changed_vars.empty()) {
+        for (int i = 0; i < num_variables; i++) {
+            worklist.push(i);
+            in_queue[i] = 1;
+        }
+    } else {
+        for (int v : changed_vars) {
+            if (!in_queue[v]) {
+                worklist.push(v);
+                in_queue[v] = 1;
+            }
+        }
+    }
+
+    while (!worklist.empty()) {
+        int var = worklist.front();
+        worklist.pop();
+        in_queue[var] = 0;
+
+        // var changed: revise every arc pointing to it
+        for (int index : arcs_from[var]) {
+            const CompiledArc& reverse = arcs[index ^ 1];
+            assert(reverse.neighbor == var && "enforceArcConsistency(): arcs are not paired");
+            if (reviseArc(reverse, domains)) {
+                if (countBits(domains[reverse.var]) == 0) {
+                    return false;
+                }
+                if (!in_queue[reverse.var]) {
+                    worklist.push(reverse.var);
+                    in_queue[reverse.var] = 1;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool CompiledModel::enforceDirectionalArcConsistency(vector<DomainBits>& domains,
+                                                     const vector<int>& order) const {
+    vector<int> position(num_variables, -1);
+    for (size_t i = 0; i < order.size(); i++) {
+        position[order[i]] = i;
+    }
+
+    // Last variable first: once a variable has been used to revise its
+    // earlier neighbors, its own domain never changes again
+    for (size_t i = order.size(); i-- > 0;) {
+        int var = order[i];
+        for (int index : arcs_from[var]) {
+            const CompiledArc& reverse = arcs[index ^ 1];
+            if (position[reverse.var] == -1 || position[reverse.var] >= static_cast<int>(i)) {
+                continue;
+            }
+            if (reviseArc(reverse, domains) && countBits(domains[reverse.var]) == 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+size_t CompiledModel::memoryUsage() const {
+    size_t bytes = sizeof(CompiledModel) + (offsets.capacity() + sizes.capacity()) * sizeof(int) +
+                   arcs.capacity() * sizeof(CompiledArc) + relations.capacity() * sizeof(CompiledRelation);
+    for (const CompiledRelation& relation : relations) {
+        bytes += (relation.bits.capacity() + relation.transposed_bits.capacity()) * sizeof(uint64_t);
+    }
+    for (const auto& from : arcs_from) {
+        bytes += sizeof(from) + from.capacity() * sizeof(int);
+    }
+    return bytes;
+}
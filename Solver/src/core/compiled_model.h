@@ -0,0 +1,100 @@
+#ifndef COMPILED_MODEL_H
+#define COMPILED_MODEL_H
+
+#include <vector>
+#include <cstdint>
+#include "../parser/parser.h"
+
+// Domain of one variable as a bitset over value indices (value - min)
+typedef std::vector<uint64_t> DomainBits;
+
+// Binary relation compiled as a support matrix over value indices: row a
+// holds the values of the second variable compatible with the first
+// variable's value a; the transposed matrix gives the reverse direction.
+struct CompiledRelation {
+    int rows;
+    int cols;
+    int row_words;
+    int col_words;
+    std::vector<uint64_t> bits;            // rows x row_words
+    std::vector<uint64_t> transposed_bits; // cols x col_words
+
+    CompiledRelation(int r, int c);
+
+    void allow(int a, int b);
+    bool allows(int a, int b) const;
+    const uint64_t* row(int a) const { return &bits[static_cast<size_t>(a) * row_words]; }
+    const uint64_t* column(int b) const { return &transposed_bits[static_cast<size_t>(b) * col_words]; }
+};
+
+// Directed arc var -> neighbor over a relation (read transposed when var is
+// the relation's second variable)
+struct CompiledArc {
+    int var;
+    int neighbor;
+    int relation;
+    bool transposed;
+};
+
+// Immutable, compiled view of a CSP instance: every pair of constrained
+// variables gets a single relation (the conjunction of its constraints).
+// Pairs with identical matrices, up to a transposition, share one relation,
+// so coloring- or nqueens-like instances hold a few matrices instead of one
+// per pair. It is safe to share between threads.
+class CompiledModel {
+private:
+    int num_variables;
+    std::vector<int> offsets;                 // Minimum value of each variable
+    std::vector<int> sizes;                   // Initial domain size of each variable
+    std::vector<CompiledRelation> relations;
+    std::vector<CompiledArc> arcs;
+    std::vector<std::vector<int>> arcs_from;  // Arc indices leaving each variable
+
+    bool reviseArc(const CompiledArc& arc, std::vector<DomainBits>& domains) const;
+    void addArcs(int first, int second, int relation, bool transposed);
+
+public:
+    CompiledModel(const CSPInstance& csp);
+
+    int getNumVariables() const { return num_variables; }
+    int getOffset(int var) const { return offsets[var]; }
+    int getSize(int var) const { return sizes[var]; }
+    const std::vector<int>& getArcsFrom(int var) const { return arcs_from[var]; }
+    const CompiledArc& getArc(int index) const { return arcs[index]; }
+    const CompiledRelation& getRelation(int index) const { return relations[index]; }
+    size_t getRelationCount() const { return relations.size(); }     // Distinct matrices
+    size_t getConstrainedPairCount() const { return arcs.size() / 2; }
+    size_t memoryUsage() const;                                       // Approximate size in bytes
+
+    // Support rows of var=value_index towards the arc's neighbor
+    const uint64_t* supports(const CompiledArc& arc, int value_index) const;
+    bool isConsistent(int var1, int val1, int var2, int val2) const;
+
+    // Conversions between domains and bitsets
+    std::vector<DomainBits> toBits(const std::vector<Domain>& domains) const;
+    std::vector<Domain> toValues(const std::vector<DomainBits>& domains) const;
+
+    // AC-3 over the bitset domains, started from the arcs towards the given
+    // variables (all variables when empty). Returns false on a domain wipeout.
+    bool enforceArcConsistency(std::vector<DomainBits>& domains,
+                               const std::vector<int>& changed_vars = std::vector<int>()) const;
+
+    // Directional arc consistency along the given order: every value of a
+    // variable keeps a support in each later neighbor. Returns false on a
+    // domain wipeout.
+    bool enforceDirectionalArcConsistency(std::vector<DomainBits>& domains,
+                                          const std::vector<int>& order) const;
+};
+
+// Bitset helpers
+inline bool testBit(const uint64_t* words, int index) {
+    return (words[index >> 6] >> (index & 63)) & 1ULL;
+}
+
+inline int countBits(const DomainBits& words) {
+    int count = 0;
+    for (uint64_t w : words) count += __builtin_popcountll(w);
+    return count;
+}
+
+#endif // COMPILED_MODEL_H
@@ -0,0 +1,274 @@
+#ifndef DOMAIN_H
+#define DOMAIN_H
+
+#include <vector>
+#include <iterator>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+// Domaine d'une variable, parcouru par valeurs croissantes. Tant qu'il n'a
+// pas de trou, c'est un intervalle [min, max] : aucune valeur n'est stockée
+// et les réductions de bornes sont en O(1). Au premier trou, il passe à un
+// bitset sur son étendue d'origine (un bit par valeur), et redevient un
+// intervalle dès que ses valeurs sont de nouveau contiguës.
+class Domain {
+private:
+    int base;                    // Première valeur de l'étendue d'origine (bit 0)
+    long long span;              // Taille de l'étendue d'origine
+    int lo, hi;                  // Plus petite et plus grande valeur (lo > hi : vide)
+    long long count;             // Nombre de valeurs
+    bool holes;                  // Bitset (sinon intervalle [lo, hi])
+    std::vector<uint64_t> bits;  // Valide seulement en mode bitset
+
+    size_t indexOf(int value) const { return static_cast<size_t>(static_cast<long long>(value) - base); }
+    bool testBit(int value) const {
+        size_t index = indexOf(value);
+        return (bits[index >> 6] >> (index & 63)) & 1;
+    }
+
+    // Materializes the bitset of the current interval before a hole is made
+    void makeHoles() {
+        if (holes) return;
+        bits.assign(static_cast<size_t>((span + 63) >> 6), 0);
+        for (long long v = lo; v <= hi; v++) {
+            size_t index = indexOf(static_cast<int>(v));
+            bits[index >> 6] |= 1ULL << (index & 63);
+        }
+        holes = true;
+    }
+
+    // Back to an interval once the values are contiguous again
+    void normalize() {
+        if (count == 0) {
+            holes = false;
+            hi = lo - 1;
+        } else if (holes && count == static_cast<long long>(hi) - lo + 1) {
+            holes = false;
+        }
+    }
+
+    // Smallest value >= from (hi + 1 if none)
+    long long nextFrom(long long from) const {
+        if (!holes) return from;
+        if (from > hi) return static_cast<long long>(hi) + 1;
+        size_t index = indexOf(static_cast<int>(from));
+        size_t last = indexOf(hi);
+        size_t word = index >> 6;
+        uint64_t current = bits[word] & (~0ULL << (index & 63));
+        while (true) {
+            if (current) {
+                return base + static_cast<long long>((word << 6) + __builtin_ctzll(current));
+            }
+            if (++word > (last >> 6)) break;
+            current = bits[word];
+        }
+        return static_cast<long long>(hi) + 1;
+    }
+
+    // Largest value <= from (lo - 1 if none)
+    long long previousFrom(long long from) const {
+        if (!holes) return from;
+        if (from < lo) return static_cast<long long>(lo) - 1;
+        size_t index = indexOf(static_cast<int>(from));
+        size_t word = index >> 6;
+        uint64_t current = bits[word] & (~0ULL >> (63 - (index & 63)));
+        while (true) {
+            if (current) {
+                return base + static_cast<long long>((word << 6) + 63 - __builtin_clzll(current));
+            }
+            if (word == 0) break;
+            current = bits[--word];
+        }
+        return static_cast<long long>(lo) - 1;
+    }
+
+public:
+    class const_iterator {
+    private:
+        const Domain* domain;
+        long long value;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef int value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const int* pointer;
+        typedef int reference;
+
+        const_iterator(const Domain* d, long long v) : domain(d), value(v) {}
+        int operator*() const { return static_cast<int>(value); }
+        const_iterator& operator++() {
+            value = domain->nextFrom(value + 1);
+            return *this;
+        }
+        bool operator==(const const_iterator& other) const { return value == other.value; }
+        bool operator!=(const const_iterator& other) const { return value != other.value; }
+    };
+
+    Domain() : base(0), span(0), lo(0), hi(-1), count(0), holes(false) {}
+
+    // Interval [min_value, max_value], empty if min_value > max_value
+    Domain(int min_value, int max_value)
+        : base(min_value), span(0), lo(min_value), hi(max_value), count(0), holes(false) {
+        if (lo <= hi) {
+            span = static_cast<long long>(hi) - lo + 1;
+            count = span;
+        } else {
+            hi = lo - 1;
+        }
+    }
+
+    // Sorted values without duplicates (an interval if they are contiguous)
+    explicit Domain(const std::vector<int>& values) : Domain() {
+        if (values.empty()) return;
+        base = lo = values.front();
+        hi = values.back();
+        span = static_cast<long long>(hi) - lo + 1;
+        count = static_cast<long long>(values.size());
+        if (count < span) {
+            bits.assign(static_cast<size_t>((span + 63) >> 6), 0);
+            for (int value : values) {
+                size_t index = indexOf(value);
+                bits[index >> 6] |= 1ULL << (index & 63);
+            }
+            holes = true;
+        }
+    }
+
+    size_t size() const { return static_cast<size_t>(count); }
+    // Approximate size in bytes
+    size_t memoryUsage() const { return sizeof(Domain) + bits.capacity() * sizeof(uint64_t); }
+    bool empty() const { return count == 0; }
+    bool isInterval() const { return !holes; }
+    int min() const { return lo; }
+    int max() const { return hi; }
+
+    bool contains(int value) const {
+        if (value < lo || value > hi) return false;
+        return !holes || testBit(value);
+    }
+
+    const_iterator begin() const {
+        return const_iterator(this, empty() ? static_cast<long long>(hi) + 1 : lo);
+    }
+    const_iterator end() const { return const_iterator(this, static_cast<long long>(hi) + 1); }
+
+    std::vector<int> values() const { return std::vector<int>(begin(), end()); }
+
+    // Reserves the bitset, so that making holes later does not allocate
+    // (the memory is only touched once the domain has holes)
+    void reserveHoles() { bits.reserve(static_cast<size_t>((span + 63) >> 6)); }
+
+    // Bounds reductions: O(1) on an interval
+    void removeBelow(int value) {
+        if (value <= lo) return;
+        if (value > hi) {
+            count = 0;
+            normalize();
+            return;
+        }
+        if (holes) {
+            for (long long v = lo; v < value; v++) {
+                if (testBit(static_cast<int>(v))) {
+                    size_t index = indexOf(static_cast<int>(v));
+                    bits[index >> 6] &= ~(1ULL << (index & 63));
+                    count--;
+                }
+            }
+            lo = static_cast<int>(nextFrom(value));
+        } else {
+            count -= static_cast<long long>(value) - lo;
+            lo = value;
+        }
+        normalize();
+    }
+
+    void removeAbove(int value) {
+        if (value >= hi) return;
+        if (value < lo) {
+            count = 0;
+            normalize();
+            return;
+        }
+        if (holes) {
+            for (long long v = static_cast<long long>(value) + 1; v <= hi; v++) {
+                if (testBit(static_cast<int>(v))) {
+                    size_t index = indexOf(static_cast<int>(v));
+                    bits[index >> 6] &= ~(1ULL << (index & 63));
+                    count--;
+                }
+            }
+            hi = static_cast<int>(previousFrom(value));
+        } else {
+            count -= static_cast<long long>(hi) - value;
+            hi = value;
+        }
+        normalize();
+    }
+
+    // Narrows or widens an interval to [min_value, max_value] (within the
+    // original extent); used by the trail to undo a bounds reduction
+    void setBounds(int min_value, int max_value) {
+        assert(!holes && "Domain::setBounds(): the domain has holes");
+        lo = min_value;
+        hi = max_value;
+        count = lo <= hi ? static_cast<long long>(hi) - lo + 1 : 0;
+        normalize();
+    }
+
+    bool remove(int value) {
+        if (!contains(value)) return false;
+        if (value == lo) {
+            removeBelow(value + 1);
+        } else if (value == hi) {
+            removeAbove(value - 1);
+        } else {
+            makeHoles();
+            size_t index = indexOf(value);
+            bits[index >> 6] &= ~(1ULL << (index & 63));
+            count--;
+        }
+        return true;
+    }
+
+    // Removes values of the domain, sorted in increasing order
+    void removeSorted(const int* values, size_t n) {
+        if (n == 0) return;
+        makeHoles();
+        for (size_t i = 0; i < n; i++) {
+            size_t index = indexOf(values[i]);
+            bits[index >> 6] &= ~(1ULL << (index & 63));
+        }
+        count -= static_cast<long long>(n);
+        if (count > 0) {
+            if (values[0] == lo) lo = static_cast<int>(nextFrom(lo));
+            if (values[n - 1] == hi) hi = static_cast<int>(previousFrom(hi));
+        }
+        normalize();
+    }
+
+    // Puts back values removed from the domain, sorted in increasing order
+    void insertSorted(const int* values, size_t n) {
+        if (n == 0) return;
+        if (count == 0) {
+            // Nothing to keep: the bitset is rebuilt from the values
+            bits.assign(static_cast<size_t>((span + 63) >> 6), 0);
+            holes = true;
+            lo = values[0];
+            hi = values[n - 1];
+        } else {
+            makeHoles();
+            if (values[0] < lo) lo = values[0];
+            if (values[n - 1] > hi) hi = values[n - 1];
+        }
+        for (size_t i = 0; i < n; i++) {
+            size_t index = indexOf(values[i]);
+            bits[index >> 6] |= 1ULL << (index & 63);
+        }
+        count += static_cast<long long>(n);
+        normalize();
+    }
+};
+
+#endif // DOMAIN_H
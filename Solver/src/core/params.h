@@ -8,15 +8,44 @@ struct SolverParams {
     // Time and solution limits
     int max_time = 300;           // Maximum time in seconds
     bool first_solution_only = false;  // Stop at first solution
+    bool count_only = false;      // Count the solutions without storing them
     
     // Search strategies
     std::string var_strategy = "mrv";  // Variable selection strategy (mrv, degree, random)
     std::string val_strategy = "lcv";  // Value selection strategy (lcv, random, lexicographic)
+    unsigned int seed = 0;        // Seed of the random strategies (0 = different at each run)
     
     // Constraint propagation
     bool use_ac3 = true;          // Use AC-3
     bool use_forward_checking = true;  // Use forward checking
     bool ac3_at_each_node = true; // Apply AC-3 at each backtracking node
+    bool use_sac = false;         // Singleton arc consistency preprocessing
+    int sac_max_time_ms = 5000;   // Time budget of the SAC preprocessing in milliseconds
+    bool merge_interchangeable = false; // Search one value per class of interchangeable values
+    bool break_symmetries = false;  // Break value symmetry and declared symmetries during the search
+    bool expand_orbits = false;     // Output the orbit of each canonical solution (implies break_symmetries)
+    
+    // Parallelism
+    int num_threads = 0;          // Worker threads (0 = number of hardware threads)
+    
+    // Search
+    bool decompose = false;       // Solve the connected components of the constraint graph independently
+    bool use_tree_decomposition = false; // Backtracking along a min-fill tree decomposition (BTD)
+    bool use_cbj = false;         // Conflict-directed backjumping instead of chronological backtracking
+    bool use_nogoods = false;     // Learn nogoods from dead ends (implies CBJ)
+    int max_nogoods = 10000;      // Nogood database capacity before the least active ones are deleted
+    
+    // Model counting
+    bool use_counter = false;     // Exact counting with dynamic decomposition and component caching (implies count_only)
+    int counter_cache_mb = 256;   // Memory budget of the component cache and of the BTD records in MB
+    
+    // Checkpointing (chronological search only)
+    std::string checkpoint_path = "";  // Checkpoint file written periodically, at timeout and at the end (empty = none)
+    int checkpoint_interval = 60;      // Seconds between two periodic checkpoints
+    std::string resume_path = "";      // Checkpoint to resume from (empty = new search)
+    
+    // Server mode (--serve)
+    int cache_models = 32;        // Compiled models kept by the server (least recently used evicted)
     
     // Output control
     bool verbose = false;         // Verbose mode (disabled by default)
@@ -27,8 +56,15 @@ struct SolverParams {
     bool show_memory_usage = true; // Show memory usage information
     bool show_global_stats_only = false; // Show main steps but not detailed tracing
     
+    // Statistics
+    std::string stats_json_path = "";  // Per-phase times and search counters as JSON (empty = none)
+    double progress_interval = 0;      // Seconds between two progress lines on stderr (0 = none)
+    bool progress_json = false;        // Progress as JSON lines
+    std::string trace_path = "";       // Binary trace of every node event (empty = none)
+    
     // Output path
-    std::string output_path = "";      // Custom output path (empty = use default)
+    std::string output_path = "";      // Custom output path (empty = use default); directory of the .sol files in batch mode
+    std::string summary_path = "";     // Batch summary table, CSV or .json (empty = <output directory>/batch_summary.csv)
 };
 
 #endif // PARAMS_H
@@ -0,0 +1,22 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <atomic>
+
+// Avancement d'une recherche publié pour un autre thread (--progress). La
+// recherche écrit ces valeurs avec des stores relaxed toutes les
+// CLOCK_CHECK_NODES nœuds, au moment où elle lit déjà l'horloge ; le thread
+// de rapport les lit sans verrou. Les valeurs ne sont pas cohérentes entre
+// elles à un instant donné, ce qui suffit pour un affichage.
+struct SearchProgress {
+    std::atomic<long long> nodes{0};
+    std::atomic<unsigned long long> solutions{0};
+    std::atomic<int> depth{0};                  // Assigned variables
+    // Part of the search tree already explored, in [0, 1]: each completed
+    // branch of a node on the current path weighs 1 / (product of the
+    // branching factors down to it), as a probe of Knuth's estimator
+    // following the current path would weigh it. -1 when unknown (CBJ).
+    std::atomic<double> explored_fraction{-1.0};
+};
+
+#endif // PROGRESS_H
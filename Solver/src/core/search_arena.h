@@ -0,0 +1,172 @@
+#ifndef SEARCH_ARENA_H
+#define SEARCH_ARENA_H
+
+#include <vector>
+#include <cstddef>
+#include <cassert>
+#include "domain.h"
+
+// Pile à capacité fixe : la mémoire est réservée une fois au début de la
+// recherche, push/pop n'allouent jamais. La réserve n'est pas initialisée :
+// seules les pages effectivement atteintes par la pile sont résidentes.
+template <typename T>
+class FixedStack {
+private:
+    std::vector<T> items;
+    size_t limit;
+
+public:
+    FixedStack() : limit(0) {}
+
+    void reserve(size_t capacity) {
+        items.clear();
+        items.reserve(capacity);
+        limit = capacity;
+    }
+
+    void push(const T& item) {
+        assert(items.size() < limit && "FixedStack::push(): capacity exceeded");
+        items.push_back(item);
+    }
+    void pop() { items.pop_back(); }
+    void truncate(size_t size) { items.resize(size); }
+
+    T& back() { return items.back(); }
+    T& operator[](size_t index) { return items[index]; }
+    const T& operator[](size_t index) const { return items[index]; }
+    size_t size() const { return items.size(); }
+    size_t capacity() const { return limit; }
+    bool empty() const { return items.empty(); }
+    size_t memoryUsage() const { return items.capacity() * sizeof(T); }
+};
+
+// Trail of domain reductions: instead of copying every domain at each node,
+// the removed values are recorded and put back on backtrack. A reduction
+// that leaves an interval domain contiguous only records its old bounds.
+class DomainTrail {
+private:
+    struct Frame {
+        int var;
+        int removed;    // Number of values removed
+        bool bounds;    // Only the old bounds are recorded, no value
+        int old_min;
+        int old_max;
+    };
+    FixedStack<int> removed_values;
+    FixedStack<Frame> frames;
+    size_t removed_count = 0;
+
+public:
+    // A value is removed at most once along a branch: the total size of the
+    // domains bounds both stacks
+    void reserve(const std::vector<Domain>& domains) {
+        size_t total = 0;
+        for (const auto& domain : domains) total += domain.size();
+        removed_values.reserve(total);
+        frames.reserve(total);
+        removed_count = 0;
+    }
+
+    size_t mark() const { return frames.size(); }
+    
+    // Values currently removed (their difference measures a propagation)
+    size_t removedCount() const { return removed_count; }
+    
+    // Total size of the domains the trail was sized for
+    size_t capacity() const { return removed_values.capacity(); }
+    size_t memoryUsage() const { return removed_values.memoryUsage() + frames.memoryUsage(); }
+
+    // Keep the values of var accepted by keep; returns the number removed
+    template <typename Predicate>
+    int filter(std::vector<Domain>& domains, int var, Predicate keep) {
+        Domain& domain = domains[var];
+        size_t removed_begin = removed_values.size();
+        int removed = 0;
+        int first_kept = 0, last_kept = 0;
+        bool kept_any = false;
+        bool gap = false; // A removed value between two kept ones
+        bool removed_since_kept = false;
+        for (int value : domain) {
+            if (keep(value)) {
+                if (!kept_any) first_kept = value;
+                gap = gap || (kept_any && removed_since_kept);
+                kept_any = true;
+                removed_since_kept = false;
+                last_kept = value;
+            } else {
+                removed_values.push(value);
+                removed++;
+                removed_since_kept = true;
+            }
+        }
+        if (removed == 0) {
+            return 0;
+        }
+        removed_count += removed;
+        if (domain.isInterval() && !gap) {
+            removed_values.truncate(removed_begin);
+            frames.push(Frame{var, removed, true, domain.min(), domain.max()});
+            if (kept_any) {
+                domain.setBounds(first_kept, last_kept);
+            } else {
+                domain.setBounds(domain.min(), domain.min() - 1);
+            }
+        } else {
+            domain.removeSorted(&removed_values[removed_begin], removed);
+            frames.push(Frame{var, removed, false, 0, 0});
+        }
+        return removed;
+    }
+
+    // Put back every value removed since the mark
+    void undo(std::vector<Domain>& domains, size_t mark) {
+        while (frames.size() > mark) {
+            Frame frame = frames.back();
+            frames.pop();
+            Domain& domain = domains[frame.var];
+            removed_count -= frame.removed;
+            if (frame.bounds) {
+                domain.setBounds(frame.old_min, frame.old_max);
+            } else {
+                size_t removed_begin = removed_values.size() - frame.removed;
+                domain.insertSorted(&removed_values[removed_begin], frame.removed);
+                removed_values.truncate(removed_begin);
+            }
+        }
+    }
+};
+
+// Undo log of the explanations of the domain reductions (CBJ): along a
+// branch they only grow, so each growth records the previous size and
+// undo truncates them back
+class ExplanationTrail {
+private:
+    struct Entry {
+        int var;
+        size_t size;
+    };
+    FixedStack<Entry> entries;
+
+public:
+    // One entry per domain reduction: the total size of the domains
+    // (DomainTrail::capacity) bounds the stack
+    void reserve(size_t capacity) { entries.reserve(capacity); }
+
+    size_t mark() const { return entries.size(); }
+
+    // To be called before adding variables to explanations[var]
+    void save(const std::vector<std::vector<int>>& explanations, int var) {
+        entries.push(Entry{var, explanations[var].size()});
+    }
+
+    // Truncate every explanation that grew since the mark
+    void undo(std::vector<std::vector<int>>& explanations, size_t mark) {
+        while (entries.size() > mark) {
+            const Entry& entry = entries.back();
+            explanations[entry.var].resize(entry.size);
+            entries.pop();
+        }
+    }
+};
+
+#endif // SEARCH_ARENA_H
@@ -0,0 +1,24 @@
+#include "stats.h"
+#include <sys/resource.h>
+
+const char* phaseName(Phase phase) {
+    switch (phase) {
+        case Phase::PARSE: return "parse";
+        case Phase::PRESOLVE: return "presolve";
+        case Phase::INITIAL_AC: return "initial_ac";
+        case Phase::PROPAGATION: return "propagation";
+        case Phase::SELECTION: return "selection";
+        case Phase::VALUE_ORDERING: return "value_ordering";
+        case Phase::SEARCH: return "search";
+        case Phase::OUTPUT: return "output";
+    }
+    return "unknown";
+}
+
+long peakRssKb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return usage.ru_maxrss; // Kilobytes on Linux
+}
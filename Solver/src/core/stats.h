@@ -0,0 +1,76 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <chrono>
+#include <vector>
+
+// Statistiques détaillées d'une résolution (--stats-json) : temps par phase,
+// mesurés par des minuteurs de portée, et compteurs 64 bits. Les compteurs
+// sont de simples incréments toujours actifs ; les minuteurs ne lisent
+// l'horloge que si une table de temps leur est donnée (nullptr sinon), si
+// bien que la recherche ne paie qu'un test par phase sans --stats-json.
+
+enum class Phase {
+    PARSE,           // Lecture du fichier .csp
+    PRESOLVE,        // Prétraitement SAC
+    INITIAL_AC,      // AC-3 avant la recherche
+    PROPAGATION,     // Test de cohérence, forward checking et MAC à chaque nœud
+    SELECTION,       // Choix de la variable
+    VALUE_ORDERING,  // Ordre des valeurs
+    SEARCH,          // Recherche complète (contient les trois phases précédentes)
+    OUTPUT           // Affichage et écriture des solutions
+};
+const int PHASE_COUNT = 8;
+
+// JSON name of a phase ("parse", "initial_ac", ...)
+const char* phaseName(Phase phase);
+
+// Cumulated time and number of timed scopes of each phase
+struct PhaseTimes {
+    long long ns[PHASE_COUNT] = {};
+    long long calls[PHASE_COUNT] = {};
+
+    void add(Phase phase, long long elapsed_ns) {
+        ns[static_cast<int>(phase)] += elapsed_ns;
+        calls[static_cast<int>(phase)]++;
+    }
+};
+
+// Adds the lifetime of the scope to a phase (nothing if times is null)
+class ScopedTimer {
+private:
+    PhaseTimes* times;
+    Phase phase;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    ScopedTimer(PhaseTimes* target, Phase timed_phase) : times(target), phase(timed_phase) {
+        if (times) start = std::chrono::steady_clock::now();
+    }
+    ~ScopedTimer() {
+        if (times) {
+            times->add(phase, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+    }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+// Work counters of a CSPSolver (search, initial AC-3 and MAC)
+struct SearchCounters {
+    long long nodes = 0;
+    long long backtracks = 0;
+    long long backjumps = 0;
+    long long constraint_checks = 0;   // Calls to CSPInstance::isConsistent
+    long long revisions = 0;           // AC-3 revisions that removed values
+    long long wipeouts = 0;            // Domains emptied by FC or AC-3
+    int max_depth = 0;                 // Deepest node opened
+    std::vector<long long> variable_wipeouts;   // Per variable emptied
+    std::vector<long long> constraint_wipeouts; // Per constraint (index in CSPInstance::constraints) emptying it
+};
+
+// Peak resident set size of the process in KB (getrusage)
+long peakRssKb();
+
+#endif // STATS_H
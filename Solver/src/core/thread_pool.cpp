@@ -0,0 +1,68 @@
+#include "thread_pool.h"
+
+using namespace std;
+
+int ThreadPool::resolveThreadCount(int requested) {
+    if (requested > 0) {
+        return requested;
+    }
+    unsigned int hardware = thread::hardware_concurrency();
+    return hardware > 0 ? static_cast<int>(hardware) : 1;
+}
+
+ThreadPool::ThreadPool(int num_threads) : running_tasks(0), stopping(false) {
+    int count = resolveThreadCount(num_threads);
+    for (int i = 0; i < count; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    task_available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(function<void()> task) {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        tasks.push(std::move(task));
+    }
+    task_available.notify_one();
+}
+
+void ThreadPool::wait() {
+    unique_lock<std::mutex> lock(mutex);
+    all_done.wait(lock, [this] { return tasks.empty() && running_tasks == 0; });
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        function<void()> task;
+        {
+            unique_lock<std::mutex> lock(mutex);
+            task_available.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+            running_tasks++;
+        }
+
+        task();
+
+        {
+            lock_guard<std::mutex> lock(mutex);
+            running_tasks--;
+            if (tasks.empty() && running_tasks == 0) {
+                all_done.notify_all();
+            }
+        }
+    }
+}
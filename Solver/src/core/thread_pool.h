@@ -0,0 +1,44 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Fixed-size pool of worker threads consuming a shared task queue
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable task_available;
+    std::condition_variable all_done;
+    int running_tasks;
+    bool stopping;
+
+    void workerLoop();
+
+public:
+    // num_threads <= 0 uses the number of hardware threads
+    explicit ThreadPool(int num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a task
+    void submit(std::function<void()> task);
+
+    // Block until every submitted task has completed
+    void wait();
+
+    int size() const { return static_cast<int>(workers.size()); }
+
+    // Number of threads to use for a requested count (<= 0 means hardware threads)
+    static int resolveThreadCount(int requested);
+};
+
+#endif // THREAD_POOL_H
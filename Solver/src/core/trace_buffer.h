@@ -0,0 +1,106 @@
+#ifndef TRACE_BUFFER_H
+#define TRACE_BUFFER_H
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <thread>
+#include <algorithm>
+
+// Trace binaire de l'arbre de recherche (--trace) : chaque événement d'un
+// nœud est un enregistrement de 16 octets, écrit par le thread de recherche
+// dans un tampon circulaire à un producteur et un consommateur, sans verrou.
+// Le TraceWriter (src/io/trace_writer.h) le vide dans le fichier depuis un
+// thread d'arrière-plan ; quand le tampon est plein, la recherche attend
+// qu'il se libère plutôt que de perdre des événements.
+
+// Outcome of a node event
+enum class TraceKind : uint8_t {
+    ASSIGN,          // var = value accepted, its subtree is searched (pruned: values removed by FC)
+    CONFLICT,        // var = value inconsistent with the assignment
+    WIPEOUT,         // FC or the nogoods emptied a domain (var = value rejected; pruned: values removed before)
+    PROPAGATE,       // AC-3 at a node removed values (var, value: -1)
+    PROPAGATE_FAIL,  // AC-3 at a node emptied the domain of var (value: -1; pruned: 0 with CBJ)
+    SOLUTION,        // Complete assignment at this depth (var, value: -1)
+    BACKJUMP         // CBJ dead end left for depth value, more than one level up (var: -1)
+};
+const int TRACE_KIND_COUNT = 7;
+
+// Fixed-size record, stored in host byte order (little-endian on x86/ARM)
+struct TraceEvent {
+    uint8_t kind;     // TraceKind
+    uint8_t reserved;
+    uint16_t depth;   // Node depth (number of assigned variables), saturated at 65535
+    int32_t var;
+    int32_t value;
+    uint32_t pruned;  // Values removed by the propagation of this event
+};
+static_assert(sizeof(TraceEvent) == 16, "TraceEvent must stay 16 bytes");
+
+// Ring buffer written by one search thread and drained by the writer thread
+class TraceBuffer {
+private:
+    std::vector<TraceEvent> events;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head;   // Next slot written (producer)
+    size_t cached_tail;                     // Producer's last view of tail
+    long long stalls;                       // Pushes that waited for the writer
+    alignas(64) std::atomic<size_t> tail;   // Next slot read (consumer)
+    int stream_id;
+
+public:
+    // capacity is rounded up to a power of two
+    TraceBuffer(int id, size_t capacity) : head(0), cached_tail(0), stalls(0), tail(0), stream_id(id) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        events.resize(size);
+        mask = size - 1;
+    }
+    TraceBuffer(const TraceBuffer&) = delete;
+    TraceBuffer& operator=(const TraceBuffer&) = delete;
+
+    // Producer side (search thread)
+    void push(TraceKind kind, int depth, int var, int value, size_t pruned) {
+        size_t position = head.load(std::memory_order_relaxed);
+        if (position - cached_tail == events.size()) {
+            cached_tail = tail.load(std::memory_order_acquire);
+            if (position - cached_tail == events.size()) {
+                stalls++;
+                do {
+                    std::this_thread::yield();
+                    cached_tail = tail.load(std::memory_order_acquire);
+                } while (position - cached_tail == events.size());
+            }
+        }
+        TraceEvent& event = events[position & mask];
+        event.kind = static_cast<uint8_t>(kind);
+        event.reserved = 0;
+        event.depth = static_cast<uint16_t>(depth < 65535 ? depth : 65535);
+        event.var = var;
+        event.value = value;
+        event.pruned = static_cast<uint32_t>(pruned);
+        head.store(position + 1, std::memory_order_release);
+    }
+    long long getStalls() const { return stalls; }
+    int getStreamId() const { return stream_id; }
+
+    // Consumer side (writer thread): calls write(events, count) on the
+    // contiguous runs published so far, then frees them; returns the count
+    template <typename Write>
+    size_t drain(Write write) {
+        size_t end = head.load(std::memory_order_acquire);
+        size_t begin = tail.load(std::memory_order_relaxed);
+        size_t count = end - begin;
+        while (begin != end) {
+            size_t offset = begin & mask;
+            size_t run = std::min(end - begin, events.size() - offset);
+            write(&events[offset], run);
+            begin += run;
+        }
+        tail.store(end, std::memory_order_release);
+        return count;
+    }
+};
+
+#endif // TRACE_BUFFER_H
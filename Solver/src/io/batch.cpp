@@ -0,0 +1,222 @@
+#include "batch.h"
+#include "solution_writer.h"
+#include "json.h"
+#include "../api/cpsolver.h"
+#include "../core/thread_pool.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <mutex>
+#include <map>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+bool listBatchInstances(const string& source, vector<string>& instances, string& error) {
+    error_code ec;
+    if (fs::is_directory(source, ec)) {
+        for (const auto& entry : fs::directory_iterator(source, ec)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".csp") {
+                instances.push_back(entry.path().string());
+            }
+        }
+        if (ec) {
+            error = "cannot list directory '" + source + "': " + ec.message();
+            return false;
+        }
+        sort(instances.begin(), instances.end());
+        return true;
+    }
+
+    ifstream list(source);
+    if (!list.is_open()) {
+        error = "cannot open '" + source + "' (expected a directory or a list of .csp files)";
+        return false;
+    }
+    fs::path base = fs::path(source).parent_path();
+    string line;
+    while (getline(list, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == string::npos || line[first] == '#') continue;
+        size_t last = line.find_last_not_of(" \t\r");
+        fs::path instance = line.substr(first, last - first + 1);
+        if (instance.is_relative()) instance = base / instance;
+        instances.push_back(instance.string());
+    }
+    return true;
+}
+
+// Same labels as the single-instance mode
+static string statusLabel(CPStatus status, unsigned long long solutions, const SolverParams& params) {
+    switch (status) {
+        case CPStatus::ALL_SOLUTIONS:
+            return solutions == 0 ? "No solution (full exploration)" : "All solutions found";
+        case CPStatus::SOLUTION_LIMIT:
+            return params.first_solution_only ? "First solution found" : toString(status);
+        case CPStatus::INCONSISTENT:
+            return params.use_sac ? "Inconsistent (AC-3/SAC)" : "Inconsistent (AC-3)";
+        default:
+            return toString(status);
+    }
+}
+
+// One job: parse, preprocess, search and write the .sol file
+static BatchResult solveInstance(const string& path, const SolverParams& params, const string& output_dir) {
+    auto start = chrono::high_resolution_clock::now();
+    BatchResult result;
+    result.instance = path;
+    result.solution_file = (fs::path(output_dir) / (fs::path(path).stem().string() + ".sol")).string();
+
+    CSPInstance empty_instance;
+    empty_instance.num_variables = 0;
+    unique_ptr<CPModel> model;
+    vector<int> rows;                   // Stored solutions, num_variables values each
+    size_t stored = 0;
+    size_t search_memory = 0;
+    long long search_ms = 0;
+    try {
+        model.reset(new CPModel(CPModel::fromFile(path)));
+
+        // Jobs already fill the cores: SAC probes on the job's thread
+        SolverParams options = params;
+        options.num_threads = 1;
+
+        CPSession session(*model);
+        session.setOptions(options);
+        CPBudget budget;
+        budget.time_limit_ms = params.max_time * 1000LL;
+        budget.solution_limit = params.first_solution_only ? 1 : 0;
+        session.setBudget(budget);
+        if (!params.count_only) {
+            session.onSolution([&](const vector<int>& values) {
+                rows.insert(rows.end(), values.begin(), values.end());
+                stored++;
+                return true;
+            });
+        }
+
+        CPStatus status = session.solve();
+        result.solutions = session.getSolutionCount();
+        result.nodes_explored = session.getNodesExplored();
+        result.backtracks = session.getBacktracks();
+        result.status = statusLabel(status, result.solutions, params);
+        search_ms = session.getElapsedMs();
+        search_memory = session.getSearchMemory();
+    } catch (const bad_alloc&) {
+        result.status = "Out of memory";
+        rows.clear();
+        rows.shrink_to_fit();
+        stored = 0;
+    } catch (const exception& e) {
+        // Parser errors (runtime_error) leave the model unset
+        result.status = model ? string("Error: ") + e.what() : "Parsing Error";
+    }
+
+    // The job's own memory, not the process high-water mark shared by the
+    // jobs running at the same time
+    size_t model_memory = model ? model->getInstance().memoryUsage() : 0;
+    result.memory_kb = static_cast<long>((model_memory + search_memory + rows.capacity() * sizeof(int)) / 1024);
+
+    const CSPInstance& instance = model ? model->getInstance() : empty_instance;
+    size_t width = static_cast<size_t>(instance.num_variables);
+    size_t next_row = 0;
+    auto next_solution = [&](map<int, int>& solution) {
+        if (next_row >= stored) return false;
+        solution.clear();
+        for (size_t var = 0; var < width; var++) {
+            solution[static_cast<int>(var)] = rows[next_row * width + var];
+        }
+        next_row++;
+        return true;
+    };
+    writeSolutions(result.solution_file, next_solution, BigInt(stored), instance,
+                   params, search_ms, result.nodes_explored, result.status);
+
+    result.time_ms = chrono::duration_cast<chrono::milliseconds>(
+        chrono::high_resolution_clock::now() - start).count();
+    return result;
+}
+
+vector<BatchResult> runBatch(const vector<string>& instances, const SolverParams& params, const string& output_dir) {
+    vector<BatchResult> results(instances.size());
+    error_code mkdir_error;
+    fs::create_directories(output_dir, mkdir_error);
+
+    // Longest jobs first so that the last ones to finish are short; the
+    // file size stands in for the unknown solving time
+    vector<size_t> order(instances.size());
+    iota(order.begin(), order.end(), 0);
+    vector<uintmax_t> sizes(instances.size(), 0);
+    for (size_t i = 0; i < instances.size(); i++) {
+        error_code ec;
+        uintmax_t size = fs::file_size(instances[i], ec);
+        if (!ec) sizes[i] = size;
+    }
+    stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+    mutex output_mutex;
+    size_t finished = 0;
+    ThreadPool pool(params.num_threads);
+    for (size_t index : order) {
+        pool.submit([&, index]() {
+            BatchResult result = solveInstance(instances[index], params, output_dir);
+            lock_guard<mutex> lock(output_mutex);
+            finished++;
+            cout << "[" << setw(to_string(instances.size()).size()) << finished << "/" << instances.size() << "] "
+                 << fs::path(result.instance).filename().string() << ": " << result.status
+                 << ", " << result.solutions << " solution(s), " << result.nodes_explored << " nodes, "
+                 << result.time_ms << "ms" << endl;
+            results[index] = move(result);
+        });
+    }
+    pool.wait();
+    return results;
+}
+
+// Quotes a CSV field when it contains a separator, a quote or a newline
+static string csvField(const string& value) {
+    if (value.find_first_of(",\"\n") == string::npos) return value;
+    string quoted = "\"";
+    for (char c : value) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+bool writeBatchSummary(const string& filename, const vector<BatchResult>& results) {
+    ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    bool json = filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".json") == 0;
+    if (json) {
+        file << "[" << endl;
+        for (size_t i = 0; i < results.size(); i++) {
+            const BatchResult& r = results[i];
+            file << "  {\"instance\": " << jsonString(r.instance)
+                 << ", \"status\": " << jsonString(r.status)
+                 << ", \"solutions\": " << r.solutions
+                 << ", \"nodes\": " << r.nodes_explored
+                 << ", \"backtracks\": " << r.backtracks
+                 << ", \"time_ms\": " << r.time_ms
+                 << ", \"memory_kb\": " << r.memory_kb
+                 << ", \"solution_file\": " << jsonString(r.solution_file) << "}"
+                 << (i + 1 < results.size() ? "," : "") << endl;
+        }
+        file << "]" << endl;
+    } else {
+        file << "instance,status,solutions,nodes,backtracks,time_ms,memory_kb,solution_file" << endl;
+        for (const BatchResult& r : results) {
+            file << csvField(r.instance) << "," << csvField(r.status) << "," << r.solutions << ","
+                 << r.nodes_explored << "," << r.backtracks << "," << r.time_ms << ","
+                 << r.memory_kb << "," << csvField(r.solution_file) << endl;
+        }
+    }
+    return static_cast<bool>(file);
+}
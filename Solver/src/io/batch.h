@@ -0,0 +1,39 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <string>
+#include <vector>
+#include "../core/params.h"
+
+// Résolution d'un lot d'instances dans un seul processus (--batch) : les
+// instances sont résolues en parallèle sur un pool de threads, chacune avec
+// sa limite de temps, et un tableau récapitulatif est écrit en CSV ou JSON.
+
+// Résultat d'une instance du lot
+struct BatchResult {
+    std::string instance;             // Chemin du fichier .csp
+    std::string solution_file;        // Fichier .sol écrit
+    std::string status;               // Même libellé que le mode fichier unique
+    unsigned long long solutions = 0;
+    long long nodes_explored = 0;
+    long long backtracks = 0;
+    long long time_ms = 0;            // Parsing, preprocessing, search and writing
+    long memory_kb = 0;               // Model, search state and stored solutions (approximate)
+};
+
+// Instances of a directory (*.csp, sorted by name) or of a list file (one
+// path per line, '#' comments; relative paths are relative to the list).
+// Returns false with a message if the source cannot be read.
+bool listBatchInstances(const std::string& source, std::vector<std::string>& instances, std::string& error);
+
+// Solves every instance with the chronological search and writes
+// <output_dir>/<name>.sol. Jobs run on params.num_threads threads, largest
+// file first; results are returned in the order of instances.
+std::vector<BatchResult> runBatch(const std::vector<std::string>& instances,
+                                  const SolverParams& params,
+                                  const std::string& output_dir);
+
+// Summary table: JSON if the file name ends with ".json", CSV otherwise
+bool writeBatchSummary(const std::string& filename, const std::vector<BatchResult>& results);
+
+#endif // BATCH_H
@@ -0,0 +1,304 @@
+#include "json.h"
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include <cmath>
+#include <cstdlib>
+#include <cctype>
+
+using namespace std;
+
+// Recursive descent parser; the nesting depth is bounded because requests
+// come from other processes
+class JsonParser {
+private:
+    const string& text;
+    size_t pos;
+    static const int MAX_DEPTH = 64;
+
+    [[noreturn]] void fail(const string& message) const {
+        throw runtime_error("JSON: " + message + " at offset " + to_string(pos));
+    }
+
+    void skipSpaces() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' ||
+                                     text[pos] == '\n' || text[pos] == '\r')) {
+            pos++;
+        }
+    }
+
+    void expectWord(const char* word) {
+        for (const char* c = word; *c; c++, pos++) {
+            if (pos >= text.size() || text[pos] != *c) fail(string("expected '") + word + "'");
+        }
+    }
+
+    static void appendUtf8(string& out, unsigned int code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    unsigned int parseHex4() {
+        if (pos + 4 > text.size()) fail("truncated \\u escape");
+        unsigned int code = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = text[pos++];
+            code <<= 4;
+            if (c >= '0' && c <= '9') code |= c - '0';
+            else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+            else fail("invalid \\u escape");
+        }
+        return code;
+    }
+
+    string parseString() {
+        pos++; // Opening quote
+        string out;
+        while (true) {
+            if (pos >= text.size()) fail("unterminated string");
+            char c = text[pos++];
+            if (c == '"') break;
+            if (static_cast<unsigned char>(c) < 0x20) fail("control character in string");
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) fail("unterminated string");
+            char escape = text[pos++];
+            switch (escape) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned int code = parseHex4();
+                    if (code >= 0xD800 && code < 0xDC00 && pos + 1 < text.size() &&
+                        text[pos] == '\\' && text[pos + 1] == 'u') {
+                        pos += 2;
+                        unsigned int low = parseHex4();
+                        if (low < 0xDC00 || low >= 0xE000) fail("invalid surrogate pair");
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, code);
+                    break;
+                }
+                default:
+                    fail("invalid escape");
+            }
+        }
+        return out;
+    }
+
+    double parseNumber() {
+        size_t start = pos;
+        if (pos < text.size() && text[pos] == '-') pos++;
+        while (pos < text.size() && (isdigit(static_cast<unsigned char>(text[pos])) || text[pos] == '.' ||
+                                     text[pos] == 'e' || text[pos] == 'E' || text[pos] == '+' || text[pos] == '-')) {
+            pos++;
+        }
+        string literal = text.substr(start, pos - start);
+        char* end = nullptr;
+        double value = strtod(literal.c_str(), &end);
+        if (literal.empty() || end != literal.c_str() + literal.size()) {
+            pos = start;
+            fail("invalid number");
+        }
+        return value;
+    }
+
+    JsonValue parseValue(int depth) {
+        if (depth > MAX_DEPTH) fail("nesting too deep");
+        skipSpaces();
+        if (pos >= text.size()) fail("unexpected end");
+
+        JsonValue value;
+        char c = text[pos];
+        if (c == '{') {
+            value.type = JsonValue::Type::OBJECT;
+            pos++;
+            skipSpaces();
+            if (pos < text.size() && text[pos] == '}') {
+                pos++;
+                return value;
+            }
+            while (true) {
+                skipSpaces();
+                if (pos >= text.size() || text[pos] != '"') fail("expected a member name");
+                string key = parseString();
+                skipSpaces();
+                if (pos >= text.size() || text[pos] != ':') fail("expected ':'");
+                pos++;
+                value.object_items[key] = parseValue(depth + 1);
+                skipSpaces();
+                if (pos < text.size() && text[pos] == ',') { pos++; continue; }
+                if (pos < text.size() && text[pos] == '}') { pos++; break; }
+                fail("expected ',' or '}'");
+            }
+        } else if (c == '[') {
+            value.type = JsonValue::Type::ARRAY;
+            pos++;
+            skipSpaces();
+            if (pos < text.size() && text[pos] == ']') {
+                pos++;
+                return value;
+            }
+            while (true) {
+                value.array_items.push_back(parseValue(depth + 1));
+                skipSpaces();
+                if (pos < text.size() && text[pos] == ',') { pos++; continue; }
+                if (pos < text.size() && text[pos] == ']') { pos++; break; }
+                fail("expected ',' or ']'");
+            }
+        } else if (c == '"') {
+            value.type = JsonValue::Type::STRING;
+            value.string_value = parseString();
+        } else if (c == 't') {
+            expectWord("true");
+            value.type = JsonValue::Type::BOOLEAN;
+            value.boolean_value = true;
+        } else if (c == 'f') {
+            expectWord("false");
+            value.type = JsonValue::Type::BOOLEAN;
+        } else if (c == 'n') {
+            expectWord("null");
+        } else if (c == '-' || isdigit(static_cast<unsigned char>(c))) {
+            value.type = JsonValue::Type::NUMBER;
+            value.number_value = parseNumber();
+        } else {
+            fail(string("unexpected character '") + c + "'");
+        }
+        return value;
+    }
+
+public:
+    explicit JsonParser(const string& input) : text(input), pos(0) {}
+
+    JsonValue parseDocument() {
+        JsonValue value = parseValue(0);
+        skipSpaces();
+        if (pos != text.size()) fail("trailing characters");
+        return value;
+    }
+};
+
+JsonValue JsonValue::parse(const string& text) {
+    JsonParser parser(text);
+    return parser.parseDocument();
+}
+
+bool JsonValue::asBool() const {
+    if (type != Type::BOOLEAN) throw runtime_error("JSON: expected a boolean");
+    return boolean_value;
+}
+
+double JsonValue::asNumber() const {
+    if (type != Type::NUMBER) throw runtime_error("JSON: expected a number");
+    return number_value;
+}
+
+long long JsonValue::asInteger() const {
+    double number = asNumber();
+    if (number != floor(number) || fabs(number) > 9.0e15) throw runtime_error("JSON: expected an integer");
+    return static_cast<long long>(number);
+}
+
+const string& JsonValue::asString() const {
+    if (type != Type::STRING) throw runtime_error("JSON: expected a string");
+    return string_value;
+}
+
+const vector<JsonValue>& JsonValue::asArray() const {
+    if (type != Type::ARRAY) throw runtime_error("JSON: expected an array");
+    return array_items;
+}
+
+bool JsonValue::has(const string& key) const {
+    return type == Type::OBJECT && object_items.count(key) > 0;
+}
+
+const JsonValue& JsonValue::operator[](const string& key) const {
+    static const JsonValue null_value;
+    if (type != Type::OBJECT) return null_value;
+    auto it = object_items.find(key);
+    return it == object_items.end() ? null_value : it->second;
+}
+
+const map<string, JsonValue>& JsonValue::members() const {
+    if (type != Type::OBJECT) throw runtime_error("JSON: expected an object");
+    return object_items;
+}
+
+string JsonValue::dump() const {
+    switch (type) {
+        case Type::NUL: return "null";
+        case Type::BOOLEAN: return boolean_value ? "true" : "false";
+        case Type::NUMBER: {
+            ostringstream out;
+            if (number_value == floor(number_value) && fabs(number_value) < 9.0e15) {
+                out << static_cast<long long>(number_value);
+            } else {
+                out << setprecision(17) << number_value;
+            }
+            return out.str();
+        }
+        case Type::STRING: return jsonString(string_value);
+        case Type::ARRAY: {
+            string out = "[";
+            for (size_t i = 0; i < array_items.size(); i++) {
+                if (i > 0) out += ",";
+                out += array_items[i].dump();
+            }
+            return out + "]";
+        }
+        case Type::OBJECT: {
+            string out = "{";
+            bool first = true;
+            for (const auto& member : object_items) {
+                if (!first) out += ",";
+                out += jsonString(member.first) + ":" + member.second.dump();
+                first = false;
+            }
+            return out + "}";
+        }
+    }
+    return "null";
+}
+
+string jsonString(const string& value) {
+    ostringstream out;
+    out << '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out << "\\u" << hex << setw(4) << setfill('0') << static_cast<int>(c) << dec;
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+    return out.str();
+}
@@ -0,0 +1,56 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+// Valeur JSON minimale pour les requêtes du mode serveur : objets, tableaux,
+// chaînes, nombres, booléens et null. Les nombres sont gardés en double.
+class JsonValue {
+public:
+    enum class Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+private:
+    Type type;
+    bool boolean_value;
+    double number_value;
+    std::string string_value;
+    std::vector<JsonValue> array_items;
+    std::map<std::string, JsonValue> object_items;
+
+public:
+    JsonValue() : type(Type::NUL), boolean_value(false), number_value(0) {}
+
+    // Throws std::runtime_error with the offset of the error
+    static JsonValue parse(const std::string& text);
+
+    Type getType() const { return type; }
+    bool isNull() const { return type == Type::NUL; }
+    bool isNumber() const { return type == Type::NUMBER; }
+    bool isString() const { return type == Type::STRING; }
+    bool isArray() const { return type == Type::ARRAY; }
+    bool isObject() const { return type == Type::OBJECT; }
+
+    // Typed accessors: throw std::runtime_error on a type mismatch
+    bool asBool() const;
+    double asNumber() const;
+    long long asInteger() const;           // Also rejects non-integral numbers
+    const std::string& asString() const;
+    const std::vector<JsonValue>& asArray() const;
+
+    // Object members (a missing member is null)
+    bool has(const std::string& key) const;
+    const JsonValue& operator[](const std::string& key) const;
+    const std::map<std::string, JsonValue>& members() const;
+
+    // Compact serialization (numbers without a fraction are written as integers)
+    std::string dump() const;
+
+    friend class JsonParser;
+};
+
+// Chaîne JSON entre guillemets, caractères spéciaux échappés
+std::string jsonString(const std::string& value);
+
+#endif // JSON_H
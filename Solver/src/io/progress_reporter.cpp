@@ -0,0 +1,87 @@
+#include "progress_reporter.h"
+#include <iomanip>
+#include <sstream>
+#include <cmath>
+
+using namespace std;
+
+ProgressReporter::ProgressReporter(const SearchProgress& search_progress, double interval_seconds,
+                                   bool json_lines, ostream& output)
+    : progress(search_progress),
+      interval(max(1LL, static_cast<long long>(interval_seconds * 1000))),
+      json(json_lines), out(output), stopping(false), last_nodes(0) {}
+
+ProgressReporter::~ProgressReporter() {
+    stop();
+}
+
+void ProgressReporter::start() {
+    start_time = chrono::steady_clock::now();
+    last_time = start_time;
+    last_nodes = progress.nodes.load(memory_order_relaxed);
+    stopping = false;
+    worker = thread(&ProgressReporter::run, this);
+}
+
+void ProgressReporter::stop() {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void ProgressReporter::run() {
+    unique_lock<std::mutex> lock(mutex);
+    while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+        report();
+    }
+}
+
+void ProgressReporter::report() {
+    auto now = chrono::steady_clock::now();
+    long long nodes = progress.nodes.load(memory_order_relaxed);
+    unsigned long long solutions = progress.solutions.load(memory_order_relaxed);
+    int depth = progress.depth.load(memory_order_relaxed);
+    double fraction = progress.explored_fraction.load(memory_order_relaxed);
+
+    double elapsed_s = chrono::duration<double>(now - start_time).count();
+    double window_s = chrono::duration<double>(now - last_time).count();
+    double rate = window_s > 0 ? (nodes - last_nodes) / window_s : 0.0;
+    last_nodes = nodes;
+    last_time = now;
+
+    // Tree size estimate: nodes explored so far over the part they cover
+    bool estimated = fraction > 0 && nodes > 0;
+    double remaining = estimated ? max(0.0, nodes / fraction - nodes) : 0.0;
+    double eta_s = estimated && rate > 0 ? remaining / rate : -1.0;
+
+    ostringstream line;
+    line << fixed;
+    if (json) {
+        line << "{\"elapsed_s\": " << setprecision(1) << elapsed_s
+             << ", \"nodes\": " << nodes
+             << ", \"nodes_per_s\": " << setprecision(0) << rate
+             << ", \"depth\": " << depth
+             << ", \"solutions\": " << solutions;
+        if (estimated) {
+            line << ", \"explored_fraction\": " << setprecision(6) << fraction
+                 << ", \"estimated_remaining_nodes\": " << setprecision(0) << remaining;
+            if (eta_s >= 0) line << ", \"eta_s\": " << setprecision(1) << eta_s;
+        }
+        line << "}";
+    } else {
+        line << "[progress " << setprecision(1) << elapsed_s << "s] nodes " << nodes
+             << " (" << setprecision(0) << rate << "/s), depth " << depth
+             << ", solutions " << solutions;
+        if (estimated) {
+            line << ", explored " << setprecision(2) << fraction * 100 << "%"
+                 << ", ~" << setprecision(0) << remaining << " nodes left";
+            if (eta_s >= 0) line << " (~" << eta_s << "s)";
+        }
+    }
+    out << line.str() << endl;
+}
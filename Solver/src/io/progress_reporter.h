@@ -0,0 +1,46 @@
+#ifndef PROGRESS_REPORTER_H
+#define PROGRESS_REPORTER_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <ostream>
+#include "../core/progress.h"
+
+// Thread qui affiche l'avancement d'une recherche à intervalle fixe
+// (--progress) : nœuds/s depuis le rapport précédent, profondeur courante,
+// solutions, part explorée de l'arbre et estimation des nœuds restants
+// (nœuds explorés / part explorée). Il ne fait que lire le SearchProgress ;
+// la recherche ne l'attend jamais.
+class ProgressReporter {
+private:
+    const SearchProgress& progress;
+    std::chrono::milliseconds interval;
+    bool json;                      // JSON lines instead of text lines
+    std::ostream& out;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+    std::chrono::steady_clock::time_point start_time;
+    long long last_nodes;
+    std::chrono::steady_clock::time_point last_time;
+
+    void run();
+    void report();
+
+public:
+    ProgressReporter(const SearchProgress& search_progress, double interval_seconds, bool json_lines, std::ostream& output);
+    ~ProgressReporter();
+
+    ProgressReporter(const ProgressReporter&) = delete;
+    ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+    // Starts the reporting thread (first line after one interval)
+    void start();
+    // Stops it; no line is printed after stop() returns
+    void stop();
+};
+
+#endif // PROGRESS_REPORTER_H
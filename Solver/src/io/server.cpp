@@ -0,0 +1,543 @@
+#include "server.h"
+#include "json.h"
+#include "../api/cpsolver.h"
+#include "../strategies/strategies.h"
+#include <fstream>
+#include <sstream>
+#include <list>
+#include <set>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <chrono>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace {
+
+const size_t MAX_REQUEST_BYTES = 16 << 20;   // Longest accepted request line
+const size_t RESPONSE_FLUSH_BYTES = 64 << 10; // Solutions are sent in chunks
+
+// Listening socket, shut down by SIGINT/SIGTERM to stop accept()
+volatile sig_atomic_t signal_listen_fd = -1;
+
+void handleStopSignal(int) {
+    if (signal_listen_fd >= 0) {
+        shutdown(signal_listen_fd, SHUT_RDWR);
+    }
+}
+
+uint64_t fnv1a(const string& bytes) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : bytes) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool sockaddrFor(const string& path, sockaddr_un& address, string& error) {
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        error = "invalid socket path '" + path + "' (at most " + to_string(sizeof(address.sun_path) - 1) + " bytes)";
+        return false;
+    }
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    return true;
+}
+
+bool sendAll(int fd, const string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Reads '\n'-terminated lines from a socket
+class LineReader {
+private:
+    int fd;
+    string buffer;
+    size_t start;
+    bool eof;
+
+public:
+    explicit LineReader(int socket_fd) : fd(socket_fd), start(0), eof(false) {}
+
+    // False at the end of the stream; a last unterminated line is returned
+    bool next(string& line) {
+        while (true) {
+            size_t end = buffer.find('\n', start);
+            if (end != string::npos) {
+                line.assign(buffer, start, end - start);
+                start = end + 1;
+                return true;
+            }
+            if (start > 0) {
+                buffer.erase(0, start);
+                start = 0;
+            }
+            if (eof || buffer.size() > MAX_REQUEST_BYTES) {
+                if (buffer.empty()) return false;
+                line.swap(buffer);
+                buffer.clear();
+                eof = true;
+                return true;
+            }
+            char chunk[65536];
+            ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                eof = true;
+            } else {
+                buffer.append(chunk, static_cast<size_t>(n));
+            }
+        }
+    }
+};
+
+// Buffered response lines of one connection
+class ResponseWriter {
+private:
+    int fd;
+    string buffer;
+    bool failed;
+
+public:
+    explicit ResponseWriter(int socket_fd) : fd(socket_fd), failed(false) {}
+
+    // False once the client is gone
+    bool line(const string& text) {
+        if (failed) return false;
+        buffer += text;
+        buffer += '\n';
+        return buffer.size() < RESPONSE_FLUSH_BYTES || flush();
+    }
+
+    bool flush() {
+        if (!failed && !buffer.empty()) {
+            failed = !sendAll(fd, buffer);
+            buffer.clear();
+        }
+        return !failed;
+    }
+};
+
+// LRU cache of compiled models keyed by the FNV-1a hash of the file contents
+class ModelCache {
+private:
+    struct Entry {
+        uint64_t key;
+        shared_ptr<const CPModel> model;
+    };
+    list<Entry> entries; // Most recently used first
+    unordered_map<uint64_t, list<Entry>::iterator> index;
+    size_t capacity;
+    long long hits;
+    long long misses;
+    mutable mutex cache_mutex;
+
+public:
+    explicit ModelCache(size_t max_models) : capacity(max(static_cast<size_t>(1), max_models)), hits(0), misses(0) {}
+
+    shared_ptr<const CPModel> find(uint64_t key) {
+        lock_guard<mutex> lock(cache_mutex);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            misses++;
+            return nullptr;
+        }
+        hits++;
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->model;
+    }
+
+    void insert(uint64_t key, shared_ptr<const CPModel> model) {
+        lock_guard<mutex> lock(cache_mutex);
+        if (index.count(key)) return; // Loaded meanwhile by another connection
+        entries.push_front(Entry{key, move(model)});
+        index[key] = entries.begin();
+        if (entries.size() > capacity) {
+            // Requests still using the evicted model keep it alive
+            index.erase(entries.back().key);
+            entries.pop_back();
+        }
+    }
+
+    string statsJson() const {
+        lock_guard<mutex> lock(cache_mutex);
+        return "\"models\":" + to_string(entries.size()) + ",\"capacity\":" + to_string(capacity) +
+               ",\"hits\":" + to_string(hits) + ",\"misses\":" + to_string(misses);
+    }
+};
+
+class Server {
+private:
+    SolverParams defaults;
+    ModelCache cache;
+    int listen_fd;
+    atomic<bool> stopping;
+    atomic<long long> requests;
+
+    // Open connections and running searches, interrupted at shutdown
+    mutex state_mutex;
+    condition_variable connections_closed;
+    set<int> client_fds;
+    set<CPSession*> active_sessions;
+    int open_connections;
+
+    mutex log_mutex;
+
+    void handleConnection(int fd);
+    // Returns false when the connection must be closed
+    bool handleRequest(const string& line, ResponseWriter& writer);
+    void solveRequest(const JsonValue& request, const string& id, ResponseWriter& writer);
+    shared_ptr<const CPModel> loadModel(const string& path, bool& cached);
+    void requestStop();
+
+public:
+    Server(const SolverParams& params, int cache_models)
+        : defaults(params), cache(static_cast<size_t>(max(1, cache_models))), listen_fd(-1),
+          stopping(false), requests(0), open_connections(0) {}
+
+    int run(const string& socket_path);
+};
+
+void Server::requestStop() {
+    stopping = true;
+    if (listen_fd >= 0) {
+        shutdown(listen_fd, SHUT_RDWR);
+    }
+}
+
+shared_ptr<const CPModel> Server::loadModel(const string& path, bool& cached) {
+    ifstream file(path, ios::binary);
+    if (!file.is_open()) {
+        throw runtime_error("Cannot open file: " + path);
+    }
+    ostringstream contents;
+    contents << file.rdbuf();
+    string text = contents.str();
+    uint64_t key = fnv1a(text);
+
+    shared_ptr<const CPModel> model = cache.find(key);
+    cached = model != nullptr;
+    if (!model) {
+        shared_ptr<CPModel> loaded = make_shared<CPModel>(CPModel::fromText(text));
+        loaded->compile();
+        model = loaded;
+        cache.insert(key, model);
+    }
+    return model;
+}
+
+void Server::solveRequest(const JsonValue& request, const string& id, ResponseWriter& writer) {
+    static const set<string> known_fields = {
+        "id", "command", "instance", "time_limit_ms", "node_limit", "solution_limit",
+        "var_strategy", "val_strategy", "ac3", "mac", "forward_checking", "sac", "sac_time_ms",
+        "count_only", "seed", "restrict"
+    };
+    for (const auto& member : request.members()) {
+        if (!known_fields.count(member.first)) {
+            throw runtime_error("unknown field '" + member.first + "'");
+        }
+    }
+    if (!request["instance"].isString()) {
+        throw runtime_error("missing \"instance\" (path of a .csp file)");
+    }
+
+    // Command-line options are the defaults of every request
+    SolverParams params = defaults;
+    CPBudget budget;
+    budget.time_limit_ms = defaults.max_time * 1000LL;
+    budget.solution_limit = defaults.first_solution_only ? 1 : 0;
+    if (request.has("time_limit_ms")) budget.time_limit_ms = request["time_limit_ms"].asInteger();
+    if (request.has("node_limit")) budget.node_limit = request["node_limit"].asInteger();
+    if (request.has("solution_limit")) budget.solution_limit = request["solution_limit"].asInteger();
+    if (request.has("var_strategy")) params.var_strategy = request["var_strategy"].asString();
+    if (request.has("val_strategy")) params.val_strategy = request["val_strategy"].asString();
+    if (request.has("ac3")) params.use_ac3 = request["ac3"].asBool();
+    if (request.has("mac")) params.ac3_at_each_node = request["mac"].asBool();
+    if (request.has("forward_checking")) params.use_forward_checking = request["forward_checking"].asBool();
+    if (request.has("sac")) params.use_sac = request["sac"].asBool();
+    if (request.has("sac_time_ms")) params.sac_max_time_ms = static_cast<int>(request["sac_time_ms"].asInteger());
+    if (request.has("count_only")) params.count_only = request["count_only"].asBool();
+    if (request.has("seed")) params.seed = static_cast<unsigned int>(request["seed"].asInteger());
+    if (!params.use_ac3) params.ac3_at_each_node = false;
+    if (request.has("var_strategy") && !isVariableStrategy(params.var_strategy)) {
+        throw runtime_error("unknown var_strategy '" + params.var_strategy + "' (mrv, degree or random)");
+    }
+    if (request.has("val_strategy") && !isValueStrategy(params.val_strategy)) {
+        throw runtime_error("unknown val_strategy '" + params.val_strategy + "' (lcv, random or lexicographic)");
+    }
+
+    auto load_start = chrono::high_resolution_clock::now();
+    bool cached = false;
+    shared_ptr<const CPModel> model = loadModel(request["instance"].asString(), cached);
+    long long load_ms = chrono::duration_cast<chrono::milliseconds>(
+        chrono::high_resolution_clock::now() - load_start).count();
+
+    CPSession session(*model);
+    session.setOptions(params);
+    session.setBudget(budget);
+    if (request.has("restrict")) {
+        for (const JsonValue& restriction : request["restrict"].asArray()) {
+            int var = static_cast<int>(restriction["var"].asInteger());
+            if (var < 0 || var >= model->getNumVariables()) {
+                throw runtime_error("restrict: unknown variable " + to_string(var));
+            }
+            vector<int> values;
+            if (restriction.has("values")) {
+                for (const JsonValue& value : restriction["values"].asArray()) {
+                    values.push_back(static_cast<int>(value.asInteger()));
+                }
+            } else {
+                long long low = restriction["min"].asInteger();
+                long long high = restriction["max"].asInteger();
+                // Only the part inside the initial domain matters
+                const pair<int, int>& domain = model->getInstance().domains[var];
+                for (long long value = max<long long>(low, domain.first);
+                     value <= min<long long>(high, domain.second); value++) {
+                    values.push_back(static_cast<int>(value));
+                }
+            }
+            session.restrictDomain(var, values);
+        }
+    }
+
+    unsigned long long index = 0;
+    if (!params.count_only) {
+        session.onSolution([&](const vector<int>& values) {
+            string line = "{\"id\":" + id + ",\"type\":\"solution\",\"index\":" + to_string(++index) + ",\"values\":[";
+            for (size_t var = 0; var < values.size(); var++) {
+                if (var > 0) line += ",";
+                line += to_string(values[var]);
+            }
+            // Stop when the client is gone
+            return writer.line(line + "]}");
+        });
+    }
+
+    {
+        lock_guard<mutex> lock(state_mutex);
+        active_sessions.insert(&session);
+        if (stopping) session.cancel();
+    }
+    CPStatus status = session.solve();
+    {
+        lock_guard<mutex> lock(state_mutex);
+        active_sessions.erase(&session);
+    }
+
+    writer.line("{\"id\":" + id + ",\"type\":\"result\",\"status\":" + jsonString(toString(status)) +
+                ",\"solutions\":" + to_string(session.getSolutionCount()) +
+                ",\"nodes\":" + to_string(session.getNodesExplored()) +
+                ",\"backtracks\":" + to_string(session.getBacktracks()) +
+                ",\"time_ms\":" + to_string(session.getElapsedMs()) +
+                ",\"load_ms\":" + to_string(load_ms) +
+                ",\"model\":\"" + (cached ? "cached" : "loaded") + "\"}");
+
+    lock_guard<mutex> lock(log_mutex);
+    cout << "[" << id << "] " << request["instance"].asString() << ": " << toString(status) << ", "
+         << session.getSolutionCount() << " solution(s), " << session.getElapsedMs() << "ms ("
+         << (cached ? "cached model" : "loaded in " + to_string(load_ms) + "ms") << ")" << endl;
+}
+
+bool Server::handleRequest(const string& line, ResponseWriter& writer) {
+    string id = "null";
+    try {
+        JsonValue request = JsonValue::parse(line);
+        if (!request.isObject()) {
+            throw runtime_error("a request is a JSON object");
+        }
+        id = request["id"].dump();
+        requests++;
+
+        string command = request.has("command") ? request["command"].asString() : "solve";
+        if (command == "solve") {
+            solveRequest(request, id, writer);
+        } else if (command == "stats") {
+            writer.line("{\"id\":" + id + ",\"type\":\"stats\"," + cache.statsJson() +
+                        ",\"requests\":" + to_string(requests.load()) + "}");
+        } else if (command == "shutdown") {
+            writer.line("{\"id\":" + id + ",\"type\":\"shutdown\"}");
+            writer.flush();
+            requestStop();
+            return false;
+        } else {
+            throw runtime_error("unknown command '" + command + "'");
+        }
+    } catch (const exception& e) {
+        writer.line("{\"id\":" + id + ",\"type\":\"error\",\"message\":" + jsonString(e.what()) + "}");
+    }
+    return writer.flush();
+}
+
+void Server::handleConnection(int fd) {
+    LineReader reader(fd);
+    ResponseWriter writer(fd);
+    string line;
+    while (!stopping && reader.next(line)) {
+        if (line.find_first_not_of(" \t\r") == string::npos) continue;
+        if (!handleRequest(line, writer)) break;
+    }
+    writer.flush();
+
+    lock_guard<mutex> lock(state_mutex);
+    client_fds.erase(fd);
+    close(fd);
+    open_connections--;
+    connections_closed.notify_all();
+}
+
+int Server::run(const string& socket_path) {
+    sockaddr_un address;
+    string error;
+    if (!sockaddrFor(socket_path, address, error)) {
+        cerr << "ERROR: " << error << endl;
+        return 1;
+    }
+
+    // A socket file left by a server that died can be replaced; a live one cannot
+    struct stat info;
+    if (lstat(socket_path.c_str(), &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            cerr << "ERROR: " << socket_path << " exists and is not a socket" << endl;
+            return 1;
+        }
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        bool alive = probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        if (probe >= 0) close(probe);
+        if (alive) {
+            cerr << "ERROR: A server is already listening on " << socket_path << endl;
+            return 1;
+        }
+        unlink(socket_path.c_str());
+    }
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0 || bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listen_fd, 64) != 0) {
+        cerr << "ERROR: Cannot listen on " << socket_path << ": " << strerror(errno) << endl;
+        if (listen_fd >= 0) close(listen_fd);
+        return 1;
+    }
+
+    signal_listen_fd = listen_fd;
+    signal(SIGINT, handleStopSignal);
+    signal(SIGTERM, handleStopSignal);
+
+    cout << "Listening on " << socket_path << " (model cache: " << cache.statsJson() << ")" << endl;
+    while (!stopping) {
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR && !stopping) continue;
+            break; // Listening socket shut down (request or signal)
+        }
+        lock_guard<mutex> lock(state_mutex);
+        client_fds.insert(fd);
+        open_connections++;
+        thread(&Server::handleConnection, this, fd).detach();
+    }
+    stopping = true;
+
+    // Wake the connections up: running searches stop, idle readers see EOF
+    {
+        unique_lock<mutex> lock(state_mutex);
+        for (CPSession* session : active_sessions) {
+            session->cancel();
+        }
+        for (int fd : client_fds) {
+            shutdown(fd, SHUT_RD);
+        }
+        connections_closed.wait(lock, [this]() { return open_connections == 0; });
+    }
+
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    signal_listen_fd = -1;
+    close(listen_fd);
+    unlink(socket_path.c_str());
+    cout << "Server stopped after " << requests.load() << " request(s)" << endl;
+    return 0;
+}
+
+} // namespace
+
+int runServer(const string& socket_path, const SolverParams& defaults, int cache_models) {
+    Server server(defaults, cache_models);
+    return server.run(socket_path);
+}
+
+int runClient(const string& socket_path, int input_fd, ostream& output) {
+    sockaddr_un address;
+    string error;
+    if (!sockaddrFor(socket_path, address, error)) {
+        cerr << "ERROR: " << error << endl;
+        return 1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        cerr << "ERROR: Cannot connect to " << socket_path << ": " << strerror(errno) << endl;
+        if (fd >= 0) close(fd);
+        return 1;
+    }
+
+    // Requests are sent while the responses are read, so neither side blocks
+    // on a full socket buffer; the half-close tells the server we are done.
+    // The sender waits on the socket as well as on the input, so that it
+    // stops as soon as the connection is shut down (server gone first)
+    thread sender([input_fd, fd]() {
+        pollfd watched[2] = {{input_fd, POLLIN, 0}, {fd, 0, 0}};
+        char chunk[65536];
+        bool line_open = false;
+        while (true) {
+            if (poll(watched, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            if (watched[1].revents & (POLLHUP | POLLERR)) return;
+            if (!watched[0].revents) continue;
+            ssize_t n = read(input_fd, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            if (!sendAll(fd, string(chunk, static_cast<size_t>(n)))) return;
+            line_open = chunk[n - 1] != '\n';
+        }
+        // A last request without its newline is still a line
+        if (line_open) sendAll(fd, "\n");
+        shutdown(fd, SHUT_WR);
+    });
+
+    bool errors = false;
+    LineReader reader(fd);
+    string line;
+    while (reader.next(line)) {
+        output << line << '\n';
+        errors = errors || line.find("\"type\":\"error\"") != string::npos;
+    }
+    output.flush();
+    // If the server closed first (shutdown), this wakes the sender up from
+    // its wait on the input; the descriptor is closed once it has stopped
+    shutdown(fd, SHUT_RDWR);
+    sender.join();
+    close(fd);
+    return errors ? 1 : 0;
+}
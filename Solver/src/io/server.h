@@ -0,0 +1,34 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <string>
+#include <iostream>
+#include "../core/params.h"
+
+// Mode serveur (--serve) : un processus résident répond sur un socket Unix
+// à des requêtes en lignes JSON. Les modèles lus et compilés restent dans un
+// cache LRU indexé par l'empreinte du contenu du fichier, si bien que seule
+// la première requête sur une instance paie le parsing et la compilation.
+//
+// Requête (une ligne) :
+//   {"id": 1, "instance": "path.csp", "time_limit_ms": 1000, "node_limit": 0,
+//    "solution_limit": 10, "var_strategy": "mrv", "val_strategy": "lcv",
+//    "ac3": true, "mac": true, "forward_checking": true, "sac": false,
+//    "count_only": false, "seed": 0, "restrict": [{"var": 0, "values": [1, 2]},
+//                                                 {"var": 3, "min": 2, "max": 5}]}
+//   {"command": "stats"}      {"command": "shutdown"}
+// Réponses (une ligne chacune, "id" recopié) :
+//   {"id": 1, "type": "solution", "index": 1, "values": [...]}   (sauf count_only)
+//   {"id": 1, "type": "result", "status": ..., "solutions": ..., "nodes": ..., ...}
+//   {"id": 1, "type": "error", "message": ...}
+// Les champs absents prennent les valeurs des options de la ligne de commande.
+
+// Serves until a shutdown request or SIGINT/SIGTERM; returns the exit code
+int runServer(const std::string& socket_path, const SolverParams& defaults, int cache_models);
+
+// Sends the request lines read from input_fd and copies the response lines
+// to output until the server has answered all of them or has closed the
+// connection; returns the exit code
+int runClient(const std::string& socket_path, int input_fd, std::ostream& output);
+
+#endif // SERVER_H
@@ -5,6 +5,8 @@
 #include <ctime>
 #include <sstream>
 #include <chrono>
+#include <cstdio>
+#include <cctype>
 #include "logo.h"
 
 using namespace std;
@@ -26,7 +28,8 @@ string formatTime(long milliseconds) {
 // Get current timestamp
 string getCurrentTimestamp() {
     time_t now = time(0);
-    tm* ltm = localtime(&now);
+    tm local_time;
+    tm* ltm = localtime_r(&now, &local_time); // Batch jobs write from several threads
     
     stringstream ss;
     ss << setfill('0') << setw(4) << (1900 + ltm->tm_year) << "-"
@@ -39,17 +42,69 @@ string getCurrentTimestamp() {
     return ss.str();
 }
 
+// Reads the "# Solution <n>" blocks of an existing solution file, up to
+// limit; each one is copied to out when it is given
+static unsigned long long copyListedSolutions(const string& filename, unsigned long long limit,
+                                              ostream* out) {
+    static const string LABEL = "# Solution ";
+    ifstream in(filename);
+    string line, values;
+    unsigned long long count = 0;
+    while (count < limit && getline(in, line)) {
+        if (line.compare(0, LABEL.size(), LABEL) != 0 || line.size() == LABEL.size() ||
+            !isdigit(static_cast<unsigned char>(line[LABEL.size()]))) {
+            continue;
+        }
+        if (!getline(in, values)) break;
+        if (out) *out << line << "\n" << values << "\n";
+        count++;
+    }
+    return count;
+}
+
 // Main function to write solutions
 void writeSolutions(const string& filename, 
                    const vector<map<int, int>>& solutions,
                    const CSPInstance& csp,
                    const SolverParams& params,
                    long duration_ms,
-                   int nodes_explored,
+                   long long nodes_explored,
                    const string& resolution_status) {
-    ofstream file(filename);
+    size_t next_index = 0;
+    auto next_solution = [&](map<int, int>& solution) {
+        if (next_index >= solutions.size()) return false;
+        solution = solutions[next_index++];
+        return true;
+    };
+    writeSolutions(filename, next_solution, BigInt(solutions.size()), csp, params,
+                   duration_ms, nodes_explored, resolution_status);
+}
+
+void writeSolutions(const string& filename,
+                   const function<bool(map<int, int>&)>& next_solution,
+                   const BigInt& solution_count,
+                   const CSPInstance& csp,
+                   const SolverParams& params,
+                   long duration_ms,
+                   long long nodes_explored,
+                   const string& resolution_status,
+                   unsigned long long skipped_solutions,
+                   const BigInt* represented_solutions) {
+    // A resumed run keeps the solutions of the previous runs: they are copied
+    // from the file being replaced, which is renamed over once complete
+    unsigned long long kept_solutions = 0;
+    if (skipped_solutions > 0 && !params.count_only) {
+        if (copyListedSolutions(filename, skipped_solutions, nullptr) == skipped_solutions) {
+            kept_solutions = skipped_solutions;
+        } else if (ifstream(filename).good()) {
+            cerr << "WARNING: " << filename << " does not list the " << skipped_solutions
+                 << " solutions of the previous runs; only the new ones are written" << endl;
+        }
+    }
+    string path = kept_solutions > 0 ? filename + ".tmp" : filename;
+    ofstream file(path);
     if (!file.is_open()) {
-        cerr << "ERROR: Cannot open solution file: " << filename << endl;
+        cerr << "ERROR: Cannot open solution file: " << path << endl;
         return;
     }
     
@@ -65,14 +120,43 @@ void writeSolutions(const string& filename,
     file << "# Variables: " << csp.num_variables << endl;
     file << "# Constraints: " << csp.constraints.size() << endl;
     file << "# Domain size: " << (csp.domains.empty() ? 0 : (csp.domains[0].second - csp.domains[0].first + 1)) << endl;
-    file << "# Solutions found: " << solutions.size() << endl;
+    file << "# Solutions found: " << solution_count << endl;
+    if (represented_solutions) {
+        file << "# Solutions with symmetric images: " << *represented_solutions << endl;
+    }
     file << "# Resolution status: " << resolution_status << endl;
     file << "# Nodes explored: " << nodes_explored << endl;
     file << "# Solving time: " << formatTime(duration_ms) << endl;
     file << "# Variable strategy: " << params.var_strategy << endl;
     file << "# Value strategy: " << params.val_strategy << endl;
+    if (params.seed != 0) {
+        file << "# Random seed: " << params.seed << endl;
+    }
     file << "# AC-3: " << (params.use_ac3 ? "Enabled" : "Disabled") << endl;
+    file << "# SAC: " << (params.use_sac ? "Enabled" : "Disabled") << endl;
     file << "# Forward checking: " << (params.use_forward_checking ? "Enabled" : "Disabled") << endl;
+    file << "# Component caching counter: " << (params.use_counter ? "Enabled" : "Disabled") << endl;
+    file << "# Tree decomposition (BTD): " << (params.use_tree_decomposition ? "Enabled" : "Disabled") << endl;
+    file << "# Component decomposition: " << (params.decompose ? "Enabled" : "Disabled") << endl;
+    file << "# Backjumping (CBJ): " << (params.use_cbj ? "Enabled" : "Disabled") << endl;
+    file << "# Nogood learning: " << (params.use_nogoods ? "Enabled" : "Disabled") << endl;
+    file << "# Interchangeable values: " << (params.merge_interchangeable ? "Merged" : "Disabled") << endl;
+    if (params.break_symmetries) {
+        file << "# Symmetry breaking: Enabled ("
+             << (params.expand_orbits ? "orbits written" : "canonical solutions written") << ")" << endl;
+    } else {
+        file << "# Symmetry breaking: Disabled" << endl;
+    }
+    file << "# Checkpointing: " << (params.checkpoint_path.empty() ? "Disabled" : "Enabled") << endl;
+    if (!params.resume_path.empty()) {
+        file << "# Resumed from: " << params.resume_path;
+        if (kept_solutions > 0) {
+            file << " (the " << kept_solutions << " solutions of previous runs are kept)";
+        } else if (skipped_solutions > 0) {
+            file << " (solutions 1-" << skipped_solutions << " were found by previous runs)";
+        }
+        file << endl;
+    }
     
     // Add verbose information if enabled
     if (params.verbose) {
@@ -93,12 +177,15 @@ void writeSolutions(const string& filename,
     file << "#" << endl;
 
     // Write solutions
-    if (solutions.empty()) {
+    if (solution_count.isZero()) {
         file << "# No solution found" << endl;
+    } else if (params.count_only) {
+        file << "# Count only: solutions were not stored" << endl;
     } else {
-        for (size_t i = 0; i < solutions.size(); i++) {
+        copyListedSolutions(filename, kept_solutions, &file);
+        map<int, int> solution;
+        for (unsigned long long i = skipped_solutions; next_solution(solution); i++) {
             file << "# Solution " << (i + 1) << endl;
-            const auto& solution = solutions[i];
             bool first = true;
             for (const auto& assignment : solution) {
                 if (!first) file << " ";
@@ -112,4 +199,7 @@ void writeSolutions(const string& filename,
     // Ensure all data is written and file is properly closed
     file.flush();
     file.close();
+    if (kept_solutions > 0 && rename(path.c_str(), filename.c_str()) != 0) {
+        cerr << "ERROR: Cannot rename " << path << " to " << filename << endl;
+    }
 }
\ No newline at end of file
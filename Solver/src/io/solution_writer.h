@@ -4,8 +4,10 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <functional>
 #include "../parser/parser.h"
 #include "../core/params.h"
+#include "../core/bigint.h"
 
 // Function to write solutions to a file
 void writeSolutions(const std::string& filename, 
@@ -13,7 +15,24 @@ void writeSolutions(const std::string& filename,
                     const CSPInstance& csp,
                     const SolverParams& params,
                     long duration_ms,
-                    int nodes_explored,
+                    long long nodes_explored,
                     const std::string& resolution_status);
 
+// Streaming variant: solutions are pulled one at a time from next_solution
+// (nothing is pulled in count-only mode). After a resume, the first
+// skipped_solutions were listed by the previous runs and numbering
+// continues after them; when the existing file lists them, they are
+// copied ahead of the new ones. When only canonical solutions are listed,
+// represented_solutions is the count including their symmetric images.
+void writeSolutions(const std::string& filename,
+                    const std::function<bool(std::map<int, int>&)>& next_solution,
+                    const BigInt& solution_count,
+                    const CSPInstance& csp,
+                    const SolverParams& params,
+                    long duration_ms,
+                    long long nodes_explored,
+                    const std::string& resolution_status,
+                    unsigned long long skipped_solutions = 0,
+                    const BigInt* represented_solutions = nullptr);
+
 #endif // SOLUTION_WRITER_H
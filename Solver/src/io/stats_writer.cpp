@@ -0,0 +1,88 @@
+#include "stats_writer.h"
+#include "json.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <algorithm>
+
+using namespace std;
+
+bool writeStatsJson(const string& filename,
+                    const string& instance,
+                    const CSPInstance& csp,
+                    const SolverParams& params,
+                    const string& resolution_status,
+                    const BigInt& solution_count,
+                    const PhaseTimes& phases,
+                    const SearchCounters& counters,
+                    long peak_rss_kb) {
+    ofstream file(filename);
+    if (!file) {
+        cerr << "ERROR: Cannot write statistics to " << filename << endl;
+        return false;
+    }
+    auto flag = [](bool value) { return value ? "true" : "false"; };
+
+    file << "{" << endl;
+    file << "  \"instance\": " << jsonString(instance) << "," << endl;
+    file << "  \"variables\": " << csp.num_variables << "," << endl;
+    file << "  \"constraints\": " << csp.constraints.size() << "," << endl;
+    file << "  \"relations\": " << csp.countRelations() << "," << endl;
+    file << "  \"options\": {\"var_strategy\": " << jsonString(params.var_strategy)
+         << ", \"val_strategy\": " << jsonString(params.val_strategy)
+         << ", \"seed\": " << params.seed
+         << ", \"ac3\": " << flag(params.use_ac3)
+         << ", \"mac\": " << flag(params.ac3_at_each_node)
+         << ", \"forward_checking\": " << flag(params.use_forward_checking)
+         << ", \"sac\": " << flag(params.use_sac)
+         << ", \"cbj\": " << flag(params.use_cbj)
+         << ", \"nogoods\": " << flag(params.use_nogoods)
+         << ", \"decompose\": " << flag(params.decompose)
+         << ", \"tree_decomposition\": " << flag(params.use_tree_decomposition)
+         << ", \"counter\": " << flag(params.use_counter)
+         << ", \"time_limit_s\": " << params.max_time << "}," << endl;
+    file << "  \"status\": " << jsonString(resolution_status) << "," << endl;
+    file << "  \"solutions\": " << solution_count << "," << endl;
+
+    file << "  \"phases\": {";
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        file << (i > 0 ? ", " : "") << "\"" << phaseName(static_cast<Phase>(i)) << "\": {\"ms\": "
+             << fixed << setprecision(3) << phases.ns[i] / 1e6 << ", \"calls\": " << phases.calls[i] << "}";
+    }
+    file << "}," << endl;
+
+    file << "  \"counters\": {\"nodes\": " << counters.nodes
+         << ", \"backtracks\": " << counters.backtracks
+         << ", \"backjumps\": " << counters.backjumps
+         << ", \"constraint_checks\": " << counters.constraint_checks
+         << ", \"revisions\": " << counters.revisions
+         << ", \"wipeouts\": " << counters.wipeouts
+         << ", \"max_depth\": " << counters.max_depth << "}," << endl;
+    file << "  \"peak_rss_kb\": " << peak_rss_kb << "," << endl;
+
+    // Every variable, then the constraints that emptied a domain (most first)
+    file << "  \"wipeouts_by_variable\": [";
+    for (size_t var = 0; var < counters.variable_wipeouts.size(); var++) {
+        file << (var > 0 ? ", " : "") << counters.variable_wipeouts[var];
+    }
+    file << "]," << endl;
+
+    vector<size_t> order;
+    for (size_t i = 0; i < counters.constraint_wipeouts.size(); i++) {
+        if (counters.constraint_wipeouts[i] > 0) order.push_back(i);
+    }
+    stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return counters.constraint_wipeouts[a] > counters.constraint_wipeouts[b];
+    });
+    file << "  \"wipeouts_by_constraint\": [";
+    for (size_t k = 0; k < order.size(); k++) {
+        const Constraint& constraint = csp.constraints[order[k]];
+        file << (k > 0 ? "," : "") << endl
+             << "    {\"constraint\": " << order[k] << ", \"var1\": " << constraint.var1
+             << ", \"var2\": " << constraint.var2
+             << ", \"wipeouts\": " << counters.constraint_wipeouts[order[k]] << "}";
+    }
+    file << (order.empty() ? "" : "\n  ") << "]" << endl;
+    file << "}" << endl;
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,24 @@
+#ifndef STATS_WRITER_H
+#define STATS_WRITER_H
+
+#include <string>
+#include "../parser/parser.h"
+#include "../core/params.h"
+#include "../core/bigint.h"
+#include "../core/stats.h"
+
+// Document JSON de --stats-json : instance, options, statut, temps par
+// phase (ms et nombre de mesures), compteurs de la recherche, retraits
+// complets de domaines par variable et par contrainte, pic de mémoire.
+// Returns false (message on stderr) if the file cannot be written.
+bool writeStatsJson(const std::string& filename,
+                    const std::string& instance,
+                    const CSPInstance& csp,
+                    const SolverParams& params,
+                    const std::string& resolution_status,
+                    const BigInt& solution_count,
+                    const PhaseTimes& phases,
+                    const SearchCounters& counters,
+                    long peak_rss_kb);
+
+#endif // STATS_WRITER_H
@@ -0,0 +1,134 @@
+#include "trace_writer.h"
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+static const char TRACE_MAGIC[8] = {'C', 'P', 'T', 'R', 'A', 'C', 'E', '1'};
+
+const char* traceKindName(TraceKind kind) {
+    switch (kind) {
+        case TraceKind::ASSIGN: return "assign";
+        case TraceKind::CONFLICT: return "conflict";
+        case TraceKind::WIPEOUT: return "wipeout";
+        case TraceKind::PROPAGATE: return "propagate";
+        case TraceKind::PROPAGATE_FAIL: return "propagate_fail";
+        case TraceKind::SOLUTION: return "solution";
+        case TraceKind::BACKJUMP: return "backjump";
+    }
+    return "unknown";
+}
+
+TraceWriter::TraceWriter() : stopping(false), events_written(0) {}
+
+TraceWriter::~TraceWriter() {
+    stop();
+}
+
+bool TraceWriter::open(const string& filename, string& error) {
+    file.open(filename, ios::binary | ios::trunc);
+    if (!file) {
+        error = "cannot write " + filename;
+        return false;
+    }
+    return true;
+}
+
+TraceBuffer* TraceWriter::addBuffer(size_t capacity) {
+    lock_guard<std::mutex> lock(mutex);
+    buffers.emplace_back(new TraceBuffer(static_cast<int>(buffers.size()), capacity));
+    return buffers.back().get();
+}
+
+void TraceWriter::start(int num_variables) {
+    uint32_t header[2] = {TRACE_FORMAT_VERSION, static_cast<uint32_t>(num_variables)};
+    file.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    stopping = false;
+    worker = thread(&TraceWriter::run, this);
+}
+
+bool TraceWriter::stop() {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    if (!file.is_open()) {
+        return true;
+    }
+    // Events pushed after the last round of the writer thread
+    flush();
+    file.close();
+    return !file.fail();
+}
+
+long long TraceWriter::getStalls() const {
+    long long stalls = 0;
+    for (const auto& buffer : buffers) {
+        stalls += buffer->getStalls();
+    }
+    return stalls;
+}
+
+void TraceWriter::run() {
+    unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        flush();
+        wake.wait_for(lock, chrono::milliseconds(10), [this] { return stopping; });
+    }
+}
+
+// One block per contiguous run of each buffer
+void TraceWriter::flush() {
+    for (auto& buffer : buffers) {
+        uint32_t stream = static_cast<uint32_t>(buffer->getStreamId());
+        events_written += buffer->drain([&](const TraceEvent* events, size_t count) {
+            uint32_t block[2] = {stream, static_cast<uint32_t>(count)};
+            file.write(reinterpret_cast<const char*>(block), sizeof(block));
+            file.write(reinterpret_cast<const char*>(events), count * sizeof(TraceEvent));
+        });
+    }
+}
+
+bool TraceReader::open(const string& filename, string& error) {
+    file.open(filename, ios::binary);
+    if (!file) {
+        error = "cannot open " + filename;
+        return false;
+    }
+    char magic[sizeof(TRACE_MAGIC)];
+    uint32_t header[2];
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!file || memcmp(magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) {
+        error = filename + " is not a CPSolver trace";
+        return false;
+    }
+    if (header[0] != TRACE_FORMAT_VERSION) {
+        error = "unsupported trace version " + to_string(header[0]);
+        return false;
+    }
+    num_variables = header[1];
+    return true;
+}
+
+bool TraceReader::next(int& stream, TraceEvent& event) {
+    while (block_remaining == 0) {
+        uint32_t block[2];
+        if (!file.read(reinterpret_cast<char*>(block), sizeof(block))) {
+            return false;
+        }
+        block_stream = block[0];
+        block_remaining = block[1];
+    }
+    if (!file.read(reinterpret_cast<char*>(&event), sizeof(event))) {
+        return false;
+    }
+    block_remaining--;
+    stream = static_cast<int>(block_stream);
+    return true;
+}
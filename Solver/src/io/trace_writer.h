@@ -0,0 +1,80 @@
+#ifndef TRACE_WRITER_H
+#define TRACE_WRITER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "../core/trace_buffer.h"
+
+// Fichier de trace (--trace) : en-tête "CPTRACE1", version et nombre de
+// variables (uint32), puis des blocs { uint32 flux, uint32 nombre,
+// nombre × TraceEvent }. Chaque flux est le tampon d'un thread de
+// recherche ; dans un flux, les événements sont dans l'ordre de la
+// recherche en profondeur. Tout est dans l'ordre d'octets de la machine.
+
+const uint32_t TRACE_FORMAT_VERSION = 1;
+
+// JSON/CSV name of an event kind ("assign", "conflict", ...)
+const char* traceKindName(TraceKind kind);
+
+// Owns the buffers of the search threads and writes them to the file from
+// a background thread
+class TraceWriter {
+private:
+    std::ofstream file;
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker;
+    bool stopping;
+    long long events_written;
+
+    void run();
+    void flush();
+
+public:
+    TraceWriter();
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    // Creates the file (checked before parsing); false with a message on error
+    bool open(const std::string& filename, std::string& error);
+
+    // A buffer for one more search thread (before start())
+    TraceBuffer* addBuffer(size_t capacity = 1 << 20);
+
+    // Writes the header and starts the background flushing; stop() writes
+    // what is left and closes the file (false on a write error)
+    void start(int num_variables);
+    bool stop();
+
+    long long getEventsWritten() const { return events_written; }
+    long long getStalls() const;
+};
+
+// Sequential reading of a trace file (cptrace)
+class TraceReader {
+private:
+    std::ifstream file;
+    uint32_t num_variables;
+    uint32_t block_stream;
+    uint32_t block_remaining;
+
+public:
+    TraceReader() : num_variables(0), block_stream(0), block_remaining(0) {}
+
+    // Checks the header; false with a message if it is not a trace
+    bool open(const std::string& filename, std::string& error);
+    int getNumVariables() const { return static_cast<int>(num_variables); }
+
+    // Next event and its stream; false at the end of the file
+    bool next(int& stream, TraceEvent& event);
+};
+
+#endif // TRACE_WRITER_H
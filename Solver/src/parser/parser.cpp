@@ -5,6 +5,9 @@
 #include <stdexcept>
 #include <iostream>
 #include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <unordered_set>
 
 using namespace std;
 
@@ -89,7 +92,169 @@ vector<pair<int, int>> parseConstraintLine(const string& line) {
     return pairs;
 }
 
+// Check if a comment line declares a symmetry
+bool isSymmetryLine(const string& line) {
+    string trimmed = trim(line);
+    if (trimmed.empty() || trimmed[0] != '#') return false;
+    vector<string> tokens = split(trimmed.substr(1), ' ');
+    return !tokens.empty() && tokens[0] == "symmetry";
+}
+
+// Parse symmetry line: "# symmetry (var,value)->(var,value) ..."
+vector<LiteralImage> parseSymmetryLine(const string& line) {
+    vector<string> tokens = split(trim(line).substr(1), ' ');
+    vector<LiteralImage> images;
+    
+    // Skip the keyword and parse the literal images
+    for (size_t i = 1; i < tokens.size(); i++) {
+        const string& token = tokens[i];
+        size_t arrow = token.find("->");
+        if (arrow == string::npos) {
+            throw runtime_error("Invalid literal image format: " + token);
+        }
+        
+        // Both sides are "(var,value)"
+        int literal[4];
+        string sides[2] = {token.substr(0, arrow), token.substr(arrow + 2)};
+        for (int side = 0; side < 2; side++) {
+            string pair_str = sides[side];
+            if (pair_str.size() < 2 || pair_str[0] != '(' || pair_str[pair_str.length()-1] != ')') {
+                throw runtime_error("Invalid literal format: " + sides[side]);
+            }
+            pair_str = pair_str.substr(1, pair_str.length()-2);
+            size_t comma_pos = pair_str.find(',');
+            if (comma_pos == string::npos) {
+                throw runtime_error("Invalid literal format: " + sides[side]);
+            }
+            literal[2 * side] = stoi(trim(pair_str.substr(0, comma_pos)));
+            literal[2 * side + 1] = stoi(trim(pair_str.substr(comma_pos + 1)));
+        }
+        images.push_back(LiteralImage{literal[0], literal[1], literal[2], literal[3]});
+    }
+    
+    return images;
+}
+
+// Relation class methods
+Relation::Relation(vector<pair<int, int>> sorted_pairs)
+    : pairs(move(sorted_pairs)), first_min(0), second_min(0), first_span(0), second_span(0) {
+    if (pairs.empty()) {
+        return;
+    }
+    int second_max = pairs[0].second;
+    second_min = pairs[0].second;
+    for (const auto& p : pairs) {
+        second_min = min(second_min, p.second);
+        second_max = max(second_max, p.second);
+    }
+    first_min = pairs.front().first;
+    first_span = static_cast<long long>(pairs.back().first) - first_min + 1;
+    second_span = static_cast<long long>(second_max) - second_min + 1;
+    
+    // Dense bitset unless the bounding box is much larger than the pair list
+    long long area = first_span * second_span;
+    if (area <= 64 * static_cast<long long>(pairs.size()) + 4096) {
+        bits.assign((area + 63) / 64, 0);
+        for (const auto& p : pairs) {
+            long long index = (p.first - first_min) * second_span + (p.second - second_min);
+            bits[index >> 6] |= 1ULL << (index & 63);
+        }
+    }
+}
+
+bool Relation::contains(int first, int second) const {
+    long long row = static_cast<long long>(first) - first_min;
+    long long col = static_cast<long long>(second) - second_min;
+    if (row < 0 || row >= first_span || col < 0 || col >= second_span) {
+        return false;
+    }
+    if (!bits.empty()) {
+        long long index = row * second_span + col;
+        return (bits[index >> 6] >> (index & 63)) & 1ULL;
+    }
+    return binary_search(pairs.begin(), pairs.end(), make_pair(first, second));
+}
+
+// Order-independent hash of a pair list, in either orientation
+static uint64_t mixPair(int first, int second) {
+    uint64_t z = (static_cast<uint64_t>(static_cast<uint32_t>(first)) << 32 | static_cast<uint32_t>(second))
+                 + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+shared_ptr<const Relation> RelationPool::intern(vector<pair<int, int>> pairs, bool& transposed) {
+    sort(pairs.begin(), pairs.end());
+    pairs.erase(unique(pairs.begin(), pairs.end()), pairs.end());
+    uint64_t hash = pairs.size();
+    uint64_t transposed_hash = pairs.size();
+    for (const auto& p : pairs) {
+        hash += mixPair(p.first, p.second);
+        transposed_hash += mixPair(p.second, p.first);
+    }
+    
+    auto range = relations.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second->getPairs() == pairs) {
+            transposed = false;
+            return it->second;
+        }
+    }
+    range = relations.equal_range(transposed_hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        const Relation& candidate = *it->second;
+        if (candidate.size() == pairs.size() &&
+            all_of(pairs.begin(), pairs.end(), [&](const pair<int, int>& p) { return candidate.contains(p.second, p.first); })) {
+            transposed = true;
+            return it->second;
+        }
+    }
+    
+    auto relation = make_shared<const Relation>(move(pairs));
+    relations.emplace(hash, relation);
+    transposed = false;
+    return relation;
+}
+
+vector<pair<int, int>> Constraint::allowedPairs() const {
+    vector<pair<int, int>> result = relation->getPairs();
+    if (transposed) {
+        for (auto& p : result) swap(p.first, p.second);
+    }
+    return result;
+}
+
 // CSPInstance class methods
+void CSPInstance::addConstraint(int var1, int var2, vector<pair<int, int>> allowed_pairs) {
+    bool transposed;
+    shared_ptr<const Relation> relation = relation_pool.intern(move(allowed_pairs), transposed);
+    constraints.emplace_back(var1, var2, move(relation), transposed);
+}
+
+size_t CSPInstance::countRelations() const {
+    unordered_set<const Relation*> distinct;
+    for (const Constraint& c : constraints) {
+        distinct.insert(c.relation.get());
+    }
+    return distinct.size();
+}
+
+size_t CSPInstance::memoryUsage() const {
+    size_t bytes = sizeof(CSPInstance) + domains.capacity() * sizeof(domains[0]) +
+                   constraints.capacity() * sizeof(Constraint);
+    for (const auto& symmetry : symmetries) {
+        bytes += sizeof(symmetry) + symmetry.capacity() * sizeof(LiteralImage);
+    }
+    unordered_set<const Relation*> distinct;
+    for (const Constraint& c : constraints) {
+        if (distinct.insert(c.relation.get()).second) {
+            bytes += c.relation->memoryUsage();
+        }
+    }
+    return bytes;
+}
+
 bool CSPInstance::hasVariable(int var) const {
     return var >= 0 && var < num_variables;
 }
@@ -120,57 +285,123 @@ bool CSPInstance::isConsistent(int var1, int val1, int var2, int val2) const {
     for (const Constraint& c : constraints) {
         if (c.var1 == var1 && c.var2 == var2) {
             // Check if the pair (val1, val2) is in the allowed pairs
-            bool found = false;
-            for (const auto& pair : c.allowed_pairs) {
-                if (pair.first == val1 && pair.second == val2) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) return false;
+            if (!c.allows(val1, val2)) return false;
         } else if (c.var1 == var2 && c.var2 == var1) {
             // Check if the pair (val2, val1) is in the allowed pairs
-            bool found = false;
-            for (const auto& pair : c.allowed_pairs) {
-                if (pair.first == val2 && pair.second == val1) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) return false;
+            if (!c.allows(val2, val1)) return false;
         }
     }
     return true;
 }
 
-vector<int> CSPInstance::getDomain(int var) const {
-    vector<int> domain;
+Domain CSPInstance::getDomain(int var) const {
     if (var >= 0 && var < num_variables) {
-        int min_val = domains[var].first;
-        int max_val = domains[var].second;
-        for (int val = min_val; val <= max_val; val++) {
-            domain.push_back(val);
-        }
+        return Domain(domains[var].first, domains[var].second);
     }
-    return domain;
+    return Domain();
 }
 
 // Main parsing function for DIMACS format
 CSPInstance parseCSPFile(const string& filename) {
-    ifstream file(filename);
+    ifstream file(filename, ios::binary);
     if (!file.is_open()) {
         throw runtime_error("Cannot open file: " + filename);
     }
+    return parseCSP(file);
+}
+
+// Binary instances are recognized by their magic bytes
+static void readBinary(istream& file, void* data, size_t size) {
+    if (!file.read(static_cast<char*>(data), size)) {
+        throw runtime_error("Truncated binary instance");
+    }
+}
+
+CSPInstance parseCSPBinary(istream& file) {
+    CSPInstance csp;
+    int32_t header[1];
+    readBinary(file, header, sizeof(header));
+    csp.num_variables = header[0];
+    if (csp.num_variables <= 0) {
+        throw runtime_error("Invalid number of variables: " + to_string(csp.num_variables));
+    }
+    vector<int32_t> bounds(2 * static_cast<size_t>(csp.num_variables));
+    readBinary(file, bounds.data(), bounds.size() * sizeof(int32_t));
+    csp.domains.resize(csp.num_variables);
+    for (int var = 0; var < csp.num_variables; var++) {
+        csp.domains[var] = make_pair(bounds[2 * var], bounds[2 * var + 1]);
+    }
+
+    uint32_t num_constraints;
+    readBinary(file, &num_constraints, sizeof(num_constraints));
+    csp.constraints.reserve(num_constraints);
+    vector<int32_t> values;
+    for (uint32_t c = 0; c < num_constraints; c++) {
+        int32_t fields[3];
+        readBinary(file, fields, sizeof(fields));
+        if (fields[0] < 0 || fields[0] >= csp.num_variables || fields[1] < 0 || fields[1] >= csp.num_variables ||
+            fields[2] < 0) {
+            throw runtime_error("Invalid binary constraint " + to_string(c));
+        }
+        values.resize(2 * static_cast<size_t>(fields[2]));
+        readBinary(file, values.data(), values.size() * sizeof(int32_t));
+        vector<pair<int, int>> allowed_pairs(values.size() / 2);
+        for (size_t i = 0; i < allowed_pairs.size(); i++) {
+            allowed_pairs[i] = make_pair(values[2 * i], values[2 * i + 1]);
+        }
+        csp.addConstraint(fields[0], fields[1], move(allowed_pairs));
+    }
+
+    // Declared symmetries, absent from the files written before the section
+    if (file.peek() == char_traits<char>::eof()) {
+        return csp;
+    }
+    uint32_t num_symmetries;
+    readBinary(file, &num_symmetries, sizeof(num_symmetries));
+    for (uint32_t s = 0; s < num_symmetries; s++) {
+        int32_t count;
+        readBinary(file, &count, sizeof(count));
+        if (count < 0) {
+            throw runtime_error("Invalid binary symmetry " + to_string(s));
+        }
+        values.resize(4 * static_cast<size_t>(count));
+        readBinary(file, values.data(), values.size() * sizeof(int32_t));
+        vector<LiteralImage> images(count);
+        for (size_t i = 0; i < images.size(); i++) {
+            images[i] = LiteralImage{values[4 * i], values[4 * i + 1], values[4 * i + 2], values[4 * i + 3]};
+        }
+        csp.symmetries.push_back(move(images));
+    }
+    return csp;
+}
+
+CSPInstance parseCSP(istream& file) {
+    // Binary instance (cpgen --binary)?
+    char magic[sizeof(CSP_BINARY_MAGIC)];
+    streampos start = file.tellg();
+    if (file.read(magic, sizeof(magic)) && memcmp(magic, CSP_BINARY_MAGIC, sizeof(magic)) == 0) {
+        return parseCSPBinary(file);
+    }
+    file.clear();
+    file.seekg(start);
     
     CSPInstance csp;
     string line;
     int line_number = 0;
     
-    // Read number of variables
+    // Read number of variables (the header may declare symmetries)
     while (getline(file, line)) {
         line_number++;
         line = trim(line);
         
+        if (isSymmetryLine(line)) {
+            try {
+                csp.symmetries.push_back(parseSymmetryLine(line));
+            } catch (const exception& e) {
+                throw runtime_error("Error parsing symmetry at line " + to_string(line_number) + ": " + e.what());
+            }
+            continue;
+        }
         if (isComment(line) || isEmpty(line)) {
             continue;
         }
@@ -262,7 +493,7 @@ CSPInstance parseCSPFile(const string& filename) {
                 throw runtime_error("Invalid variable IDs in constraint: " + line);
             }
             
-            Constraint constraint(var1, var2);
+            vector<pair<int, int>> allowed_pairs;
             
             // Parse allowed pairs
             for (size_t i = 2; i < tokens.size(); i++) {
@@ -282,10 +513,11 @@ CSPInstance parseCSPFile(const string& filename) {
                 int val1 = stoi(trim(pair_str.substr(0, comma_pos)));
                 int val2 = stoi(trim(pair_str.substr(comma_pos + 1)));
                 
-                constraint.allowed_pairs.push_back(make_pair(val1, val2));
+                allowed_pairs.push_back(make_pair(val1, val2));
             }
             
-            csp.constraints.push_back(constraint);
+            // Identical tables share one relation
+            csp.addConstraint(var1, var2, move(allowed_pairs));
             constraints_read++;
             
         } catch (const exception& e) {
@@ -293,7 +525,5 @@ CSPInstance parseCSPFile(const string& filename) {
         }
     }
     
-    file.close();
-    
     return csp;
 }
\ No newline at end of file
@@ -5,32 +5,115 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <istream>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include "../core/domain.h"
+
+// Relation binaire en extension : les paires (valeur1, valeur2) autorisées,
+// triées et sans doublon. Elle est immuable et partagée par toutes les
+// contraintes qui ont la même table, à une transposition près (RelationPool).
+// Le test d'appartenance lit un bitset sur la boîte englobante des paires
+// quand elle est assez petite, et fait une recherche dichotomique sinon.
+class Relation {
+private:
+    std::vector<std::pair<int, int>> pairs;
+    int first_min;                  // Coin de la boîte englobante
+    int second_min;
+    long long first_span;           // Nombre de valeurs de chaque côté
+    long long second_span;
+    std::vector<uint64_t> bits;     // first_span × second_span bits (vide : dichotomie)
+
+public:
+    // sorted_pairs : triées et sans doublon
+    explicit Relation(std::vector<std::pair<int, int>> sorted_pairs);
+
+    bool contains(int first, int second) const;
+    const std::vector<std::pair<int, int>>& getPairs() const { return pairs; }
+    size_t size() const { return pairs.size(); }
+    // Approximate size in bytes
+    size_t memoryUsage() const {
+        return sizeof(Relation) + pairs.capacity() * sizeof(pairs[0]) + bits.capacity() * sizeof(uint64_t);
+    }
+};
+
+// Table d'internement : une seule Relation par table distincte, retrouvée
+// par un hachage des paires indépendant de leur ordre
+class RelationPool {
+private:
+    std::unordered_multimap<uint64_t, std::shared_ptr<const Relation>> relations;
+
+public:
+    // Relation partagée égale à pairs (ordre quelconque, doublons permis) ;
+    // transposed indique qu'elle contient (b, a) pour chaque paire (a, b)
+    std::shared_ptr<const Relation> intern(std::vector<std::pair<int, int>> pairs, bool& transposed);
+    size_t size() const { return relations.size(); }
+};
 
 // Structure pour représenter une contrainte au format DIMACS
 struct Constraint {
     int var1;                   // ID de la première variable
     int var2;                   // ID de la deuxième variable
-    std::vector<std::pair<int, int>> allowed_pairs; // Paires de valeurs autorisées
+    std::shared_ptr<const Relation> relation; // Paires autorisées, partagées
+    bool transposed;            // relation contient (val2, val1) au lieu de (val1, val2)
+    
+    Constraint(int v1, int v2, std::shared_ptr<const Relation> r, bool t = false)
+        : var1(v1), var2(v2), relation(std::move(r)), transposed(t) {}
     
-    Constraint(int v1, int v2) : var1(v1), var2(v2) {}
+    bool allows(int val1, int val2) const {
+        return transposed ? relation->contains(val2, val1) : relation->contains(val1, val2);
+    }
+    size_t pairCount() const { return relation->size(); }
+    // Copie des paires autorisées dans l'ordre (var1, var2)
+    std::vector<std::pair<int, int>> allowedPairs() const;
+};
+
+// Image d'un littéral (variable, valeur) par une symétrie déclarée
+struct LiteralImage {
+    int var;
+    int value;
+    int image_var;
+    int image_value;
 };
 
 // Structure pour représenter une instance CSP au format DIMACS
 struct CSPInstance {
-    int num_variables;                              // Nombre de variables
+    int num_variables = 0;                          // Nombre de variables
     std::vector<std::pair<int, int>> domains;      // Domaines (min, max) pour chaque variable
     std::vector<Constraint> constraints;           // Contraintes
+    RelationPool relation_pool;                    // Relations internées par addConstraint
+    std::vector<std::vector<LiteralImage>> symmetries; // Symétries déclarées dans l'en-tête (littéraux non fixes)
+    
+    // Ajoute une contrainte en partageant sa table avec les contraintes identiques
+    void addConstraint(int var1, int var2, std::vector<std::pair<int, int>> allowed_pairs);
+    // Nombre de relations distinctes référencées par les contraintes
+    size_t countRelations() const;
+    // Taille approximative en octets (chaque relation partagée comptée une fois)
+    size_t memoryUsage() const;
     
     // Méthodes utilitaires
     bool hasVariable(int var) const;
     std::vector<int> getNeighbors(int var) const;
     std::vector<Constraint> getConstraints(int var) const;
     bool isConsistent(int var1, int val1, int var2, int val2) const;
-    std::vector<int> getDomain(int var) const;     // Retourne toutes les valeurs du domaine
+    Domain getDomain(int var) const;               // Domaine initial (intervalle, en O(1))
 };
 
 // Fonction principale de parsing
 CSPInstance parseCSPFile(const std::string& filename);
+// Même format lu depuis un flux (contenu déjà en mémoire)
+CSPInstance parseCSP(std::istream& input);
+
+// Format binaire (écrit par cpgen --binary), reconnu par parseCSPFile et
+// parseCSP à ses 8 premiers octets. Entiers 32 bits dans l'ordre d'octets
+// de la machine : n, n × (min, max), m, puis pour chaque contrainte
+// var1, var2, nombre de paires k et k × (val1, val2) ; enfin le nombre s
+// de symétries déclarées et pour chacune le nombre de littéraux déplacés l
+// et l × (var, valeur, var image, valeur image). Un fichier qui s'arrête
+// après les contraintes n'a pas de symétrie.
+const char CSP_BINARY_MAGIC[8] = {'C', 'P', 'S', 'P', 'B', 'I', 'N', '1'};
+CSPInstance parseCSPBinary(std::istream& input);
 
 // Fonctions utilitaires de parsing DIMACS
 std::string trim(const std::string& str);
@@ -39,5 +122,8 @@ bool isComment(const std::string& line);
 bool isEmpty(const std::string& line);
 std::pair<int, int> parseDomainLine(const std::string& line);
 std::vector<std::pair<int, int>> parseConstraintLine(const std::string& line);
+// En-tête "# symmetry (var,value)->(var,value) ..." : littéraux absents fixes
+bool isSymmetryLine(const std::string& line);
+std::vector<LiteralImage> parseSymmetryLine(const std::string& line);
 
 #endif // PARSER_H
@@ -0,0 +1,227 @@
+#include "checkpoint.h"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <algorithm>
+
+using namespace std;
+
+static const char* CHECKPOINT_MAGIC = "CPSOLVER-CHECKPOINT";
+// Version 2: the instance hash reads the allowed pairs in sorted order
+static const int CHECKPOINT_VERSION = 2;
+
+static void hashValue(uint64_t& hash, long long value) {
+    for (int i = 0; i < 8; i++) {
+        hash ^= static_cast<uint64_t>(value >> (8 * i)) & 0xff;
+        hash *= 1099511628211ULL;
+    }
+}
+
+uint64_t instanceFingerprint(const CSPInstance& csp) {
+    uint64_t hash = 14695981039346656037ULL;
+    hashValue(hash, csp.num_variables);
+    for (const auto& domain : csp.domains) {
+        hashValue(hash, domain.first);
+        hashValue(hash, domain.second);
+    }
+    for (const auto& constraint : csp.constraints) {
+        hashValue(hash, constraint.var1);
+        hashValue(hash, constraint.var2);
+        hashValue(hash, constraint.pairCount());
+        for (const auto& pair : constraint.relation->getPairs()) {
+            hashValue(hash, constraint.transposed ? pair.second : pair.first);
+            hashValue(hash, constraint.transposed ? pair.first : pair.second);
+        }
+    }
+    return hash;
+}
+
+string checkpointOptions(const SolverParams& params) {
+    return params.var_strategy + " " + params.val_strategy +
+           (params.use_forward_checking ? " fc" : " nofc") +
+           (params.ac3_at_each_node ? " mac" : " nomac") +
+           (params.first_solution_only ? " first" : " all") +
+           (params.count_only ? " count" : " store");
+}
+
+bool checkCheckpoint(const SearchCheckpoint& checkpoint, const CSPInstance& csp,
+                     const string& options, string& error) {
+    if (checkpoint.instance_hash != instanceFingerprint(csp)) {
+        error = "the checkpoint was written for another instance";
+        return false;
+    }
+    if (checkpoint.options != options) {
+        error = "the checkpoint was written with other options (" + checkpoint.options + ")";
+        return false;
+    }
+    if (checkpoint.root_domains.size() != static_cast<size_t>(csp.num_variables) ||
+        checkpoint.frames.size() > static_cast<size_t>(csp.num_variables)) {
+        error = "the checkpoint does not match the number of variables";
+        return false;
+    }
+    return true;
+}
+
+// Text format, one record per line:
+//   CPSOLVER-CHECKPOINT <version>
+//   instance <hash>
+//   options <options>
+//   stats <solutions> <nodes> <backtracks> <elapsed_ms>
+//   state <entering_node> <finished>
+//   rng <mt19937 state>
+//   domains <n>, then per variable: <size> <values...>
+//   frames <k>, then per frame: <var> <next_value> <child_open> <count> <values...>
+//   end
+bool writeCheckpoint(const string& path, const SearchCheckpoint& checkpoint, string& error) {
+    string temp_path = path + ".tmp";
+    {
+        ofstream file(temp_path);
+        if (!file.is_open()) {
+            error = "cannot open " + temp_path;
+            return false;
+        }
+        file << CHECKPOINT_MAGIC << " " << CHECKPOINT_VERSION << "\n";
+        file << "instance " << checkpoint.instance_hash << "\n";
+        file << "options " << checkpoint.options << "\n";
+        file << "stats " << checkpoint.solution_count << " " << checkpoint.nodes_explored << " "
+             << checkpoint.backtracks << " " << checkpoint.elapsed_ms << "\n";
+        file << "state " << checkpoint.entering_node << " " << checkpoint.finished << "\n";
+        file << "rng " << checkpoint.rng_state << "\n";
+        file << "domains " << checkpoint.root_domains.size() << "\n";
+        for (const auto& domain : checkpoint.root_domains) {
+            file << domain.size();
+            for (int value : domain) file << " " << value;
+            file << "\n";
+        }
+        file << "frames " << checkpoint.frames.size() << "\n";
+        for (const auto& frame : checkpoint.frames) {
+            file << frame.var << " " << frame.next_value << " " << frame.child_open << " " << frame.values.size();
+            for (int value : frame.values) file << " " << value;
+            file << "\n";
+        }
+        file << "end\n";
+        file.flush();
+        if (!file) {
+            error = "write error on " + temp_path;
+            return false;
+        }
+    }
+    // A checkpoint interrupted while being written never replaces the last good one
+    if (rename(temp_path.c_str(), path.c_str()) != 0) {
+        error = "cannot rename " + temp_path + " to " + path;
+        return false;
+    }
+    return true;
+}
+
+static bool expectKeyword(istream& in, const string& keyword, string& error) {
+    string word;
+    if (!(in >> word) || word != keyword) {
+        error = "expected '" + keyword + "'";
+        return false;
+    }
+    return true;
+}
+
+bool readCheckpoint(const string& path, SearchCheckpoint& checkpoint, string& error) {
+    ifstream file(path);
+    if (!file.is_open()) {
+        error = "cannot open " + path;
+        return false;
+    }
+    // Counts are checked before anything is allocated: a number takes at
+    // least two characters, so no list is longer than half the file
+    file.seekg(0, ios::end);
+    size_t max_count = static_cast<size_t>(max<streamoff>(file.tellg(), 0)) / 2;
+    file.seekg(0);
+    
+    string magic;
+    int version = 0;
+    if (!(file >> magic >> version) || magic != CHECKPOINT_MAGIC) {
+        error = path + " is not a checkpoint file";
+        return false;
+    }
+    if (version != CHECKPOINT_VERSION) {
+        error = "unsupported checkpoint version " + to_string(version);
+        return false;
+    }
+    
+    if (!expectKeyword(file, "instance", error)) return false;
+    if (!(file >> checkpoint.instance_hash)) {
+        error = "invalid instance record";
+        return false;
+    }
+    if (!expectKeyword(file, "options", error)) return false;
+    file >> ws;
+    getline(file, checkpoint.options);
+    if (!expectKeyword(file, "stats", error) ||
+        !(file >> checkpoint.solution_count >> checkpoint.nodes_explored
+              >> checkpoint.backtracks >> checkpoint.elapsed_ms)) {
+        error = "invalid stats record";
+        return false;
+    }
+    if (!expectKeyword(file, "state", error) ||
+        !(file >> checkpoint.entering_node >> checkpoint.finished)) {
+        error = "invalid state record";
+        return false;
+    }
+    if (!expectKeyword(file, "rng", error)) return false;
+    file >> ws;
+    getline(file, checkpoint.rng_state);
+    
+    // One root domain per variable
+    size_t num_domains = 0;
+    if (!expectKeyword(file, "domains", error)) return false;
+    if (!(file >> num_domains) || num_domains > max_count) {
+        error = "invalid domains record";
+        return false;
+    }
+    checkpoint.root_domains.assign(num_domains, vector<int>());
+    for (auto& domain : checkpoint.root_domains) {
+        size_t size = 0;
+        if (!(file >> size)) {
+            error = "truncated domains";
+            return false;
+        }
+        if (size > max_count) {
+            error = "invalid domain size " + to_string(size);
+            return false;
+        }
+        domain.resize(size);
+        for (int& value : domain) {
+            if (!(file >> value)) {
+                error = "truncated domains";
+                return false;
+            }
+        }
+    }
+    
+    // At most one frame per variable, ordering values of its root domain
+    size_t num_frames = 0;
+    if (!expectKeyword(file, "frames", error)) return false;
+    if (!(file >> num_frames) || num_frames > num_domains) {
+        error = "invalid frames record";
+        return false;
+    }
+    checkpoint.frames.assign(num_frames, SearchCheckpoint::Frame());
+    for (auto& frame : checkpoint.frames) {
+        size_t count = 0;
+        if (!(file >> frame.var >> frame.next_value >> frame.child_open >> count)) {
+            error = "truncated frames";
+            return false;
+        }
+        if (frame.var < 0 || static_cast<size_t>(frame.var) >= num_domains ||
+            count > checkpoint.root_domains[frame.var].size()) {
+            error = "invalid frame on variable " + to_string(frame.var);
+            return false;
+        }
+        frame.values.resize(count);
+        for (int& value : frame.values) {
+            if (!(file >> value)) {
+                error = "truncated frames";
+                return false;
+            }
+        }
+    }
+    return expectKeyword(file, "end", error);
+}
@@ -0,0 +1,53 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "../parser/parser.h"
+#include "../core/params.h"
+
+// Point de reprise d'une recherche chronologique : la pile de décisions
+// suffit, les domaines de chaque nœud sont recalculés en rejouant la
+// propagation depuis les domaines de la racine
+struct SearchCheckpoint {
+    struct Frame {
+        int var;
+        std::vector<int> values;   // Ordre des valeurs du nœud (LCV, aléatoire...)
+        size_t next_value;         // Prochaine valeur à essayer
+        bool child_open;           // values[next_value - 1] est affectée
+    };
+    
+    uint64_t instance_hash = 0;    // Empreinte de l'instance (instanceFingerprint)
+    std::string options;           // Options qui déterminent l'arbre de recherche
+    std::vector<std::vector<int>> root_domains; // Domaines après le prétraitement
+    std::vector<Frame> frames;
+    bool entering_node = true;     // Un nœud reste à ouvrir sous la dernière décision
+    bool finished = false;         // Recherche terminée (arbre épuisé ou première solution)
+    
+    // Statistiques cumulées
+    unsigned long long solution_count = 0;
+    long long nodes_explored = 0;
+    long long backtracks = 0;
+    long long elapsed_ms = 0;
+    
+    std::string rng_state;         // État du générateur des stratégies aléatoires
+};
+
+// Empreinte FNV-1a des domaines et des relations de l'instance
+uint64_t instanceFingerprint(const CSPInstance& csp);
+
+// Options qui déterminent l'arbre de recherche (signature du point de reprise)
+std::string checkpointOptions(const SolverParams& params);
+
+// Vérifie qu'un point de reprise a été écrit pour cette instance et ces
+// options, avant de rien afficher ou écrire pour la reprise
+bool checkCheckpoint(const SearchCheckpoint& checkpoint, const CSPInstance& csp,
+                     const std::string& options, std::string& error);
+
+// Écriture atomique (fichier temporaire puis rename) et lecture ; en cas
+// d'échec, error décrit le problème
+bool writeCheckpoint(const std::string& path, const SearchCheckpoint& checkpoint, std::string& error);
+bool readCheckpoint(const std::string& path, SearchCheckpoint& checkpoint, std::string& error);
+
+#endif // CHECKPOINT_H
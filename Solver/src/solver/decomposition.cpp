@@ -0,0 +1,245 @@
+#include "decomposition.h"
+#include "solver.h"
+#include "../core/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+using namespace std;
+
+vector<vector<int>> findConnectedComponents(const vector<vector<int>>& graph) {
+    int n = graph.size();
+    vector<int> component_of(n, -1);
+    vector<vector<int>> components;
+
+    for (int start = 0; start < n; start++) {
+        if (component_of[start] != -1) continue;
+
+        int id = components.size();
+        components.push_back(vector<int>());
+        vector<int> stack(1, start);
+        component_of[start] = id;
+        while (!stack.empty()) {
+            int var = stack.back();
+            stack.pop_back();
+            components[id].push_back(var);
+            for (int neighbor : graph[var]) {
+                if (component_of[neighbor] == -1) {
+                    component_of[neighbor] = id;
+                    stack.push_back(neighbor);
+                }
+            }
+        }
+        sort(components[id].begin(), components[id].end());
+    }
+    return components;
+}
+
+CSPInstance extractSubInstance(const CSPInstance& csp, const vector<int>& vars,
+                               const vector<int>* constraint_ids) {
+    vector<int> local(csp.num_variables, -1);
+    for (size_t i = 0; i < vars.size(); i++) {
+        local[vars[i]] = i;
+    }
+
+    CSPInstance sub;
+    sub.num_variables = vars.size();
+    for (int var : vars) {
+        sub.domains.push_back(csp.domains[var]);
+    }
+    auto add = [&](const Constraint& c) {
+        if (local[c.var1] != -1 && local[c.var2] != -1) {
+            sub.constraints.emplace_back(local[c.var1], local[c.var2], c.relation, c.transposed);
+        }
+    };
+    if (constraint_ids) {
+        for (int id : *constraint_ids) add(csp.constraints[id]);
+    } else {
+        for (const Constraint& c : csp.constraints) add(c);
+    }
+    return sub;
+}
+
+// --- SolutionProduct ---
+
+SolutionProduct::SolutionProduct(const vector<vector<map<int, int>>>& component_solutions)
+    : parts(&component_solutions) {
+    reset();
+}
+
+void SolutionProduct::reset() {
+    cursor.assign(parts->size(), 0);
+    exhausted = parts->empty();
+    for (const auto& part : *parts) {
+        if (part.empty()) {
+            exhausted = true;
+        }
+    }
+}
+
+bool SolutionProduct::next(map<int, int>& solution) {
+    if (exhausted) {
+        return false;
+    }
+
+    solution.clear();
+    for (size_t i = 0; i < parts->size(); i++) {
+        const map<int, int>& part = (*parts)[i][cursor[i]];
+        solution.insert(part.begin(), part.end());
+    }
+
+    // Advance the odometer, last component fastest
+    size_t i = parts->size();
+    while (true) {
+        if (i == 0) {
+            exhausted = true;
+            break;
+        }
+        i--;
+        if (++cursor[i] < (*parts)[i].size()) {
+            break;
+        }
+        cursor[i] = 0;
+    }
+    return true;
+}
+
+// --- ComponentSolver ---
+
+ComponentSolver::ComponentSolver(const CSPInstance& instance,
+                                 const vector<Domain>& current_domains,
+                                 const vector<vector<int>>& graph)
+    : csp(instance), domains(current_domains) {
+    components = findConnectedComponents(graph);
+
+    vector<int> component_of(csp.num_variables, -1);
+    for (size_t i = 0; i < components.size(); i++) {
+        for (int var : components[i]) component_of[var] = i;
+    }
+    component_constraints.resize(components.size());
+    for (size_t id = 0; id < csp.constraints.size(); id++) {
+        component_constraints[component_of[csp.constraints[id].var1]].push_back(id);
+    }
+}
+
+void ComponentSolver::solveComponent(size_t index, const SolverParams& params,
+                                     chrono::steady_clock::time_point start,
+                                     atomic<bool>& infeasible) {
+    ComponentResult& result = results[index];
+    if (infeasible.load()) {
+        result.skipped = true;
+        return;
+    }
+
+    const vector<int>& vars = components[index];
+    CSPInstance sub = extractSubInstance(csp, vars, &component_constraints[index]);
+    vector<Domain> sub_domains;
+    for (int var : vars) {
+        sub_domains.push_back(domains[var]);
+    }
+
+    // Every component shares the global time limit
+    int elapsed = chrono::duration_cast<chrono::seconds>(chrono::steady_clock::now() - start).count();
+    SolverParams component_params = params;
+    component_params.max_time = max(params.max_time - elapsed, 0);
+
+    CSPSolver solver(sub);
+    solver.setDomains(sub_domains);
+    solver.setRandomSeed(params.seed);
+    vector<map<int, int>> local_solutions;
+    solver.solve(local_solutions, component_params);
+
+    result.solution_count = solver.getSolutionCount();
+    result.nodes_explored = solver.getNodesExplored();
+    result.backtracks = solver.getBacktracks();
+    result.timeout = solver.wasTimeout();
+
+    // Back to the original variable ids
+    for (const auto& local : local_solutions) {
+        map<int, int> solution;
+        for (const auto& assignment : local) {
+            solution[vars[assignment.first]] = assignment.second;
+        }
+        result.solutions.push_back(solution);
+    }
+
+    if (result.solution_count == 0 && !result.timeout) {
+        infeasible.store(true);
+    }
+}
+
+bool ComponentSolver::solve(const SolverParams& params) {
+    auto start = chrono::steady_clock::now();
+    results.assign(components.size(), ComponentResult());
+    atomic<bool> infeasible(false);
+
+    // Largest components first: they bound the total time
+    vector<size_t> order(components.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+        return components[a].size() > components[b].size();
+    });
+
+    int threads = min<int>(ThreadPool::resolveThreadCount(params.num_threads), components.size());
+    if (threads > 1) {
+        ThreadPool pool(threads);
+        for (size_t index : order) {
+            pool.submit([this, index, &params, start, &infeasible] {
+                solveComponent(index, params, start, infeasible);
+            });
+        }
+        pool.wait();
+    } else {
+        for (size_t index : order) {
+            solveComponent(index, params, start, infeasible);
+        }
+    }
+
+    component_solutions.clear();
+    for (auto& result : results) {
+        component_solutions.push_back(std::move(result.solutions));
+    }
+    return !getSolutionCount().isZero();
+}
+
+size_t ComponentSolver::getLargestComponentSize() const {
+    size_t largest = 0;
+    for (const auto& component : components) {
+        largest = max(largest, component.size());
+    }
+    return largest;
+}
+
+BigInt ComponentSolver::getSolutionCount() const {
+    BigInt total(results.empty() ? 0 : 1);
+    for (const auto& result : results) {
+        if (result.skipped) {
+            return BigInt(0);
+        }
+        total *= BigInt(result.solution_count);
+    }
+    return total;
+}
+
+SolutionProduct ComponentSolver::getSolutions() const {
+    return SolutionProduct(component_solutions);
+}
+
+long long ComponentSolver::getNodesExplored() const {
+    long long total = 0;
+    for (const auto& result : results) total += result.nodes_explored;
+    return total;
+}
+
+long long ComponentSolver::getBacktracks() const {
+    long long total = 0;
+    for (const auto& result : results) total += result.backtracks;
+    return total;
+}
+
+bool ComponentSolver::wasTimeout() const {
+    for (const auto& result : results) {
+        if (result.timeout) return true;
+    }
+    return false;
+}
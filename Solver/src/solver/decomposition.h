@@ -0,0 +1,88 @@
+#ifndef DECOMPOSITION_H
+#define DECOMPOSITION_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <atomic>
+#include <chrono>
+#include "../parser/parser.h"
+#include "../core/params.h"
+#include "../core/bigint.h"
+
+// Connected components of a constraint graph (variables sorted in each component)
+std::vector<std::vector<int>> findConnectedComponents(const std::vector<std::vector<int>>& graph);
+
+// Sub-instance restricted to the given variables, renumbered 0..k-1 in order.
+// When known, the indices of the constraints inside the subset can be given
+// to avoid scanning every constraint.
+CSPInstance extractSubInstance(const CSPInstance& csp, const std::vector<int>& vars,
+                               const std::vector<int>* constraint_ids = nullptr);
+
+// Lazy Cartesian product of per-component solutions: full solutions are
+// built one at a time and never stored
+class SolutionProduct {
+private:
+    const std::vector<std::vector<std::map<int, int>>>* parts;
+    std::vector<size_t> cursor;
+    bool exhausted;
+
+public:
+    explicit SolutionProduct(const std::vector<std::vector<std::map<int, int>>>& component_solutions);
+
+    // Restart the enumeration from the first combination
+    void reset();
+
+    // Build the next combined solution; returns false once all have been produced
+    bool next(std::map<int, int>& solution);
+};
+
+// Result of the search on one component
+struct ComponentResult {
+    std::vector<std::map<int, int>> solutions; // Mapped back to the original variable ids
+    unsigned long long solution_count = 0;
+    long long nodes_explored = 0;
+    long long backtracks = 0;
+    bool timeout = false;
+    bool skipped = false;                      // Not searched: another component has no solution
+};
+
+// Solves each connected component of the (filtered) instance independently
+// and combines the results: concatenation for the first solution, product
+// of the counts, lazy Cartesian product for the enumeration.
+class ComponentSolver {
+private:
+    const CSPInstance& csp;
+    std::vector<Domain> domains;
+    std::vector<std::vector<int>> components;
+    std::vector<std::vector<int>> component_constraints; // Constraint indices of each component
+    std::vector<ComponentResult> results;
+    std::vector<std::vector<std::map<int, int>>> component_solutions;
+
+    void solveComponent(size_t index, const SolverParams& params,
+                        std::chrono::steady_clock::time_point start,
+                        std::atomic<bool>& infeasible);
+
+public:
+    ComponentSolver(const CSPInstance& instance,
+                    const std::vector<Domain>& current_domains,
+                    const std::vector<std::vector<int>>& graph);
+
+    // Search every component; returns true if the whole instance has a solution
+    bool solve(const SolverParams& params);
+
+    size_t getComponentCount() const { return components.size(); }
+    size_t getLargestComponentSize() const;
+
+    // Exact product of the per-component counts
+    BigInt getSolutionCount() const;
+
+    // Lazy enumeration of the combined solutions (first solution mode: one)
+    SolutionProduct getSolutions() const;
+
+    long long getNodesExplored() const;
+    long long getBacktracks() const;
+    bool wasTimeout() const;
+};
+
+#endif // DECOMPOSITION_H
@@ -0,0 +1,296 @@
+#include "model_counter.h"
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+// Rough per-entry overhead of the hash map (node, bucket, bookkeeping)
+static const size_t CACHE_ENTRY_OVERHEAD = 64;
+
+// Components whose longest path (as estimated by a BFS from the branching
+// variable) has at least this many edges are branched on its middle
+static const int CENTER_MIN_DISTANCE = 8;
+
+ModelCounter::ModelCounter(const CompiledModel& compiled, size_t cache_mb, int time_limit)
+    : model(compiled), max_cache_bytes(cache_mb * 1024 * 1024), max_time(time_limit),
+      cache_bytes(0), clock(0), mark(compiled.getNumVariables(), 0), mark_stamp(0),
+      bfs_parent(compiled.getNumVariables()), bfs_distance(compiled.getNumVariables()),
+      decisions(0), cache_hits(0), cache_misses(0), cache_evictions(0), splits(0),
+      timeout(false) {}
+
+BigInt ModelCounter::count(vector<DomainBits> domains) {
+    start_time = chrono::steady_clock::now();
+    timeout = false;
+
+    for (const DomainBits& domain : domains) {
+        if (countBits(domain) == 0) {
+            return BigInt(0);
+        }
+    }
+    if (!model.enforceArcConsistency(domains)) {
+        return BigInt(0);
+    }
+
+    vector<int> free_vars;
+    for (int var = 0; var < model.getNumVariables(); var++) {
+        if (countBits(domains[var]) > 1) {
+            free_vars.push_back(var);
+        }
+    }
+    return countFree(domains, free_vars);
+}
+
+// The domains are arc consistent, so every remaining value of a free
+// variable is compatible with the singleton variables around it: only the
+// constraints between free variables matter and the count factorizes over
+// their connected components.
+BigInt ModelCounter::countFree(vector<DomainBits>& domains, const vector<int>& free_vars) {
+    BigInt total(1);
+    if (free_vars.empty()) {
+        return total;
+    }
+
+    vector<vector<int>> components = splitComponents(free_vars);
+    if (components.size() > 1) {
+        splits++;
+    }
+    for (const vector<int>& component : components) {
+        total *= countComponent(domains, component);
+        if (total.isZero() || timeout) {
+            break;
+        }
+    }
+    return total;
+}
+
+BigInt ModelCounter::countComponent(vector<DomainBits>& domains, const vector<int>& vars) {
+    if (vars.size() == 1) {
+        return BigInt(countBits(domains[vars[0]]));
+    }
+
+    string key = makeKey(domains, vars);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        cache_hits++;
+        it->second.last_used = ++clock;
+        return it->second.count;
+    }
+    cache_misses++;
+
+    // Branch on the smallest domain, ties broken by the degree
+    size_t branch = 0;
+    int best_size = -1;
+    size_t best_degree = 0;
+    for (size_t i = 0; i < vars.size(); i++) {
+        int size = countBits(domains[vars[i]]);
+        size_t degree = model.getArcsFrom(vars[i]).size();
+        if (best_size == -1 || size < best_size || (size == best_size && degree > best_degree)) {
+            branch = i;
+            best_size = size;
+            best_degree = degree;
+        }
+    }
+    if (static_cast<int>(vars.size()) > CENTER_MIN_DISTANCE) {
+        int center = findCenter(vars, vars[branch]);
+        if (center >= 0) {
+            branch = lower_bound(vars.begin(), vars.end(), center) - vars.begin();
+        }
+    }
+    int var = vars[branch];
+
+    // Propagation stays inside the component: only its domains are saved
+    vector<DomainBits> saved;
+    saved.reserve(vars.size());
+    for (int v : vars) {
+        saved.push_back(domains[v]);
+    }
+
+    BigInt total(0);
+    const DomainBits& values = saved[branch];
+    vector<int> free_vars;
+    for (size_t w = 0; w < values.size() && !timeout; w++) {
+        uint64_t word = values[w];
+        while (word) {
+            if (checkTimeout()) {
+                break;
+            }
+            int bit = __builtin_ctzll(word);
+            word &= word - 1;
+            decisions++;
+
+            DomainBits& domain = domains[var];
+            fill(domain.begin(), domain.end(), 0);
+            domain[w] = 1ULL << bit;
+
+            if (model.enforceArcConsistency(domains, vector<int>(1, var))) {
+                free_vars.clear();
+                for (int v : vars) {
+                    if (countBits(domains[v]) > 1) {
+                        free_vars.push_back(v);
+                    }
+                }
+                total += countFree(domains, free_vars);
+            }
+
+            for (size_t i = 0; i < vars.size(); i++) {
+                domains[vars[i]] = saved[i];
+            }
+        }
+    }
+
+    // A partial count must not be reused
+    if (!timeout) {
+        store(std::move(key), total);
+    }
+    return total;
+}
+
+vector<vector<int>> ModelCounter::splitComponents(const vector<int>& vars) {
+    // mark == stamp: free and not yet reached, mark == stamp + 1: reached
+    mark_stamp += 2;
+    int member = mark_stamp;
+    int reached = mark_stamp + 1;
+    for (int var : vars) {
+        mark[var] = member;
+    }
+
+    vector<vector<int>> components;
+    vector<int> stack;
+    for (int start : vars) {
+        if (mark[start] != member) continue;
+
+        components.push_back(vector<int>());
+        vector<int>& component = components.back();
+        mark[start] = reached;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            int var = stack.back();
+            stack.pop_back();
+            component.push_back(var);
+            for (int index : model.getArcsFrom(var)) {
+                int neighbor = model.getArc(index).neighbor;
+                if (mark[neighbor] == member) {
+                    mark[neighbor] = reached;
+                    stack.push_back(neighbor);
+                }
+            }
+        }
+        sort(component.begin(), component.end());
+    }
+    return components;
+}
+
+// BFS over the variables marked member (marked member + 1 once reached);
+// returns the last variable reached, which is one of the farthest
+int ModelCounter::sweep(int start, int member) {
+    bfs_order.clear();
+    mark[start] = member + 1;
+    bfs_parent[start] = -1;
+    bfs_distance[start] = 0;
+    bfs_order.push_back(start);
+    for (size_t i = 0; i < bfs_order.size(); i++) {
+        int var = bfs_order[i];
+        for (int index : model.getArcsFrom(var)) {
+            int neighbor = model.getArc(index).neighbor;
+            if (mark[neighbor] == member) {
+                mark[neighbor] = member + 1;
+                bfs_parent[neighbor] = var;
+                bfs_distance[neighbor] = bfs_distance[var] + 1;
+                bfs_order.push_back(neighbor);
+            }
+        }
+    }
+    return bfs_order.back();
+}
+
+// Middle of a longest path of the (connected) component, found by two BFS
+// sweeps; -1 if the component is too compact for it to be a separator
+int ModelCounter::findCenter(const vector<int>& vars, int start) {
+    mark_stamp += 3;
+    int member = mark_stamp - 1;
+    for (int var : vars) {
+        mark[var] = member;
+    }
+    int first = sweep(start, member);
+    if (bfs_distance[first] < CENTER_MIN_DISTANCE) {
+        return -1;
+    }
+    int last = sweep(first, member + 1);
+    int center = last;
+    for (int step = bfs_distance[last] / 2; step > 0; step--) {
+        center = bfs_parent[center];
+    }
+    return center;
+}
+
+string ModelCounter::makeKey(const vector<DomainBits>& domains, const vector<int>& vars) const {
+    size_t length = 0;
+    for (int var : vars) {
+        length += sizeof(int) + domains[var].size() * sizeof(uint64_t);
+    }
+    string key;
+    key.reserve(length);
+    for (int var : vars) {
+        key.append(reinterpret_cast<const char*>(&var), sizeof(int));
+        key.append(reinterpret_cast<const char*>(domains[var].data()),
+                   domains[var].size() * sizeof(uint64_t));
+    }
+    return key;
+}
+
+void ModelCounter::store(string key, const BigInt& count) {
+    if (max_cache_bytes == 0) {
+        return;
+    }
+    cache_bytes += key.size() + count.memoryUsage() + CACHE_ENTRY_OVERHEAD;
+    cache.emplace(std::move(key), CacheEntry{count, ++clock});
+    if (cache_bytes > max_cache_bytes) {
+        evict();
+    }
+}
+
+// Drop the least recently used half of the cache
+void ModelCounter::evict() {
+    vector<unsigned long long> stamps;
+    stamps.reserve(cache.size());
+    for (const auto& entry : cache) {
+        stamps.push_back(entry.second.last_used);
+    }
+    nth_element(stamps.begin(), stamps.begin() + stamps.size() / 2, stamps.end());
+    unsigned long long threshold = stamps[stamps.size() / 2];
+
+    cache_bytes = 0;
+    for (auto it = cache.begin(); it != cache.end();) {
+        if (it->second.last_used < threshold) {
+            it = cache.erase(it);
+            cache_evictions++;
+        } else {
+            cache_bytes += it->first.size() + it->second.count.memoryUsage() + CACHE_ENTRY_OVERHEAD;
+            ++it;
+        }
+    }
+}
+
+bool ModelCounter::checkTimeout() {
+    if (timeout) {
+        return true;
+    }
+    if (max_time > 0 && (decisions & 1023) == 0) {
+        auto elapsed = chrono::duration_cast<chrono::seconds>(chrono::steady_clock::now() - start_time).count();
+        if (elapsed >= max_time) {
+            timeout = true;
+        }
+    }
+    return timeout;
+}
+
+void ModelCounter::printStats() const {
+    cout << "   Counter Statistics:" << endl;
+    cout << "     Decisions: " << decisions << endl;
+    cout << "     Component splits: " << splits << endl;
+    cout << "     Cache hits: " << cache_hits << endl;
+    cout << "     Cache misses: " << cache_misses << endl;
+    cout << "     Cache entries: " << cache.size() << endl;
+    cout << "     Cache evictions: " << cache_evictions << endl;
+    cout << "     Time limit reached: " << (timeout ? "Yes" : "No") << endl;
+}
@@ -0,0 +1,78 @@
+#ifndef MODEL_COUNTER_H
+#define MODEL_COUNTER_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <chrono>
+#include "../core/compiled_model.h"
+#include "../core/bigint.h"
+
+// Exact solution counter (#CSP) with dynamic decomposition and component
+// caching: after each decision and arc consistency, the variables that
+// still have several values are split into connected components that are
+// counted independently and multiplied. Each component count is cached by
+// (variables, domains), so identical sub-problems reached through different
+// branches are only counted once. Long, thin components (chains, trees,
+// bands) are branched on the middle of their longest path, which splits them
+// into halves, so the depth and the copies of the domains stay logarithmic.
+class ModelCounter {
+private:
+    // Cached count of one component
+    struct CacheEntry {
+        BigInt count;
+        unsigned long long last_used;
+    };
+
+    const CompiledModel& model;
+    size_t max_cache_bytes;
+    int max_time; // Seconds (0 = no limit)
+    std::chrono::steady_clock::time_point start_time;
+
+    std::unordered_map<std::string, CacheEntry> cache;
+    size_t cache_bytes;
+    unsigned long long clock; // Access counter used for eviction
+
+    // Scratch space for the component detection
+    std::vector<int> mark;
+    int mark_stamp;
+    std::vector<int> bfs_parent;
+    std::vector<int> bfs_distance;
+    std::vector<int> bfs_order;
+
+    // Statistiques
+    long long decisions;
+    long long cache_hits;
+    long long cache_misses;
+    long long cache_evictions;
+    long long splits;
+    bool timeout;
+
+    BigInt countFree(std::vector<DomainBits>& domains, const std::vector<int>& free_vars);
+    BigInt countComponent(std::vector<DomainBits>& domains, const std::vector<int>& vars);
+    std::vector<std::vector<int>> splitComponents(const std::vector<int>& vars);
+    int sweep(int start, int member);
+    int findCenter(const std::vector<int>& vars, int start);
+    std::string makeKey(const std::vector<DomainBits>& domains, const std::vector<int>& vars) const;
+    void store(std::string key, const BigInt& count);
+    void evict();
+    bool checkTimeout();
+
+public:
+    ModelCounter(const CompiledModel& compiled, size_t cache_mb = 256, int time_limit = 0);
+
+    // Count the solutions of the model restricted to the given domains
+    BigInt count(std::vector<DomainBits> domains);
+
+    long long getDecisions() const { return decisions; }
+    long long getCacheHits() const { return cache_hits; }
+    long long getCacheMisses() const { return cache_misses; }
+    long long getCacheEvictions() const { return cache_evictions; }
+    long long getSplits() const { return splits; }
+    size_t getCacheEntries() const { return cache.size(); }
+    bool wasTimeout() const { return timeout; }
+
+    void printStats() const;
+};
+
+#endif // MODEL_COUNTER_H
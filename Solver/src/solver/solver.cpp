@@ -1,24 +1,40 @@
 #include "solver.h"
 #include "../algorithms/ac3.h"
+#include "../algorithms/sac.h"
+#include "../core/compiled_model.h"
 #include "../strategies/strategies.h"
+#include "../core/alloc_counter.h"
 #include <iostream>
 #include <algorithm>
 #include <chrono>
 #include <cassert>
+#include <functional>
+#include <limits>
 
 using namespace std;
 
+// Nodes explored between two checks of the checkpoint interval
+static const long long CHECKPOINT_STEP_NODES = 4096;
+
 CSPSolver::CSPSolver(const CSPInstance& instance) 
-    : csp(instance), nodes_explored(0), backtracks(0), timeout_occurred(false) {
+    : csp(instance), entering_node(false), count_only(false), solution_count(0), interchangeable(nullptr), symmetry(nullptr),
+      used_values(0), symmetry_prunings(0), nodes_explored(0),
+      search_time_us(0), search_allocations(0), backtracks(0),
+      backjumps(0), max_jump_distance(0), total_jump_distance(0), jump_count(0), max_depth(0),
+      constraint_checks(0), ac3_checks(0), ac3_revisions(0), wipeouts(0), phase_times(nullptr), progress(nullptr), trace_buffer(nullptr),
+      last_wipeout_var(-1),
+      timeout_occurred(false), search_config(), stop_flag(nullptr), clock_countdown(1), kernels(nullptr) {
+    checkpoint_interval = 60;
+    resume_point = nullptr;
+    random_seed = 0;
+    resumed_solutions = 0;
+    resumed_nodes = 0;
+    previous_elapsed_ms = 0;
     
-    // Initialize domains from CSP instance
-    domains.resize(csp.num_variables);
+    // Initialize domains from CSP instance (intervals: no value is stored)
+    domains.reserve(csp.num_variables);
     for (int i = 0; i < csp.num_variables; i++) {
-        int min_val = csp.domains[i].first;
-        int max_val = csp.domains[i].second;
-        for (int val = min_val; val <= max_val; val++) {
-            domains[i].push_back(val);
-        }
+        domains.push_back(csp.getDomain(i));
     }
     
     // Pre-compute static properties
@@ -34,10 +50,21 @@ CSPSolver::CSPSolver(const CSPInstance& instance)
         neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
     }
     
-    assignment.clear();
+    // Wipeouts are attributed to the first constraint on the emptying pair
+    variable_wipeouts.assign(csp.num_variables, 0);
+    constraint_wipeouts.assign(csp.constraints.size(), 0);
+    for (size_t i = 0; i < csp.constraints.size(); i++) {
+        const Constraint& c = csp.constraints[i];
+        long long key = static_cast<long long>(min(c.var1, c.var2)) * csp.num_variables + max(c.var1, c.var2);
+        constraint_index.emplace(key, static_cast<int>(i));
+    }
+    
+    assignment.reset(csp.num_variables);
     solutions.clear();
 }
 
+CSPSolver::~CSPSolver() = default;
+
 bool CSPSolver::isComplete() const {
     return static_cast<int>(assignment.size()) == csp.num_variables;
 }
@@ -45,14 +72,16 @@ bool CSPSolver::isComplete() const {
 bool CSPSolver::isConsistent(int var, int value) const {
     for (const auto& constraint : csp.constraints) {
         if (constraint.var1 == var) {
-            if (assignment.find(constraint.var2) != assignment.end()) {
-                if (!csp.isConsistent(var, value, constraint.var2, assignment.at(constraint.var2))) {
+            if (assignment.isAssigned(constraint.var2)) {
+                constraint_checks++;
+                if (!csp.isConsistent(var, value, constraint.var2, assignment.valueOf(constraint.var2))) {
                     return false;
                 }
             }
         } else if (constraint.var2 == var) {
-            if (assignment.find(constraint.var1) != assignment.end()) {
-                if (!csp.isConsistent(constraint.var1, assignment.at(constraint.var1), var, value)) {
+            if (assignment.isAssigned(constraint.var1)) {
+                constraint_checks++;
+                if (!csp.isConsistent(constraint.var1, assignment.valueOf(constraint.var1), var, value)) {
                     return false;
                 }
             }
@@ -62,23 +91,21 @@ bool CSPSolver::isConsistent(int var, int value) const {
 }
 
 bool CSPSolver::forwardCheckWithDomainReduction(int var, int value) {
-    // Perform forward checking with actual domain reduction
+    // Perform forward checking with actual domain reduction, in place: the
+    // removed values go on the trail
     for (int neighbor : var_interaction_graph[var]) {
-        if (assignment.find(neighbor) == assignment.end()) { // Unassigned neighbor
-            std::vector<int> new_domain;
-            for (int neighbor_value : domains[neighbor]) {
-                if (csp.isConsistent(var, value, neighbor, neighbor_value)) {
-                    new_domain.push_back(neighbor_value);
-                }
-            }
+        if (!assignment.isAssigned(neighbor)) { // Unassigned neighbor
+            trail.filter(domains, neighbor, [&](int neighbor_value) {
+                constraint_checks++;
+                return csp.isConsistent(var, value, neighbor, neighbor_value);
+            });
             
-            if (new_domain.empty()) {
+            if (domains[neighbor].empty()) {
                 // This assignment would make neighbor's domain empty
-                // No need to restore domains here, as the backup is handled in backtrack
+                // No need to restore domains here, the caller undoes the trail
+                recordWipeout(neighbor, var);
                 return false;
             }
-            
-            domains[neighbor] = new_domain; // Update domain
         }
     }
     
@@ -126,7 +153,7 @@ bool CSPSolver::validateSolution(const std::map<int, int>& solution) const {
                 std::cerr << "ERROR: Constraint violated between variables " << var1 
                           << "=" << val1 << " and " << var2 << "=" << val2 << std::endl;
                 std::cerr << "Allowed pairs: ";
-                for (const auto& pair : constraint.allowed_pairs) {
+                for (const auto& pair : constraint.allowedPairs()) {
                     std::cerr << "(" << pair.first << "," << pair.second << ") ";
                 }
                 std::cerr << std::endl;
@@ -138,195 +165,1038 @@ bool CSPSolver::validateSolution(const std::map<int, int>& solution) const {
     return true;
 }
 
-vector<vector<int>> CSPSolver::backupDomains() const {
-    return domains;
-}
-
-void CSPSolver::restoreDomains(const vector<vector<int>>& backup) {
-    domains = backup;
-}
-
 bool CSPSolver::applyAC3(bool verbose) {
     AC3Algorithm ac3(csp);
     ac3.setDomains(domains); // Initialize AC-3 with the current solver domains
     bool consistent = ac3.apply(verbose);
+    addAC3Counters(ac3);
     
     if (consistent) {
         // Use AC3 domains directly
         domains = ac3.getDomains();
+    } else {
+        recordWipeout(ac3.getWipeoutVariable(), ac3.getWipeoutSupport());
     }
     
     return consistent;
 }
 
-bool CSPSolver::solve(vector<map<int, int>>& solutions,
-                     int max_time,
-                     bool first_solution_only,
-                     const string& var_strategy,
-                     const string& val_strategy,
-                     bool use_forward_checking,
-                     bool verbose,
-                     bool ac3_at_each_node,
-                     int max_depth_trace,
-                     int max_depth_ac3_trace,
-                     bool show_global_stats_only) {
+void CSPSolver::addAC3Counters(const AC3Algorithm& ac3) {
+    ac3_checks += ac3.getChecksCount();
+    ac3_revisions += ac3.getRevisionsCount();
+}
+
+void CSPSolver::publishProgress() {
+    progress->nodes.store(nodes_explored, memory_order_relaxed);
+    progress->solutions.store(solution_count, memory_order_relaxed);
+    progress->depth.store(assignment.size(), memory_order_relaxed);
+    
+    // Only the chronological search can estimate its position in the tree:
+    // CBJ jumps over the subtrees it skips
+    if (frames.empty()) return;
+    double fraction = 0.0;
+    double weight = 1.0;
+    for (size_t d = 0; d < frames.size(); d++) {
+        const SearchFrame& frame = frames[d];
+        if (frame.value_count == 0) break;
+        size_t done = frame.next_value - (frame.child_open ? 1 : 0);
+        fraction += weight * done / frame.value_count;
+        weight /= frame.value_count;
+    }
+    progress->explored_fraction.store(fraction, memory_order_relaxed);
+}
+
+size_t CSPSolver::getMemoryUsage() const {
+    size_t bytes = trail.memoryUsage() + value_stack.memoryUsage() + frames.memoryUsage();
+    for (const Domain& domain : domains) bytes += domain.memoryUsage();
+    for (const Domain& domain : root_domains) bytes += domain.memoryUsage();
+    for (const auto& neighbors : var_interaction_graph) {
+        bytes += sizeof(neighbors) + neighbors.capacity() * sizeof(int);
+    }
+    if (compiled_model) bytes += compiled_model->memoryUsage();
+    return bytes;
+}
+
+size_t CSPSolver::domainValueCount() const {
+    size_t total = 0;
+    for (const auto& domain : domains) total += domain.size();
+    return total;
+}
+
+void CSPSolver::recordWipeout(int var, int support) {
+    wipeouts++;
+    last_wipeout_var = var;
+    if (var < 0) return;
+    variable_wipeouts[var]++;
+    if (support >= 0) {
+        long long key = static_cast<long long>(min(var, support)) * csp.num_variables + max(var, support);
+        auto it = constraint_index.find(key);
+        if (it != constraint_index.end()) {
+            constraint_wipeouts[it->second]++;
+        }
+    }
+}
+
+SearchCounters CSPSolver::getCounters() const {
+    SearchCounters counters;
+    counters.nodes = nodes_explored;
+    counters.backtracks = backtracks;
+    counters.backjumps = backjumps;
+    counters.constraint_checks = constraint_checks + ac3_checks;
+    counters.revisions = ac3_revisions;
+    if (search_ac3) {
+        counters.constraint_checks += search_ac3->getChecksCount();
+        counters.revisions += search_ac3->getRevisionsCount();
+    }
+    counters.wipeouts = wipeouts;
+    counters.max_depth = max_depth;
+    counters.variable_wipeouts = variable_wipeouts;
+    counters.constraint_wipeouts = constraint_wipeouts;
+    return counters;
+}
+
+bool CSPSolver::applySAC(int num_threads, int max_time_ms, bool verbose, bool print_stats) {
+    CompiledModel model(csp);
+    SACAlgorithm sac(model, num_threads, max_time_ms);
+    vector<DomainBits> bits = model.toBits(domains);
+    bool consistent = sac.apply(bits, verbose);
+    
+    if (consistent) {
+        domains = model.toValues(bits);
+    }
+    if (print_stats) {
+        sac.printStats();
+    }
     
+    return consistent;
+}
+
+void CSPSolver::initSearch(const SolverParams& params) {
     start_time = chrono::high_resolution_clock::now();
     this->solutions.clear();
+    count_only = params.count_only;
+    solution_count = 0;
+    represented_solutions.clear();
+    value_uses.assign(symmetry && symmetry->hasValueSymmetry() ? symmetry->getValueCount() : 0, 0);
+    used_values = 0;
+    symmetry_prunings = 0;
     nodes_explored = 0;
     backtracks = 0;
+    backjumps = 0;
+    max_jump_distance = 0;
+    total_jump_distance = 0;
+    jump_count = 0;
+    max_depth = 0;
     timeout_occurred = false;
+    search_time_us = 0;
+    search_allocations = 0;
+    resumed_solutions = 0;
+    resumed_nodes = 0;
+    previous_elapsed_ms = 0;
+    assignment.reset(csp.num_variables);
     
-    SelectionStrategies strategies(csp, domains, assignment, var_interaction_graph);
-    
-    // Run backtracking search
-    backtrack(0, var_strategy, val_strategy, use_forward_checking, 
-              max_time, first_solution_only, verbose, strategies,
-              ac3_at_each_node, max_depth_trace, max_depth_ac3_trace, show_global_stats_only);
-    
-    // Copy solutions back to the reference parameter
-    solutions = this->solutions;
+    // LCV counts supports with popcounts over the compiled relations
+    ValueStrategy value_strategy = parseValueStrategy(params.val_strategy);
+    if (value_strategy == ValueStrategy::LCV && !compiled_model) {
+        compiled_model.reset(new CompiledModel(csp));
+    }
+    strategies.reset(new SelectionStrategies(csp, domains, assignment, var_interaction_graph,
+                                             value_strategy == ValueStrategy::LCV ? compiled_model.get() : nullptr));
+    if (random_seed != 0) {
+        strategies->seed(random_seed);
+    }
+    search_config.deadline = start_time + chrono::seconds(params.max_time);
+    clock_countdown = 1;
+    search_config.first_solution_only = params.first_solution_only;
+    search_config.max_depth_trace = params.max_depth_trace;
+    search_config.max_depth_ac3_trace = params.max_depth_ac3_trace;
+    search_config.forward_checking = params.use_forward_checking;
+    search_config.options = checkpointOptions(params);
     
-    // Return true if we found at least one solution
-    return !solutions.empty();
+    // One dispatch for the whole search: strategy names and flags are no
+    // longer tested at each node
+    kernels = &selectKernels(parseVariableStrategy(params.var_strategy), value_strategy,
+                             params.use_forward_checking, params.ac3_at_each_node,
+                             params.verbose && !params.show_global_stats_only);
 }
 
-bool CSPSolver::backtrack(int depth, const string& var_strategy, const string& val_strategy,
-                         bool use_forward_checking, int max_time, bool first_solution_only,
-                         bool verbose, SelectionStrategies& strategies,
-                         bool ac3_at_each_node, int max_depth_trace, 
-                         int max_depth_ac3_trace, bool show_global_stats_only) {
+void CSPSolver::beginSearch(const SolverParams& params) {
+    initSearch(params);
     
-    // Check time limit
-    auto current_time = chrono::high_resolution_clock::now();
-    auto elapsed = chrono::duration_cast<chrono::seconds>(current_time - start_time);
-    if (elapsed.count() >= max_time) {
-        timeout_occurred = true;
-        if (verbose && !show_global_stats_only) cout << "   Time limit reached at depth " << depth << endl;
+    if (search_ac3) {
+        addAC3Counters(*search_ac3);
+    }
+    search_ac3.reset();
+    if (params.ac3_at_each_node) {
+        search_ac3.reset(new AC3Algorithm(csp));
+    }
+    prepareArena();
+}
+
+// Sizes the arena once for the whole search, from the current domains
+void CSPSolver::prepareArena() {
+    root_domains = domains;
+    for (Domain& domain : domains) {
+        domain.reserveHoles();
+    }
+    trail.reserve(domains);
+    // The open nodes order the values of distinct variables
+    value_stack.reserve(trail.capacity());
+    frames.reserve(csp.num_variables);
+    entering_node = true;
+    if (search_ac3) {
+        search_ac3->prepareSearch(domains);
+    }
+}
+
+SearchCheckpoint CSPSolver::makeCheckpoint(bool finished) const {
+    SearchCheckpoint checkpoint;
+    checkpoint.instance_hash = instanceFingerprint(csp);
+    checkpoint.options = search_config.options;
+    for (const Domain& domain : root_domains) {
+        checkpoint.root_domains.push_back(domain.values());
+    }
+    checkpoint.finished = finished;
+    checkpoint.entering_node = entering_node;
+    for (size_t i = 0; i < frames.size(); i++) {
+        const SearchFrame& frame = frames[i];
+        SearchCheckpoint::Frame saved;
+        saved.var = frame.var;
+        saved.values.assign(&value_stack[frame.values_begin],
+                            &value_stack[frame.values_begin] + frame.value_count);
+        saved.next_value = frame.next_value;
+        saved.child_open = frame.child_open;
+        checkpoint.frames.push_back(saved);
+    }
+    checkpoint.solution_count = solution_count;
+    checkpoint.nodes_explored = nodes_explored;
+    checkpoint.backtracks = backtracks;
+    checkpoint.elapsed_ms = previous_elapsed_ms + chrono::duration_cast<chrono::milliseconds>(
+        chrono::high_resolution_clock::now() - start_time).count();
+    checkpoint.rng_state = strategies->getRngState();
+    return checkpoint;
+}
+
+// Rebuilds the state of the checkpointed search: the domains of each open
+// node are recomputed by replaying its propagation (AC-3, then FC for the
+// value being searched) from the root domains
+bool CSPSolver::restoreSearch(const SearchCheckpoint& checkpoint, string& error) {
+    if (!checkCheckpoint(checkpoint, csp, search_config.options, error)) {
         return false;
     }
-    
-    // Check if complete
-    if (isComplete()) {
-        // Validate the solution with an assert
-        assert(validateSolution(assignment) && "CRITICAL ERROR: Invalid solution found!");
-
-        solutions.push_back(assignment);
-        if (verbose && !show_global_stats_only) {
-            cout << "   Solution found at depth " << depth << " (nodes: " << nodes_explored << ")" << endl;
-        }
-        // If we only want the first solution, return true to stop
-        if (first_solution_only) {
-            return true;
+    for (int var = 0; var < csp.num_variables; var++) {
+        const vector<int>& domain = checkpoint.root_domains[var];
+        if (adjacent_find(domain.begin(), domain.end(), greater_equal<int>()) != domain.end() ||
+            (!domain.empty() && (domain.front() < csp.domains[var].first || domain.back() > csp.domains[var].second))) {
+            error = "corrupted root domains";
+            return false;
         }
-        // Otherwise, continue searching for more solutions by returning false
-        // This will make the parent function continue with the next value
+    }
+    if (!strategies->setRngState(checkpoint.rng_state)) {
+        error = "corrupted random generator state";
         return false;
     }
     
-    // --- Domain Backup ---
-    // Backup domains before applying any filtering (AC-3 or FC)
-    auto domain_backup = backupDomains();
-
-    // Apply AC-3 at each node for domain filtering
-    if (ac3_at_each_node) {
-        if (!applyAC3(verbose && !show_global_stats_only && depth < max_depth_ac3_trace)) {
-            // Inconsistent subset, backtrack
-            restoreDomains(domain_backup); // Restore before returning
-            return false; 
-        }
+    for (int var = 0; var < csp.num_variables; var++) {
+        domains[var] = Domain(checkpoint.root_domains[var]);
     }
+    prepareArena();
+    solution_count = checkpoint.solution_count;
+    nodes_explored = checkpoint.nodes_explored;
+    backtracks = checkpoint.backtracks;
+    resumed_solutions = checkpoint.solution_count;
+    resumed_nodes = nodes_explored;
+    previous_elapsed_ms = checkpoint.elapsed_ms;
     
-    // Select variable
-    int var = strategies.selectVariable(var_strategy);
+    // A finished search stays finished
+    if (checkpoint.finished) {
+        entering_node = false;
+        return true;
+    }
     
-    // If var is -1, it means all variables are assigned. This should be caught by isComplete().
-    assert(var != -1 || isComplete());
-    if (var == -1) {
-        return false; 
+    for (size_t depth = 0; depth < checkpoint.frames.size(); depth++) {
+        const SearchCheckpoint::Frame& saved = checkpoint.frames[depth];
+        bool last = depth + 1 == checkpoint.frames.size();
+        if (saved.var < 0 || saved.var >= csp.num_variables || assignment.isAssigned(saved.var) ||
+            saved.values.size() > root_domains[saved.var].size() ||
+            saved.next_value > saved.values.size() ||
+            (saved.child_open && saved.next_value == 0) || (!saved.child_open && !last)) {
+            error = "corrupted decision at depth " + to_string(depth);
+            return false;
+        }
+        // The root domains were checked against the instance domains
+        const vector<int>& root_domain = checkpoint.root_domains[saved.var];
+        for (int value : saved.values) {
+            if (!binary_search(root_domain.begin(), root_domain.end(), value)) {
+                error = "value " + to_string(value) + " outside the root domain of variable " +
+                        to_string(saved.var) + " at depth " + to_string(depth);
+                return false;
+            }
+        }
+        
+        size_t node_mark = trail.mark();
+        if (search_ac3 && !search_ac3->enforce(domains, trail, false)) {
+            error = "replay failed at depth " + to_string(depth) + " (AC-3)";
+            return false;
+        }
+        
+        SearchFrame frame;
+        frame.var = saved.var;
+        frame.values_begin = value_stack.size();
+        frame.value_count = saved.values.size();
+        frame.next_value = saved.next_value;
+        frame.node_mark = node_mark;
+        frame.value_mark = trail.mark();
+        frame.child_open = saved.child_open;
+        for (int value : saved.values) {
+            value_stack.push(value);
+        }
+        frames.push(frame);
+        
+        if (saved.child_open) {
+            int value = saved.values[saved.next_value - 1];
+            if (search_config.forward_checking && !forwardCheckWithDomainReduction(saved.var, value)) {
+                error = "replay failed at depth " + to_string(depth) + " (forward checking)";
+                return false;
+            }
+            assignment.assign(saved.var, value);
+        }
+    }
+    
+    entering_node = checkpoint.entering_node;
+    if (entering_node && !checkpoint.frames.empty() && !checkpoint.frames.back().child_open) {
+        error = "corrupted search state";
+        return false;
     }
-    assert(assignment.find(var) == assignment.end() && "Selected variable is already assigned!");
+    return true;
+}
+
+void CSPSolver::saveCheckpoint(bool finished) {
+    string error;
+    if (!writeCheckpoint(checkpoint_path, makeCheckpoint(finished), error)) {
+        cerr << "WARNING: checkpoint not written: " << error << endl;
+    }
+}
+
+CSPSolver::SearchStatus CSPSolver::step(long long budget) {
+    assert(kernels && "step(): beginSearch() was not called");
+    unsigned long long allocations_before = heapAllocationCount();
+    auto step_start = chrono::high_resolution_clock::now();
+    
+    SearchStatus status = (this->*kernels->step)(budget);
+    
+    search_time_us += chrono::duration_cast<chrono::microseconds>(
+        chrono::high_resolution_clock::now() - step_start).count();
+    search_allocations += heapAllocationCount() - allocations_before;
+    return status;
+}
 
-    if (verbose && !show_global_stats_only && depth < max_depth_trace) {
-        cout << "   Depth " << depth << ": selecting variable " << var 
-             << " (domain size: " << domains[var].size() << ")" << endl;
-        cout << "     Current domains: ";
-        for (int i = 0; i < csp.num_variables; i++) {
-            if (assignment.find(i) == assignment.end()) {
-                cout << i << "[" << domains[i].size() << "] ";
+bool CSPSolver::solve(vector<map<int, int>>& solutions, const SolverParams& params) {
+    // Nogoods are learned from the CBJ conflict sets
+    nogood_store.reset();
+    if (params.use_nogoods) {
+        nogood_store.reset(new NogoodStore(csp, params.max_nogoods));
+    }
+    
+    // Run backtracking search
+    if (params.use_cbj || params.use_nogoods) {
+        // Same arena as the chronological kernel: domains and explanations
+        // are restored from their trails, not from copies
+        beginSearch(params);
+        explanation_trail.reserve(trail.capacity());
+        cbj_frames.reserve(csp.num_variables);
+        assigned_order.assign(csp.num_variables, -1);
+        var_depth.assign(csp.num_variables, -1);
+        conflict_sets.assign(csp.num_variables, vector<int>());
+        prune_explanations.assign(csp.num_variables, vector<int>());
+        
+        unsigned long long allocations_before = heapAllocationCount();
+        auto search_start = chrono::high_resolution_clock::now();
+        (this->*kernels->backtrack_cbj)();
+        search_time_us = chrono::duration_cast<chrono::microseconds>(
+            chrono::high_resolution_clock::now() - search_start).count();
+        search_allocations = heapAllocationCount() - allocations_before;
+    } else {
+        beginSearch(params);
+        resume_error.clear();
+        if (resume_point) {
+            bool restored = restoreSearch(*resume_point, resume_error);
+            resume_point = nullptr;
+            if (!restored) {
+                return false;
             }
         }
-        cout << endl;
+        
+        // Without checkpoints the search runs in a single step
+        bool checkpointing = !checkpoint_path.empty();
+        long long budget = checkpointing ? CHECKPOINT_STEP_NODES : numeric_limits<long long>::max();
+        auto last_checkpoint = chrono::high_resolution_clock::now();
+        SearchStatus status;
+        do {
+            status = step(budget);
+            if (checkpointing) {
+                bool finished = status == SearchStatus::EXHAUSTED ||
+                                (status == SearchStatus::SOLUTION && params.first_solution_only);
+                auto now = chrono::high_resolution_clock::now();
+                if (finished || status == SearchStatus::TIMEOUT || status == SearchStatus::CANCELLED ||
+                    chrono::duration_cast<chrono::seconds>(now - last_checkpoint).count() >= checkpoint_interval) {
+                    saveCheckpoint(finished);
+                    last_checkpoint = now;
+                }
+            }
+        } while (status == SearchStatus::RUNNING ||
+                 (status == SearchStatus::SOLUTION && !params.first_solution_only));
     }
     
-    // Order values for selected variable
-    vector<int> values = strategies.orderValues(var, val_strategy);
+    // Copy solutions back to the reference parameter
+    solutions = this->solutions;
     
-    for (int value : values) {
-        nodes_explored++;
+    // Return true if we found at least one solution
+    return solution_count > 0;
+}
+
+template <VariableStrategy V, ValueStrategy W, bool FC, bool MAC, bool TRACE>
+CSPSolver::SearchStatus CSPSolver::searchStep(long long budget) {
+    const SearchConfig& config = search_config;
+    
+    while (true) {
+        // --- Open a node ---
+        if (entering_node) {
+            int depth = static_cast<int>(frames.size());
+            
+            // Check cancellation and time limit (the node stays pending, so
+            // the search can resume)
+            if (stopRequested()) {
+                return SearchStatus::CANCELLED;
+            }
+            if (deadlineReached()) {
+                timeout_occurred = true;
+                if constexpr (TRACE) cout << "   Time limit reached at depth " << depth << endl;
+                return SearchStatus::TIMEOUT;
+            }
+            entering_node = false;
+            if (depth > max_depth) max_depth = depth;
+            
+            // Check if complete
+            if (isComplete()) {
+                // Validate the solution with an assert
+                assert(validateSolution(assignment.toMap()) && "CRITICAL ERROR: Invalid solution found!");
+
+                solution_count++;
+                if (interchangeable) interchangeable->addWeight(assignment, represented_solutions);
+                if (symmetry) symmetry->addWeight(assignment, used_values, represented_solutions);
+                if (!count_only) {
+                    solutions.push_back(assignment.toMap());
+                }
+                if (trace_buffer) trace_buffer->push(TraceKind::SOLUTION, depth, -1, -1, 0);
+                if constexpr (TRACE) {
+                    cout << "   Solution found at depth " << depth << " (nodes: " << nodes_explored << ")" << endl;
+                }
+                // The next step continues with the next value of the parent
+                return SearchStatus::SOLUTION;
+            }
+            
+            // --- Trail Mark ---
+            // Every filtering below this node (AC-3 or FC) is undone back to this mark
+            size_t node_mark = trail.mark();
+            
+            // Apply AC-3 at each node for domain filtering
+            if constexpr (MAC) {
+                ScopedTimer timer(phase_times, Phase::PROPAGATION);
+                size_t removed_before = trail.removedCount();
+                if (!search_ac3->enforce(domains, trail, TRACE && depth < config.max_depth_ac3_trace)) {
+                    // Inconsistent subset, backtrack
+                    recordWipeout(search_ac3->getWipeoutVariable(), search_ac3->getWipeoutSupport());
+                    if (trace_buffer) {
+                        trace_buffer->push(TraceKind::PROPAGATE_FAIL, depth, last_wipeout_var, -1,
+                                           trail.removedCount() - removed_before);
+                    }
+                    trail.undo(domains, node_mark);
+                    continue;
+                }
+                if (trace_buffer && trail.removedCount() > removed_before) {
+                    trace_buffer->push(TraceKind::PROPAGATE, depth, -1, -1, trail.removedCount() - removed_before);
+                }
+            }
+            
+            // Select variable
+            int var;
+            {
+                ScopedTimer timer(phase_times, Phase::SELECTION);
+                var = strategies->selectVariable<V>();
+            }
+            
+            // If var is -1, it means all variables are assigned. This should be caught by isComplete().
+            assert(var != -1 || isComplete());
+            if (var == -1) {
+                trail.undo(domains, node_mark);
+                continue;
+            }
+            assert(!assignment.isAssigned(var) && "Selected variable is already assigned!");
+            
+            if constexpr (TRACE) {
+                if (depth < config.max_depth_trace) {
+                    cout << "   Depth " << depth << ": selecting variable " << var 
+                         << " (domain size: " << domains[var].size() << ")" << endl;
+                    cout << "     Current domains: ";
+                    for (int i = 0; i < csp.num_variables; i++) {
+                        if (!assignment.isAssigned(i)) {
+                            cout << i << "[" << domains[i].size() << "] ";
+                        }
+                    }
+                    cout << endl;
+                }
+            }
+            
+            // Order values for selected variable (on the value stack, popped with the frame)
+            SearchFrame frame;
+            frame.var = var;
+            frame.values_begin = value_stack.size();
+            {
+                ScopedTimer timer(phase_times, Phase::VALUE_ORDERING);
+                frame.value_count = strategies->orderValues<W>(var, value_stack);
+                if (symmetry && symmetry->hasValueSymmetry()) {
+                    frame.value_count = keepOneUnusedValue(frame.values_begin, frame.value_count);
+                }
+            }
+            frame.next_value = 0;
+            frame.node_mark = node_mark;
+            frame.value_mark = node_mark;
+            frame.child_open = false;
+            frames.push(frame);
+        }
         
-        // Check consistency
-        if (!isConsistent(var, value)) {
-            continue;
+        if (frames.empty()) {
+            return SearchStatus::EXHAUSTED;
         }
+        SearchFrame& frame = frames.back();
         
-        // --- Forward Checking with Domain Reduction ---
-        // Backup domains before applying forward checking
-        vector<vector<int>> domain_backup_fc;
-        if (use_forward_checking) {
-            domain_backup_fc = backupDomains();
-            if (!forwardCheckWithDomainReduction(var, value)) {
-                // If FC fails, restore domains and prune this value
-                restoreDomains(domain_backup_fc);
-                continue;
+        // --- Backtrack ---
+        // Back from the subtree of the current value
+        if (frame.child_open) {
+            // Restore domains after trying a value (filtered by FC and
+            // symmetry breaking)
+            if (FC || symmetry) {
+                trail.undo(domains, frame.value_mark);
             }
+            if (symmetry) releaseValue(assignment.valueOf(frame.var));
+            assignment.unassign(frame.var);
+            assert(!assignment.isAssigned(frame.var) && "Backtrack failed to erase variable from assignment");
+            backtracks++;
+            frame.child_open = false;
         }
         
-        // Assign value
-        assignment[var] = value;
+        // --- Domain Restoration ---
+        // Every value tried: restore domains to their state before this node
+        if (frame.next_value == frame.value_count) {
+            value_stack.truncate(frame.values_begin);
+            trail.undo(domains, frame.node_mark);
+            frames.pop();
+            continue;
+        }
         
-        if (verbose && !show_global_stats_only && depth < max_depth_trace) {
-            cout << "     Trying " << var << " = " << value << endl;
+        if (budget <= 0) {
+            return SearchStatus::RUNNING;
         }
+        budget--;
         
-        // Recursive call
-        bool result = backtrack(depth + 1, var_strategy, val_strategy, 
-                              use_forward_checking, max_time, first_solution_only, 
-                              verbose, strategies, ac3_at_each_node, max_depth_trace, 
-                              max_depth_ac3_trace, show_global_stats_only);
+        int value = value_stack[frame.values_begin + frame.next_value++];
+        nodes_explored++;
         
-        // If we found a solution and only want the first one, return immediately
-        if (result && first_solution_only) {
-            return true;
+        {
+            ScopedTimer timer(phase_times, Phase::PROPAGATION);
+            
+            // Check consistency
+            if (!isConsistent(frame.var, value)) {
+                if (trace_buffer) trace_buffer->push(TraceKind::CONFLICT, frames.size() - 1, frame.var, value, 0);
+                continue;
+            }
+            
+            // --- Forward Checking with Domain Reduction ---
+            // Mark the trail before applying forward checking
+            frame.value_mark = trail.mark();
+            size_t removed_before = trail.removedCount();
+            if constexpr (FC) {
+                if (!forwardCheckWithDomainReduction(frame.var, value)) {
+                    // If FC fails, restore domains and prune this value
+                    if (trace_buffer) {
+                        trace_buffer->push(TraceKind::WIPEOUT, frames.size() - 1, frame.var, value,
+                                           trail.removedCount() - removed_before);
+                    }
+                    trail.undo(domains, frame.value_mark);
+                    continue;
+                }
+            }
+            
+            // --- Symmetry Breaking (SBDS) ---
+            if (symmetry && symmetry->getGroupSize() > 1 && !pruneSymmetricValues(frame.var, value)) {
+                if (trace_buffer) trace_buffer->push(TraceKind::CONFLICT, frames.size() - 1, frame.var, value, 0);
+                trail.undo(domains, frame.value_mark);
+                continue;
+            }
+            if (trace_buffer) {
+                trace_buffer->push(TraceKind::ASSIGN, frames.size() - 1, frame.var, value,
+                                   trail.removedCount() - removed_before);
+            }
         }
         
-        // If we want all solutions, continue searching regardless of result
-        // (result will be false when we continue searching after finding a solution)
+        // Assign value and open the child node
+        assignment.assign(frame.var, value);
+        if (symmetry) useValue(value);
         
-        // --- Backtrack ---
-        // Restore domains after trying a value
-        if (use_forward_checking) {
-            restoreDomains(domain_backup_fc);
+        if constexpr (TRACE) {
+            if (static_cast<int>(frames.size()) - 1 < config.max_depth_trace) {
+                cout << "     Trying " << frame.var << " = " << value << endl;
+            }
+        }
+        
+        frame.child_open = true;
+        entering_node = true;
+    }
+}
+
+// --- Symmetry Breaking ---
+
+// Value symmetry: the values no assigned variable takes are interchangeable,
+// so only the first of them in the ordering is tried
+size_t CSPSolver::keepOneUnusedValue(size_t values_begin, size_t value_count) {
+    int min_value = symmetry->getValueMin();
+    size_t kept = values_begin;
+    bool unused_kept = false;
+    for (size_t i = values_begin; i < values_begin + value_count; i++) {
+        int value = value_stack[i];
+        if (value_uses[value - min_value] == 0) {
+            if (unused_kept) {
+                symmetry_prunings++;
+                continue;
+            }
+            unused_kept = true;
         }
+        value_stack[kept++] = value;
+    }
+    value_stack.truncate(kept);
+    return kept - values_begin;
+}
+
+void CSPSolver::useValue(int value) {
+    if (symmetry->hasValueSymmetry() && value_uses[value - symmetry->getValueMin()]++ == 0) {
+        used_values++;
+    }
+}
+
+void CSPSolver::releaseValue(int value) {
+    if (symmetry->hasValueSymmetry() && --value_uses[value - symmetry->getValueMin()] == 0) {
+        used_values--;
+    }
+}
+
+// SBDS over the declared group, checked when var=value is tried. At each
+// open node, the values tried before the current one were refuted under the
+// decisions above it: for every element g mapping those decisions to ones
+// that hold, the image by g of each refuted value is forbidden. Returns
+// false when the image is var=value itself, or already assigned, or when a
+// removal wipes a domain out.
+bool CSPSolver::pruneSymmetricValues(int var, int value) {
+    auto holds = [&](int image_var, int image_value) {
+        return image_var == var ? image_value == value
+                                : assignment.isAssigned(image_var) && assignment.valueOf(image_var) == image_value;
+    };
+    for (size_t element = 0; element + 1 < symmetry->getGroupSize(); element++) {
+        for (size_t level = 0; level < frames.size(); level++) {
+            const SearchFrame& node = frames[level];
+            size_t current = node.values_begin + node.next_value - 1;
+            for (size_t i = node.values_begin; i < current; i++) {
+                int image_var, image_value;
+                symmetry->image(element, node.var, value_stack[i], image_var, image_value);
+                if (image_var == var || assignment.isAssigned(image_var)) {
+                    if (holds(image_var, image_value)) {
+                        symmetry_prunings++;
+                        return false;
+                    }
+                } else if (domains[image_var].contains(image_value)) {
+                    trail.filter(domains, image_var, [image_value](int v) { return v != image_value; });
+                    symmetry_prunings++;
+                    if (domains[image_var].empty()) return false;
+                }
+            }
+            // Deeper nodes only count while g maps the decisions to ones that hold
+            int image_var, image_value;
+            symmetry->image(element, node.var, value_stack[current], image_var, image_value);
+            if (!holds(image_var, image_value)) break;
+        }
+    }
+    return true;
+}
+
+// --- Conflict-Directed Backjumping ---
+
+// Returns the shallowest assigned variable incompatible with var=value, or -1
+int CSPSolver::findConflictingVariable(int var, int value) const {
+    int culprit = -1;
+    for (int neighbor : var_interaction_graph[var]) {
+        if (!assignment.isAssigned(neighbor)) continue;
+        constraint_checks++;
+        if (!csp.isConsistent(var, value, neighbor, assignment.valueOf(neighbor))) {
+            if (culprit == -1 || var_depth[neighbor] < var_depth[culprit]) {
+                culprit = neighbor;
+            }
+        }
+    }
+    return culprit;
+}
+
+void CSPSolver::mergeConflicts(vector<int>& target, const vector<int>& source, int exclude) const {
+    for (int v : source) {
+        if (v != exclude && find(target.begin(), target.end(), v) == target.end()) {
+            target.push_back(v);
+        }
+    }
+}
+
+bool CSPSolver::forwardCheckWithExplanations(int var, int value, vector<int>& conflict) {
+    // Same filtering as forwardCheckWithDomainReduction, but every reduced
+    // domain remembers that var is (partly) responsible for it
+    for (int neighbor : var_interaction_graph[var]) {
+        if (!assignment.isAssigned(neighbor)) {
+            int removed = trail.filter(domains, neighbor, [&](int neighbor_value) {
+                constraint_checks++;
+                return csp.isConsistent(var, value, neighbor, neighbor_value);
+            });
+            
+            if (domains[neighbor].empty()) {
+                recordWipeout(neighbor, var);
+                // The values of neighbor were removed either by var or by the
+                // past variables that already pruned it; the caller undoes the trail
+                conflict = prune_explanations[neighbor];
+                return false;
+            }
+            
+            vector<int>& explanation = prune_explanations[neighbor];
+            if (removed > 0 && find(explanation.begin(), explanation.end(), var) == explanation.end()) {
+                explanation_trail.save(prune_explanations, neighbor);
+                explanation.push_back(var);
+            }
+        }
+    }
+    return true;
+}
+
+// In-place AC-3 of the search: the removals go on the trail and the
+// explanations on their undo log, both undone by the caller
+bool CSPSolver::applyAC3WithExplanations(bool verbose, vector<int>& conflict) {
+    if (!search_ac3->enforce(domains, trail, verbose, &prune_explanations, &explanation_trail)) {
+        recordWipeout(search_ac3->getWipeoutVariable(), search_ac3->getWipeoutSupport());
+        conflict = prune_explanations[search_ac3->getWipeoutVariable()];
+        return false;
+    }
+    return true;
+}
+
+// Records the current decisions of the conflict variables as a nogood
+void CSPSolver::learnNogood(const vector<int>& conflict) {
+    if (!nogood_store || conflict.empty()) {
+        return;
+    }
+    vector<Literal> literals;
+    for (int v : conflict) {
+        literals.push_back(Literal(v, assignment.valueOf(v)));
+    }
+    nogood_store->add(literals, var_depth);
+}
 
-        // Backtrack
-        assignment.erase(var);
-        assert(assignment.find(var) == assignment.end() && "Backtrack failed to erase variable from assignment");
-        backtracks++;
+// Jumps from a dead end at the given depth to the deepest variable of the
+// conflict, which inherits the rest of the conflict set
+int CSPSolver::jumpBack(int depth, vector<int>& conflict) {
+    int target_depth = -1;
+    for (int v : conflict) {
+        target_depth = max(target_depth, var_depth[v]);
     }
     
-    // --- Domain Restoration ---
-    // Restore domains to their state before this variable's assignment
-    restoreDomains(domain_backup);
+    int distance = depth - target_depth;
+    jump_count++;
+    total_jump_distance += distance;
+    max_jump_distance = max(max_jump_distance, distance);
+    if (distance > 1) {
+        backjumps++;
+        if (trace_buffer) trace_buffer->push(TraceKind::BACKJUMP, depth, -1, target_depth, 0);
+    }
     
-    // Return false to continue searching for more solutions
-    // The solutions are already stored in the solutions vector
-    return false;
+    if (target_depth >= 0) {
+        int target_var = assigned_order[target_depth];
+        mergeConflicts(conflict_sets[target_var], conflict, target_var);
+    }
+    return target_depth;
+}
+
+template <VariableStrategy V, ValueStrategy W, bool FC, bool MAC, bool TRACE>
+int CSPSolver::backtrackCBJ() {
+    const SearchConfig& config = search_config;
+    
+    // One frame per open node, as in searchStep: the depth of the search is
+    // bounded by the number of variables, not by the call stack
+    bool entering = true;   // A new node must be opened at depth cbj_frames.size()
+    int target = -1;        // Depth the last closed node jumps back to
+    
+    while (true) {
+        int depth = static_cast<int>(cbj_frames.size());
+        bool child_closed = true;   // The node of the current value is closed
+        
+        if (entering) {
+            entering = false;
+            
+            // Check cancellation and time limit
+            if (stopRequested()) {
+                target = SEARCH_STOP;
+            } else if (deadlineReached()) {
+                timeout_occurred = true;
+                if constexpr (TRACE) cout << "   Time limit reached at depth " << depth << endl;
+                target = SEARCH_STOP;
+            } else if (isComplete()) {
+                if (depth > max_depth) max_depth = depth;
+                assert(validateSolution(assignment.toMap()) && "CRITICAL ERROR: Invalid solution found!");
+                
+                solution_count++;
+                if (interchangeable) interchangeable->addWeight(assignment, represented_solutions);
+                if (!count_only) {
+                    solutions.push_back(assignment.toMap());
+                }
+                if (trace_buffer) trace_buffer->push(TraceKind::SOLUTION, depth, -1, -1, 0);
+                if constexpr (TRACE) {
+                    cout << "   Solution found at depth " << depth << " (nodes: " << nodes_explored << ")" << endl;
+                }
+                // Subtrees containing solutions are always left chronologically
+                target = config.first_solution_only ? SEARCH_STOP : depth - 1;
+            } else {
+                if (depth > max_depth) max_depth = depth;
+                
+                // --- Trail marks: the node is undone by truncating both trails ---
+                CBJFrame frame;
+                frame.node_mark = trail.mark();
+                frame.node_explanation_mark = explanation_trail.mark();
+                frame.solutions_before = solution_count;
+                
+                bool consistent = true;
+                if constexpr (MAC) {
+                    ScopedTimer timer(phase_times, Phase::PROPAGATION);
+                    vector<int> conflict;
+                    size_t values_before = trace_buffer ? domainValueCount() : 0;
+                    if (!applyAC3WithExplanations(TRACE && depth < config.max_depth_ac3_trace, conflict)) {
+                        if (trace_buffer) trace_buffer->push(TraceKind::PROPAGATE_FAIL, depth, last_wipeout_var, -1, 0);
+                        trail.undo(domains, frame.node_mark);
+                        explanation_trail.undo(prune_explanations, frame.node_explanation_mark);
+                        learnNogood(conflict);
+                        target = jumpBack(depth, conflict);
+                        consistent = false;
+                    } else if (trace_buffer && domainValueCount() < values_before) {
+                        trace_buffer->push(TraceKind::PROPAGATE, depth, -1, -1, values_before - domainValueCount());
+                    }
+                }
+                
+                if (consistent) {
+                    {
+                        ScopedTimer timer(phase_times, Phase::SELECTION);
+                        frame.var = strategies->selectVariable<V>();
+                    }
+                    assert(frame.var != -1 || isComplete());
+                    if (frame.var == -1) {
+                        target = depth - 1;
+                    } else {
+                        assert(!assignment.isAssigned(frame.var) && "Selected variable is already assigned!");
+                        conflict_sets[frame.var].clear();
+                        
+                        if constexpr (TRACE) {
+                            if (depth < config.max_depth_trace) {
+                                cout << "   Depth " << depth << ": selecting variable " << frame.var
+                                     << " (domain size: " << domains[frame.var].size() << ")" << endl;
+                            }
+                        }
+                        
+                        // Values on the value stack, popped with the frame
+                        frame.values_begin = value_stack.size();
+                        {
+                            ScopedTimer timer(phase_times, Phase::VALUE_ORDERING);
+                            frame.value_count = strategies->orderValues<W>(frame.var, value_stack);
+                        }
+                        frame.next_value = 0;
+                        frame.value_mark = frame.node_mark;
+                        frame.value_explanation_mark = frame.node_explanation_mark;
+                        cbj_frames.push(frame);
+                    }
+                }
+            }
+            
+            // The node closed at once: its parent gets the jump target
+            child_closed = static_cast<int>(cbj_frames.size()) == depth;
+            if (child_closed && cbj_frames.empty()) return target;
+        }
+        
+        depth = static_cast<int>(cbj_frames.size()) - 1;
+        CBJFrame& frame = cbj_frames.back();
+        int var = frame.var;
+        
+        // --- Backtrack ---
+        // Back from the subtree of the current value
+        if (child_closed) {
+            trail.undo(domains, frame.value_mark);
+            explanation_trail.undo(prune_explanations, frame.value_explanation_mark);
+            assignment.unassign(var);
+            assigned_order[depth] = -1;
+            var_depth[var] = -1;
+            backtracks++;
+            
+            // Stop, or keep unwinding until the culprit level is reached
+            if (target == SEARCH_STOP || target < depth) {
+                if (target != SEARCH_STOP) {
+                    trail.undo(domains, frame.node_mark);
+                    explanation_trail.undo(prune_explanations, frame.node_explanation_mark);
+                }
+                value_stack.truncate(frame.values_begin);
+                cbj_frames.pop();
+                if (cbj_frames.empty()) return target;
+                continue;
+            }
+        }
+        
+        // Try the next values of var until one opens a child node
+        while (frame.next_value < frame.value_count) {
+            int value = value_stack[frame.values_begin + frame.next_value++];
+            nodes_explored++;
+            frame.value_mark = trail.mark();
+            frame.value_explanation_mark = explanation_trail.mark();
+            size_t values_before = 0; // Domain values before the propagation (trace)
+            {
+                ScopedTimer timer(phase_times, Phase::PROPAGATION);
+                
+                // Check consistency, remembering which past variable forbids the value
+                if constexpr (!FC) {
+                    int culprit = findConflictingVariable(var, value);
+                    if (culprit != -1) {
+                        mergeConflicts(conflict_sets[var], {culprit}, var);
+                        if (trace_buffer) trace_buffer->push(TraceKind::CONFLICT, depth, var, value, 0);
+                        continue;
+                    }
+                } else if (!isConsistent(var, value)) {
+                    if (trace_buffer) trace_buffer->push(TraceKind::CONFLICT, depth, var, value, 0);
+                    continue;
+                }
+                if (trace_buffer) values_before = domainValueCount();
+                
+                // --- Forward Checking with explanations ---
+                if constexpr (FC) {
+                    vector<int> conflict;
+                    if (!forwardCheckWithExplanations(var, value, conflict)) {
+                        if (trace_buffer) {
+                            trace_buffer->push(TraceKind::WIPEOUT, depth, var, value, values_before - domainValueCount());
+                        }
+                        mergeConflicts(conflict_sets[var], conflict, var);
+                        trail.undo(domains, frame.value_mark);
+                        explanation_trail.undo(prune_explanations, frame.value_explanation_mark);
+                        continue;
+                    }
+                }
+            }
+            
+            // Assign value
+            assignment.assign(var, value);
+            assigned_order[depth] = var;
+            var_depth[var] = depth;
+            
+            // --- Nogood propagation ---
+            if (nogood_store) {
+                vector<int> conflict;
+                if (!nogood_store->propagate(var, value, assignment, domains, trail, prune_explanations,
+                                             explanation_trail, conflict)) {
+                    if (trace_buffer) {
+                        trace_buffer->push(TraceKind::WIPEOUT, depth, var, value, values_before - domainValueCount());
+                    }
+                    mergeConflicts(conflict_sets[var], conflict, var);
+                    trail.undo(domains, frame.value_mark);
+                    explanation_trail.undo(prune_explanations, frame.value_explanation_mark);
+                    assignment.unassign(var);
+                    assigned_order[depth] = -1;
+                    var_depth[var] = -1;
+                    continue;
+                }
+            }
+            
+            if (trace_buffer) {
+                trace_buffer->push(TraceKind::ASSIGN, depth, var, value, values_before - domainValueCount());
+            }
+            if constexpr (TRACE) {
+                if (depth < config.max_depth_trace) {
+                    cout << "     Trying " << var << " = " << value << endl;
+                }
+            }
+            entering = true;
+            break;
+        }
+        if (entering) continue;
+        
+        // --- Dead end: every value of var failed ---
+        vector<int> conflict = conflict_sets[var];
+        mergeConflicts(conflict, prune_explanations[var], var);
+        if (solution_count > frame.solutions_before) {
+            // Solutions below: every earlier decision must still be revisited
+            conflict.assign(assigned_order.begin(), assigned_order.begin() + depth);
+        } else {
+            // No solution below: the culprit decisions form a nogood
+            learnNogood(conflict);
+        }
+        
+        trail.undo(domains, frame.node_mark);
+        explanation_trail.undo(prune_explanations, frame.node_explanation_mark);
+        value_stack.truncate(frame.values_begin);
+        cbj_frames.pop();
+        
+        target = jumpBack(depth, conflict);
+        if constexpr (TRACE) {
+            if (depth < config.max_depth_trace && target < depth - 1) {
+                cout << "     Backjump from depth " << depth << " to depth " << target << endl;
+            }
+        }
+        if (cbj_frames.empty()) return target;
+    }
+}
+
+// --- Kernel dispatch ---
+
+template <VariableStrategy V, ValueStrategy W, bool FC, bool MAC, bool TRACE>
+CSPSolver::SearchKernels CSPSolver::makeKernels() {
+    return SearchKernels{&CSPSolver::searchStep<V, W, FC, MAC, TRACE>,
+                         &CSPSolver::backtrackCBJ<V, W, FC, MAC, TRACE>};
+}
+
+// Table index: ((((var * 3 + val) * 2 + fc) * 2 + mac) * 2 + trace)
+template <size_t... I>
+array<CSPSolver::SearchKernels, sizeof...(I)> CSPSolver::buildKernelTable(index_sequence<I...>) {
+    return {{makeKernels<static_cast<VariableStrategy>(I / 24),
+                         static_cast<ValueStrategy>(I / 8 % 3),
+                         (I / 4 % 2) != 0, (I / 2 % 2) != 0, (I % 2) != 0>()...}};
+}
+
+const CSPSolver::SearchKernels& CSPSolver::selectKernels(VariableStrategy var_strategy,
+                                                         ValueStrategy val_strategy,
+                                                         bool use_forward_checking,
+                                                         bool ac3_at_each_node, bool trace) {
+    static const auto table = buildKernelTable(make_index_sequence<3 * 3 * 2 * 2 * 2>());
+    size_t index = static_cast<size_t>(var_strategy) * 3 + static_cast<size_t>(val_strategy);
+    index = ((index * 2 + use_forward_checking) * 2 + ac3_at_each_node) * 2 + trace;
+    return table[index];
 }
 
 void CSPSolver::printStats() const {
     cout << "   Backtracking Statistics:" << endl;
     cout << "     Nodes explored: " << nodes_explored << endl;
     cout << "     Backtracks: " << backtracks << endl;
-    cout << "     Solutions found: " << solutions.size() << endl;
+    if (jump_count > 0) {
+        cout << "     Backjumps: " << backjumps << " (max distance: " << max_jump_distance
+             << ", average distance: " << getAverageJumpDistance() << ")" << endl;
+    }
+    cout << "     Solutions found: " << solution_count << endl;
+    cout << "     Nodes per second: " << static_cast<long long>(getNodesPerSecond()) << endl;
+    if (heapAllocationCountEnabled()) {
+        cout << "     Heap allocations during search: " << search_allocations << " ("
+             << (nodes_explored > 0 ? static_cast<double>(search_allocations) / nodes_explored : 0.0)
+             << " per node)" << endl;
+    }
 }
\ No newline at end of file
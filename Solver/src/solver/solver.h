@@ -5,64 +5,316 @@
 #include <vector>
 #include <map>
 #include <chrono>
+#include <memory>
+#include <array>
+#include <utility>
+#include <atomic>
+#include <unordered_map>
 #include "../parser/parser.h"
+#include "../algorithms/nogoods.h"
+#include "../algorithms/interchangeability.h"
+#include "../algorithms/symmetry.h"
+#include "../strategies/strategies.h"
+#include "../core/compiled_model.h"
+#include "../core/assignment.h"
+#include "../core/search_arena.h"
+#include "../core/stats.h"
+#include "../core/progress.h"
+#include "../core/trace_buffer.h"
+#include "../core/params.h"
+#include "checkpoint.h"
 
-// Forward declaration
-class SelectionStrategies;
+class AC3Algorithm;
 
 // Main CSP solver class
 class CSPSolver {
 private:
     CSPInstance csp;
-    std::vector<std::vector<int>> domains;  // Domaines pour chaque variable
-    std::map<int, int> assignment;          // Assignation variable -> valeur
+    std::vector<Domain> domains;            // Domaines pour chaque variable
+    Assignment assignment;                  // Assignation variable -> valeur
     std::vector<std::map<int, int>> solutions; // Solutions trouvées
     
     // Pre-computed static properties
     std::vector<std::vector<int>> var_interaction_graph;
+    std::shared_ptr<const CompiledModel> compiled_model; // Built on first use (LCV support counts) unless shared
+
+    // Search arena of the chronological kernel, sized from the domains when
+    // solve() starts: the nodes themselves do not allocate. Each solver (and
+    // so each decomposition worker) owns its own arena.
+    DomainTrail trail;                      // Removed values, undone on backtrack
+    FixedStack<int> value_stack;            // Value orderings of the open nodes
+    std::unique_ptr<AC3Algorithm> search_ac3; // In-place AC-3 (MAC)
+    
+    // Explicit decision stack of the iterative engine: one frame per open
+    // node, so the search can stop after any number of nodes and resume
+    struct SearchFrame {
+        int var;                // Variable branched on
+        size_t values_begin;    // Ordered values on value_stack
+        size_t value_count;
+        size_t next_value;      // Value iterator
+        size_t node_mark;       // Trail mark before the node's propagation (AC-3)
+        size_t value_mark;      // Trail mark before the current value's FC
+        bool child_open;        // var is assigned and its subtree is being searched
+    };
+    FixedStack<SearchFrame> frames;
+    bool entering_node;                     // A new node must be opened at depth frames.size()
+    std::vector<Domain> root_domains;       // Domains when the search started (checkpoints)
+    
+    // Checkpointing of the chronological search
+    std::string checkpoint_path;             // Empty: no checkpoint
+    int checkpoint_interval;                 // Seconds between two checkpoints
+    const SearchCheckpoint* resume_point;    // Consumed by the next solve()
+    unsigned int random_seed;                // Seed of the random strategies (0: std::random_device)
+    std::string resume_error;                // Why the last resume failed (empty if it did not)
+    unsigned long long resumed_solutions;    // Solutions found before the resume
+    long long resumed_nodes;                 // Nodes explored before the resume
+    long long previous_elapsed_ms;           // Search time before the resume
+
+    // Conflict-directed backjumping (CBJ) state
+    std::vector<int> assigned_order;                 // Variable assigned at each depth
+    std::vector<int> var_depth;                      // Depth of each assigned variable (-1 if unassigned)
+    std::vector<std::vector<int>> conflict_sets;     // Past variables in conflict with each variable
+    std::vector<std::vector<int>> prune_explanations; // Past variables that pruned each domain (FC/AC)
+    ExplanationTrail explanation_trail;              // Growth of prune_explanations, undone with the trail
+    
+    // Open nodes of the CBJ search (values on value_stack, like SearchFrame)
+    struct CBJFrame {
+        int var;
+        size_t values_begin;
+        size_t value_count;
+        size_t next_value;
+        size_t node_mark;               // Trail marks before the node's AC-3
+        size_t node_explanation_mark;
+        size_t value_mark;              // Trail marks before the current value's FC
+        size_t value_explanation_mark;
+        unsigned long long solutions_before;
+    };
+    FixedStack<CBJFrame> cbj_frames;
+    std::unique_ptr<NogoodStore> nogood_store;       // Learned nogoods (null when learning is disabled)
+
+    bool count_only;                        // Count solutions without storing them
+    unsigned long long solution_count;
+    const InterchangeableValues* interchangeable; // Classes merged before the search (null: none)
+    SolutionWeightSum represented_solutions;     // Solutions of the full instance behind the ones found
+    const Symmetries* symmetry;             // Symmetries broken during the search (null: none)
+    std::vector<int> value_uses;            // Value symmetry: assigned variables taking each value
+    int used_values;                        // Values taken by at least one assigned variable
+    long long symmetry_prunings;            // Values removed or refuted by symmetry breaking
 
     // Statistics
-    int nodes_explored;
-    int backtracks;
+    long long nodes_explored;
+    long long search_time_us;
+    unsigned long long search_allocations; // Counted by the alloc-check build only
+    long long backtracks;
+    long long backjumps;        // Non-chronological jumps (distance > 1)
+    int max_jump_distance;
+    long long total_jump_distance;
+    long long jump_count;       // All jumps, chronological ones included
+    int max_depth;              // Deepest node of the search
+    
+    // Work counters since the construction (initial AC-3 included): checks
+    // done by the solver itself, and by the AC-3 runs already finished
+    mutable long long constraint_checks; // Also counted by the const consistency tests
+    long long ac3_checks;
+    long long ac3_revisions;
+    long long wipeouts;
+    std::vector<long long> variable_wipeouts;
+    std::vector<long long> constraint_wipeouts;
+    std::unordered_map<long long, int> constraint_index; // Variable pair -> first constraint on it
+    PhaseTimes* phase_times;    // Per-node phase timers (null: not timed)
+    SearchProgress* progress;   // Published with the clock checks (null: not reported)
+    TraceBuffer* trace_buffer;  // Node events for --trace (null: not recorded)
+    int last_wipeout_var;       // Variable of the last recorded wipeout (trace events)
     bool timeout_occurred;
     std::chrono::high_resolution_clock::time_point start_time;
     
+    // Run-time settings of the current search (the rest is compiled into the kernel)
+    struct SearchConfig {
+        std::chrono::high_resolution_clock::time_point deadline;
+        bool first_solution_only;
+        int max_depth_trace;
+        int max_depth_ac3_trace;
+        bool forward_checking;   // Replayed when a checkpoint is restored
+        std::string options;     // Options that shape the search tree (checkpoint signature)
+    };
+    SearchConfig search_config;
+    
+    // Stop tests of the search loops: the stop flag (a relaxed atomic load)
+    // is read at each node, the clock only every CLOCK_CHECK_NODES nodes,
+    // when the progress is also published
+    static const int CLOCK_CHECK_NODES = 256;
+    const std::atomic<bool>* stop_flag;     // Raised by another thread to cancel (null: none)
+    int clock_countdown;                    // Nodes before the next clock read
+    bool stopRequested() const {
+        return stop_flag && stop_flag->load(std::memory_order_relaxed);
+    }
+    bool deadlineReached() {
+        if (--clock_countdown > 0) return false;
+        clock_countdown = CLOCK_CHECK_NODES;
+        if (progress) publishProgress();
+        if (std::chrono::high_resolution_clock::now() < search_config.deadline) return false;
+        clock_countdown = 1; // Stays reached until setDeadline()
+        return true;
+    }
+    std::unique_ptr<SelectionStrategies> strategies; // Heuristics of the current search
+
+public:
+    // Outcome of step(): the search can always be continued after RUNNING
+    // and SOLUTION, after TIMEOUT once the deadline allows it and after
+    // CANCELLED once the stop flag is lowered
+    enum class SearchStatus { RUNNING, SOLUTION, EXHAUSTED, TIMEOUT, CANCELLED };
+
+private:
+    // Search kernels: one instantiation per heuristic pair and propagation
+    // policy (FC, MAC), with the tracing code compiled in only when TRACE
+    struct SearchKernels {
+        SearchStatus (CSPSolver::*step)(long long budget);
+        int (CSPSolver::*backtrack_cbj)();
+    };
+    const SearchKernels* kernels;           // Selected by initSearch()
+    template <VariableStrategy V, ValueStrategy W, bool FC, bool MAC, bool TRACE>
+    static SearchKernels makeKernels();
+    template <size_t... I>
+    static std::array<SearchKernels, sizeof...(I)> buildKernelTable(std::index_sequence<I...>);
+    static const SearchKernels& selectKernels(VariableStrategy var_strategy, ValueStrategy val_strategy,
+                                              bool use_forward_checking, bool ac3_at_each_node, bool trace);
+    
     // Private methods
     bool isComplete() const;
     bool isConsistent(int var, int value) const;
     bool forwardCheckWithDomainReduction(int var, int value);
     bool validateSolution(const std::map<int, int>& solution) const;
-    void restoreDomains(const std::vector<std::vector<int>>& backup);
-    std::vector<std::vector<int>> backupDomains() const;
-    bool backtrack(int depth, const std::string& var_strategy, const std::string& val_strategy,
-                  bool use_forward_checking, int max_time, bool first_solution_only,
-                  bool verbose, SelectionStrategies& strategies,
-                  bool ac3_at_each_node = true, int max_depth_trace = 5, 
-                  int max_depth_ac3_trace = 3, bool show_global_stats_only = false);
+    void prepareArena();
+    void recordWipeout(int var, int support);
+    void addAC3Counters(const AC3Algorithm& ac3);
+    void publishProgress();
+    size_t domainValueCount() const;
+    void saveCheckpoint(bool finished);
+    void initSearch(const SolverParams& params);
+    
+    // Iterative chronological search: runs until budget nodes are explored
+    // or the search stops (solution, exhausted tree, timeout)
+    template <VariableStrategy V, ValueStrategy W, bool FC, bool MAC, bool TRACE>
+    SearchStatus searchStep(long long budget);
+    
+    // Iterative CBJ search: returns -1 when the search is exhausted,
+    // SEARCH_STOP when it must stop (first solution or timeout)
+    static const int SEARCH_STOP = -2;
+    template <VariableStrategy V, ValueStrategy W, bool FC, bool MAC, bool TRACE>
+    int backtrackCBJ();
+    int findConflictingVariable(int var, int value) const;
+    bool forwardCheckWithExplanations(int var, int value, std::vector<int>& conflict);
+    bool applyAC3WithExplanations(bool verbose, std::vector<int>& conflict);
+    void mergeConflicts(std::vector<int>& target, const std::vector<int>& source, int exclude) const;
+    int jumpBack(int depth, std::vector<int>& conflict);
+    void learnNogood(const std::vector<int>& conflict);
+    
+    // Symmetry breaking in the chronological search
+    size_t keepOneUnusedValue(size_t values_begin, size_t value_count);
+    void useValue(int value);
+    void releaseValue(int value);
+    bool pruneSymmetricValues(int var, int value);
+    
+    // Microbenchmarks of the private kernels (bench/microbench.cpp)
+    friend struct BenchAccess;
     
 public:
     CSPSolver(const CSPInstance& instance);
+    ~CSPSolver();
+    
+    // Main solving method: search options, limits and tracing of params
+    // (the preprocessing options are applied by the caller)
+    bool solve(std::vector<std::map<int, int>>& solutions, const SolverParams& params);
+    
+    // Step-wise chronological search (no CBJ): beginSearch() takes the
+    // options of solve(), then each step() explores at most budget nodes.
+    // Solutions are collected as in solve() (see getSolutions()).
+    void beginSearch(const SolverParams& params);
+    SearchStatus step(long long budget);
     
-    // Main solving method
-    bool solve(std::vector<std::map<int, int>>& solutions,
-              int max_time,
-              bool first_solution_only,
-              const std::string& var_strategy,
-              const std::string& val_strategy,
-              bool use_forward_checking,
-              bool verbose,
-              bool ac3_at_each_node = true,
-              int max_depth_trace = 5,
-              int max_depth_ac3_trace = 3,
-              bool show_global_stats_only = false);
+    // Checkpoints: snapshot of the decision stack and counters, and its
+    // restoration right after beginSearch() with the same options
+    SearchCheckpoint makeCheckpoint(bool finished) const;
+    bool restoreSearch(const SearchCheckpoint& checkpoint, std::string& error);
+    
+    // Used by solve(): periodic checkpoints (and at timeout / the end of the
+    // search), and a checkpoint to resume from
+    void setCheckpointing(const std::string& path, int interval_seconds) {
+        checkpoint_path = path;
+        checkpoint_interval = interval_seconds;
+    }
+    void setResumePoint(const SearchCheckpoint* checkpoint) { resume_point = checkpoint; }
+    const std::string& getResumeError() const { return resume_error; }
+    unsigned long long getResumedSolutionCount() const { return resumed_solutions; }
+    long long getPreviousElapsedMs() const { return previous_elapsed_ms; }
+    int getSearchDepth() const { return static_cast<int>(frames.size()); }
+    const Assignment& getAssignment() const { return assignment; }
+    // Approximate size in bytes of the search state: domains, arena,
+    // constraint graph and the compiled model in use
+    size_t getMemoryUsage() const;
+    
+    // Cooperative cancellation and deadline (the search started by
+    // beginSearch()/solve() ends max_time seconds after its start)
+    void setStopFlag(const std::atomic<bool>* flag) { stop_flag = flag; }
+    void setRandomSeed(unsigned int seed) { random_seed = seed; }
+    void setDeadline(std::chrono::high_resolution_clock::time_point deadline) {
+        search_config.deadline = deadline;
+        clock_countdown = 1;
+    }
+    const std::vector<std::map<int, int>>& getSolutions() const { return solutions; }
     
     // Apply AC-3
     bool applyAC3(bool verbose = true);
     
+    // Apply singleton arc consistency (time-boxed, probes run in parallel)
+    bool applySAC(int num_threads, int max_time_ms, bool verbose = false, bool print_stats = true);
+    
+    // Compiled form of the same instance, shared by several solvers (it is read-only)
+    void setCompiledModel(std::shared_ptr<const CompiledModel> model) { compiled_model = std::move(model); }
+    
+    // Current domains (e.g. after AC-3/SAC) and constraint graph
+    const std::vector<Domain>& getDomains() const { return domains; }
+    void setDomains(const std::vector<Domain>& new_domains) { domains = new_domains; }
+    const std::vector<std::vector<int>>& getInteractionGraph() const { return var_interaction_graph; }
+    
+    // Times of the propagation, selection and value ordering of each node
+    // (--stats-json); without it the search reads no clock for them
+    void setPhaseTimes(PhaseTimes* times) { phase_times = times; }
+    
+    // Counters read by a progress reporter thread (--progress), written
+    // with relaxed stores every CLOCK_CHECK_NODES nodes
+    void setProgress(SearchProgress* search_progress) { progress = search_progress; }
+    
+    // Records every node event of the chronological and CBJ searches in a
+    // buffer drained by a TraceWriter (--trace); one buffer per solver
+    void setTraceBuffer(TraceBuffer* buffer) { trace_buffer = buffer; }
+    
+    // The domains were reduced to class representatives (-I): each solution
+    // found stands for the product of the sizes of its values' classes
+    void setInterchangeableValues(const InterchangeableValues* values) { interchangeable = values; }
+    BigInt getRepresentedSolutionCount() const { return represented_solutions.value(); }
+    
+    // Symmetries broken by the chronological search (-B): each solution
+    // found is canonical and stands for its orbit
+    void setSymmetries(const Symmetries* symmetries) { symmetry = symmetries; }
+    long long getSymmetryPrunings() const { return symmetry_prunings; }
+    
     // Get statistics
-    int getNodesExplored() const { return nodes_explored; }
-    int getBacktracks() const { return backtracks; }
+    unsigned long long getSolutionCount() const { return solution_count; }
+    long long getNodesExplored() const { return nodes_explored; }
+    double getNodesPerSecond() const {
+        return search_time_us > 0 ? (nodes_explored - resumed_nodes) * 1000000.0 / search_time_us : 0.0;
+    }
+    unsigned long long getSearchAllocations() const { return search_allocations; }
+    long long getBacktracks() const { return backtracks; }
+    long long getBackjumps() const { return backjumps; }
+    int getMaxJumpDistance() const { return max_jump_distance; }
+    double getAverageJumpDistance() const {
+        return jump_count > 0 ? static_cast<double>(total_jump_distance) / jump_count : 0.0;
+    }
+    const NogoodStore* getNogoodStore() const { return nogood_store.get(); }
     bool wasTimeout() const { return timeout_occurred; }
+    SearchCounters getCounters() const;
     void printStats() const;
 };
 
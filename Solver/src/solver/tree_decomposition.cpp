@@ -0,0 +1,455 @@
+#include "tree_decomposition.h"
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <tuple>
+
+using namespace std;
+
+// Rough per-record overhead of the hash tables
+static const size_t RECORD_OVERHEAD = 64;
+
+// --- TreeDecomposition ---
+
+TreeDecomposition::TreeDecomposition(const vector<vector<int>>& graph) : width(0) {
+    int n = graph.size();
+    vector<set<int>> adjacency(n);
+    for (int var = 0; var < n; var++) {
+        for (int neighbor : graph[var]) {
+            if (neighbor != var) {
+                adjacency[var].insert(neighbor);
+                adjacency[neighbor].insert(var);
+            }
+        }
+    }
+
+    // Number of edges missing to turn the neighborhood into a clique
+    auto fillIn = [&adjacency](int var) {
+        long long fill = 0;
+        for (auto a = adjacency[var].begin(); a != adjacency[var].end(); ++a) {
+            for (auto b = next(a); b != adjacency[var].end(); ++b) {
+                if (!adjacency[*a].count(*b)) fill++;
+            }
+        }
+        return fill;
+    };
+
+    // Min-fill, ties broken by the smallest degree
+    typedef tuple<long long, size_t, int> Key;
+    set<Key> queue;
+    vector<Key> keys(n);
+    for (int var = 0; var < n; var++) {
+        keys[var] = Key(fillIn(var), adjacency[var].size(), var);
+        queue.insert(keys[var]);
+    }
+
+    clusters.resize(n);
+    vector<int> position(n, -1);
+    while (!queue.empty()) {
+        int var = get<2>(*queue.begin());
+        queue.erase(queue.begin());
+        position[var] = elimination_order.size();
+        elimination_order.push_back(var);
+
+        vector<int> neighbors(adjacency[var].begin(), adjacency[var].end());
+        clusters[var].var = var;
+        clusters[var].separator = neighbors;
+        width = max(width, static_cast<int>(neighbors.size()));
+
+        // The neighborhood becomes a clique and var leaves the graph
+        set<int> dirty;
+        for (int a : neighbors) {
+            adjacency[a].erase(var);
+            dirty.insert(a);
+        }
+        for (size_t i = 0; i < neighbors.size(); i++) {
+            for (size_t j = i + 1; j < neighbors.size(); j++) {
+                if (adjacency[neighbors[i]].insert(neighbors[j]).second) {
+                    adjacency[neighbors[j]].insert(neighbors[i]);
+                }
+            }
+        }
+        for (int a : neighbors) {
+            dirty.insert(adjacency[a].begin(), adjacency[a].end());
+        }
+        for (int u : dirty) {
+            queue.erase(keys[u]);
+            keys[u] = Key(fillIn(u), adjacency[u].size(), u);
+            queue.insert(keys[u]);
+        }
+    }
+
+    // Parent: the separator variable eliminated first
+    for (int var : elimination_order) {
+        TreeCluster& cluster = clusters[var];
+        cluster.parent = -1;
+        for (int s : cluster.separator) {
+            if (cluster.parent == -1 || position[s] < position[cluster.parent]) {
+                cluster.parent = s;
+            }
+        }
+        if (cluster.parent == -1) {
+            roots.push_back(var);
+        } else {
+            clusters[cluster.parent].children.push_back(var);
+        }
+    }
+
+    // Preorder: every cluster comes after its separator
+    for (int root : roots) {
+        vector<int> stack(1, root);
+        while (!stack.empty()) {
+            int var = stack.back();
+            stack.pop_back();
+            search_order.push_back(var);
+            const vector<int>& children = clusters[var].children;
+            for (auto it = children.rbegin(); it != children.rend(); ++it) {
+                stack.push_back(*it);
+            }
+        }
+    }
+}
+
+// --- TreeSolver ---
+
+TreeSolver::TreeSolver(const CompiledModel& compiled, const TreeDecomposition& decomposition,
+                       size_t cache_mb, int time_limit)
+    : model(compiled), tree(decomposition), max_cache_bytes(cache_mb * 1024 * 1024),
+      max_time(time_limit), cache_bytes(0), first_solution_only(false),
+      nodes_explored(0), backtracks(0), record_hits(0), goods_recorded(0),
+      nogoods_recorded(0), counts_recorded(0), timeout(false) {
+    // Subtrees are contiguous in the search order
+    const vector<int>& order = tree.getSearchOrder();
+    order_position.assign(order.size(), 0);
+    subtree_end.assign(order.size(), 0);
+    for (size_t i = order.size(); i-- > 0;) {
+        int var = order[i];
+        order_position[var] = i;
+        subtree_end[var] = i + 1;
+        for (int child : tree.getCluster(var).children) {
+            subtree_end[var] = max(subtree_end[var], subtree_end[child]);
+        }
+    }
+}
+
+bool TreeSolver::solve(vector<DomainBits> initial_domains, bool first_only, bool count_only) {
+    int n = model.getNumVariables();
+    start_time = chrono::steady_clock::now();
+    domains = std::move(initial_domains);
+    values.assign(n, -1);
+    nogoods.assign(n, unordered_set<string>());
+    goods.assign(n, unordered_map<string, vector<int>>());
+    counts.assign(n, unordered_map<string, BigInt>());
+    cache_bytes = 0;
+    first_solution_only = first_only;
+    solutions.clear();
+    solution_count = BigInt(0);
+    nodes_explored = 0;
+    backtracks = 0;
+    record_hits = 0;
+    goods_recorded = 0;
+    nogoods_recorded = 0;
+    counts_recorded = 0;
+    timeout = false;
+
+    for (const DomainBits& domain : domains) {
+        if (countBits(domain) == 0) {
+            return false;
+        }
+    }
+    // On a tree (width 1), DAC along the search order makes it backtrack-free
+    if (!model.enforceDirectionalArcConsistency(domains, tree.getSearchOrder())) {
+        return false;
+    }
+
+    const vector<int>& roots = tree.getRoots();
+    if (count_only) {
+        // The components below the roots are independent
+        solution_count = BigInt(1);
+        for (int root : roots) {
+            solution_count *= countSubtree(root);
+            if (solution_count.isZero() || timeout) {
+                break;
+            }
+        }
+    } else {
+        frames.clear();
+        frames.reserve(n);
+        frame_of.assign(n, -1);
+        search();
+    }
+    return !solution_count.isZero();
+}
+
+// Enumeration along the search order: assigning the variables in this
+// order is what the nested subtree extensions of BTD amount to. A subtree
+// is extended when the search reaches the end of its range; backtracking
+// into an extended subtree in first solution mode means that the rest
+// failed, so the subtree is left at once (its other extensions would leave
+// the rest failing as well).
+bool TreeSolver::search() {
+    const vector<int>& order = tree.getSearchOrder();
+    size_t position = 0; // Next position of the search order to assign
+    bool entering = true;
+
+    while (true) {
+        if (entering) {
+            if (position == order.size()) {
+                if (recordSolution()) {
+                    return true;
+                }
+                entering = false;
+                continue;
+            }
+
+            int var = order[position];
+            string key = separatorKey(var);
+            if (nogoods[var].count(key)) {
+                record_hits++;
+                entering = false;
+                continue;
+            }
+            SearchFrame frame{var, std::move(key), 0, false, false, false};
+            if (first_solution_only) {
+                auto it = goods[var].find(frame.key);
+                if (it != goods[var].end()) {
+                    record_hits++;
+                    for (size_t i = position; i < static_cast<size_t>(subtree_end[var]); i++) {
+                        values[order[i]] = it->second[i - position];
+                    }
+                    frame.from_good = true;
+                    frame.extended = true;
+                    frame_of[var] = frames.size();
+                    frames.push_back(std::move(frame));
+                    position = subtree_end[var];
+                    reachPosition(position);
+                    continue;
+                }
+            }
+            frame_of[var] = frames.size();
+            frames.push_back(std::move(frame));
+            entering = false;
+            continue;
+        }
+
+        // Next value of the deepest open node
+        if (frames.empty()) {
+            return false;
+        }
+        SearchFrame& frame = frames.back();
+        int var = frame.var;
+        if (!frame.from_good && !(first_solution_only && frame.extended)) {
+            if (values[var] >= 0 && !frame.reached) {
+                backtracks++;
+            }
+            int index = nextValue(var, frame.next_value);
+            if (index >= 0) {
+                frame.next_value = index + 1;
+                nodes_explored++;
+                if (checkTimeout()) {
+                    return true;
+                }
+                values[var] = index;
+                frame.reached = false;
+                position = order_position[var] + 1;
+                reachPosition(position);
+                entering = true;
+                continue;
+            }
+            if (!frame.extended && reserveCache(frame.key.size())) {
+                nogoods[var].insert(std::move(frame.key));
+                nogoods_recorded++;
+            }
+        }
+
+        size_t end = frame.from_good ? subtree_end[var] : order_position[var] + 1;
+        for (size_t i = order_position[var]; i < end; i++) {
+            values[order[i]] = -1;
+        }
+        frame_of[var] = -1;
+        frames.pop_back();
+    }
+}
+
+// The subtrees ending just before position are extended: they are the
+// open ancestors of the last variable assigned whose range ends there
+void TreeSolver::reachPosition(size_t position) {
+    const vector<int>& order = tree.getSearchOrder();
+    for (int var = order[position - 1]; var != -1 && static_cast<size_t>(subtree_end[var]) == position;
+         var = tree.getCluster(var).parent) {
+        if (frame_of[var] < 0) {
+            continue;
+        }
+        SearchFrame& frame = frames[frame_of[var]];
+        frame.reached = true;
+        if (frame.extended) {
+            continue;
+        }
+        frame.extended = true;
+        size_t begin = order_position[var];
+        if (first_solution_only && reserveCache(frame.key.size() + (position - begin) * sizeof(int))) {
+            vector<int> subtree_values;
+            subtree_values.reserve(position - begin);
+            for (size_t i = begin; i < position; i++) {
+                subtree_values.push_back(values[order[i]]);
+            }
+            goods[var][frame.key] = std::move(subtree_values);
+            goods_recorded++;
+        }
+    }
+}
+
+// Count of the subtree of root under the current values, the product of
+// the counts of the children summed over the values of each cluster
+BigInt TreeSolver::countSubtree(int root) {
+    vector<CountFrame> stack;
+    BigInt result; // Count of the last subtree closed
+
+    // Opens the subtree of var, unless its count is recorded (in result)
+    auto open = [this, &stack, &result](int var) {
+        string key = separatorKey(var);
+        auto it = counts[var].find(key);
+        if (it != counts[var].end()) {
+            record_hits++;
+            result = it->second;
+            return false;
+        }
+        stack.push_back(CountFrame{var, std::move(key), 0, -1, 0, BigInt(0), BigInt(1)});
+        return true;
+    };
+
+    if (!open(root)) {
+        return result;
+    }
+    while (!stack.empty()) {
+        CountFrame& frame = stack.back();
+        int var = frame.var;
+        const vector<int>& children = tree.getCluster(var).children;
+
+        if (frame.value >= 0) {
+            if (frame.child < children.size() && !frame.product.isZero() && !timeout) {
+                if (!open(children[frame.child])) {
+                    frame.product *= result;
+                    frame.child++;
+                }
+                continue;
+            }
+            values[var] = -1;
+            if (frame.product.isZero()) {
+                backtracks++;
+            }
+            frame.total += frame.product;
+            frame.value = -1;
+        }
+
+        int index = timeout ? -1 : nextValue(var, frame.next_value);
+        if (index >= 0) {
+            frame.next_value = index + 1;
+            nodes_explored++;
+            if (!checkTimeout()) {
+                values[var] = index;
+                frame.value = index;
+                frame.child = 0;
+                frame.product = BigInt(1);
+                continue;
+            }
+        }
+
+        // A partial count must not be reused
+        result = std::move(frame.total);
+        if (!timeout && reserveCache(frame.key.size() + result.memoryUsage())) {
+            counts[var][frame.key] = result;
+            counts_recorded++;
+        }
+        stack.pop_back();
+        if (!stack.empty()) {
+            stack.back().product *= result;
+            stack.back().child++;
+        }
+    }
+    return result;
+}
+
+// Constraints are checked against the neighbors assigned so far
+bool TreeSolver::isConsistent(int var, int index) const {
+    for (int arc_index : model.getArcsFrom(var)) {
+        const CompiledArc& arc = model.getArc(arc_index);
+        int neighbor_value = values[arc.neighbor];
+        if (neighbor_value >= 0 && !testBit(model.supports(arc, index), neighbor_value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// First value index >= from of var consistent with the assigned neighbors
+int TreeSolver::nextValue(int var, int from) const {
+    const DomainBits& domain = domains[var];
+    for (size_t w = from >> 6; w < domain.size(); w++) {
+        uint64_t word = domain[w];
+        if (w == static_cast<size_t>(from >> 6)) {
+            word &= ~0ULL << (from & 63);
+        }
+        while (word) {
+            int index = static_cast<int>(w * 64) + __builtin_ctzll(word);
+            word &= word - 1;
+            if (isConsistent(var, index)) {
+                return index;
+            }
+        }
+    }
+    return -1;
+}
+
+string TreeSolver::separatorKey(int var) const {
+    const vector<int>& separator = tree.getCluster(var).separator;
+    string key;
+    key.reserve(separator.size() * sizeof(int));
+    for (int s : separator) {
+        key.append(reinterpret_cast<const char*>(&values[s]), sizeof(int));
+    }
+    return key;
+}
+
+// Records are simply no longer kept once the memory budget is used
+bool TreeSolver::reserveCache(size_t bytes) {
+    bytes += RECORD_OVERHEAD;
+    if (cache_bytes + bytes > max_cache_bytes) {
+        return false;
+    }
+    cache_bytes += bytes;
+    return true;
+}
+
+bool TreeSolver::recordSolution() {
+    solution_count += BigInt(1);
+    map<int, int> solution;
+    for (int var = 0; var < model.getNumVariables(); var++) {
+        solution[var] = values[var] + model.getOffset(var);
+    }
+    solutions.push_back(solution);
+    return first_solution_only;
+}
+
+bool TreeSolver::checkTimeout() {
+    if (timeout) {
+        return true;
+    }
+    if (max_time > 0 && (nodes_explored & 1023) == 0) {
+        auto elapsed = chrono::duration_cast<chrono::seconds>(chrono::steady_clock::now() - start_time).count();
+        if (elapsed >= max_time) {
+            timeout = true;
+        }
+    }
+    return timeout;
+}
+
+void TreeSolver::printStats() const {
+    cout << "   BTD Statistics:" << endl;
+    cout << "     Width: " << tree.getWidth() << endl;
+    cout << "     Record hits: " << record_hits << endl;
+    cout << "     Goods recorded: " << goods_recorded << endl;
+    cout << "     Nogoods recorded: " << nogoods_recorded << endl;
+    cout << "     Counts recorded: " << counts_recorded << endl;
+    cout << "     Time limit reached: " << (timeout ? "Yes" : "No") << endl;
+}
@@ -0,0 +1,135 @@
+#ifndef TREE_DECOMPOSITION_H
+#define TREE_DECOMPOSITION_H
+
+#include <vector>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
+#include "../core/compiled_model.h"
+#include "../core/bigint.h"
+
+// Cluster of the elimination tree: one variable and its separator, the
+// neighbors it had when it was eliminated (all of them are ancestors)
+struct TreeCluster {
+    int var;
+    int parent;                 // -1 for the root of a connected component
+    std::vector<int> separator; // Sorted
+    std::vector<int> children;
+};
+
+// Tree decomposition of a constraint graph built from a min-fill
+// elimination order. The bag of a cluster is its variable plus its
+// separator; the width is the largest separator.
+class TreeDecomposition {
+private:
+    std::vector<TreeCluster> clusters; // Indexed by variable
+    std::vector<int> elimination_order;
+    std::vector<int> search_order;     // Roots first, each cluster before its subtree
+    std::vector<int> roots;
+    int width;
+
+public:
+    TreeDecomposition(const std::vector<std::vector<int>>& graph);
+
+    const TreeCluster& getCluster(int var) const { return clusters[var]; }
+    const std::vector<int>& getEliminationOrder() const { return elimination_order; }
+    const std::vector<int>& getSearchOrder() const { return search_order; }
+    const std::vector<int>& getRoots() const { return roots; }
+    int getWidth() const { return width; }
+};
+
+// Backtracking with tree decomposition (BTD): variables are assigned along
+// the tree and the subtree below a cluster only depends on the values of
+// its separator. Outcomes are recorded per separator assignment: nogoods
+// (no extension), goods (one extension, first solution mode) and counts
+// (count mode), so the search is exponential in the width only. Both
+// searches keep their open nodes on explicit stacks, so deep trees (long
+// chains, many independent variables) do not grow the call stack.
+class TreeSolver {
+private:
+    // Open node of the search: one variable of the search order, or its
+    // whole subtree when it was restored from a good
+    struct SearchFrame {
+        int var;
+        std::string key;   // Separator values when the subtree was entered
+        int next_value;    // First value index not tried yet
+        bool from_good;
+        bool extended;     // The subtree was extended under this separator
+        bool reached;      // The current value reached the end of the subtree
+    };
+
+    // Open node of the counting search
+    struct CountFrame {
+        int var;
+        std::string key;
+        int next_value;
+        int value;         // Current value index (-1 between two values)
+        size_t child;      // Next child to count for the current value
+        BigInt total;      // Sum over the values done so far
+        BigInt product;    // Product over the children counted so far
+    };
+
+    const CompiledModel& model;
+    const TreeDecomposition& tree;
+    size_t max_cache_bytes;
+    int max_time;
+    std::chrono::steady_clock::time_point start_time;
+
+    std::vector<DomainBits> domains;
+    std::vector<int> values;              // Value index of each variable (-1 = unassigned)
+    std::vector<int> order_position;      // Position of each variable in the search order
+    std::vector<int> subtree_end;         // Subtree of v = search order [order_position[v], subtree_end[v])
+
+    // Records per cluster, keyed by the separator values
+    std::vector<std::unordered_set<std::string>> nogoods;
+    std::vector<std::unordered_map<std::string, std::vector<int>>> goods; // Subtree values
+    std::vector<std::unordered_map<std::string, BigInt>> counts;
+    size_t cache_bytes;
+
+    bool first_solution_only;
+    std::vector<std::map<int, int>> solutions;
+    BigInt solution_count;
+
+    // Statistiques
+    long long nodes_explored;
+    long long backtracks;
+    long long record_hits;
+    long long goods_recorded;
+    long long nogoods_recorded;
+    long long counts_recorded;
+    bool timeout;
+
+    std::vector<SearchFrame> frames;
+    std::vector<int> frame_of;            // Frame of each open variable (-1 = none)
+
+    bool search();
+    void reachPosition(size_t position);
+    BigInt countSubtree(int root);
+
+    bool isConsistent(int var, int index) const;
+    int nextValue(int var, int from) const;
+    std::string separatorKey(int var) const;
+    bool reserveCache(size_t bytes);
+    bool recordSolution();
+    bool checkTimeout();
+
+public:
+    TreeSolver(const CompiledModel& compiled, const TreeDecomposition& decomposition,
+               size_t cache_mb = 256, int time_limit = 0);
+
+    // Search from the given domains. Count mode only counts; otherwise the
+    // solutions (or the first one) are stored. Returns true if there is a solution.
+    bool solve(std::vector<DomainBits> initial_domains, bool first_only, bool count_only);
+
+    const std::vector<std::map<int, int>>& getSolutions() const { return solutions; }
+    const BigInt& getSolutionCount() const { return solution_count; }
+    long long getNodesExplored() const { return nodes_explored; }
+    long long getBacktracks() const { return backtracks; }
+    bool wasTimeout() const { return timeout; }
+
+    void printStats() const;
+};
+
+#endif // TREE_DECOMPOSITION_H
@@ -4,43 +4,102 @@
 #include <iostream>
 #include <climits>
 #include <limits>
+#include <sstream>
 
 using namespace std;
 
 SelectionStrategies::SelectionStrategies(const CSPInstance& csp_instance, 
-                                       const std::vector<std::vector<int>>& current_domains,
-                                       const std::map<int, int>& current_assignment,
-                                       const std::vector<std::vector<int>>& graph)
+                                       const std::vector<Domain>& current_domains,
+                                       const Assignment& current_assignment,
+                                       const std::vector<std::vector<int>>& graph,
+                                       const CompiledModel* compiled_model)
     : csp(csp_instance), 
       domains(current_domains), 
       assignment(current_assignment),
       var_interaction_graph(graph),
-      rng(std::random_device{}()) {}
+      model(compiled_model),
+      rng(std::random_device{}()) {
+    size_t max_domain_size = 0;
+    for (const auto& domain : domains) {
+        max_domain_size = max(max_domain_size, domain.size());
+    }
+    value_conflicts.reserve(max_domain_size);
+    unassigned_vars.reserve(csp.num_variables);
+
+    if (model) {
+        size_t max_arcs = 0;
+        size_t max_words = 0;
+        for (int var = 0; var < model->getNumVariables(); var++) {
+            max_arcs = max(max_arcs, model->getArcsFrom(var).size());
+            max_words = max(max_words, static_cast<size_t>((model->getSize(var) + 63) / 64));
+        }
+        neighbor_bits.resize(max_arcs);
+        for (auto& bits : neighbor_bits) {
+            bits.reserve(max_words);
+        }
+    }
+}
+
+VariableStrategy parseVariableStrategy(const string& name) {
+    if (name == "degree") {
+        return VariableStrategy::DEGREE;
+    } else if (name == "random") {
+        return VariableStrategy::RANDOM;
+    }
+    // Default to MRV
+    return VariableStrategy::MRV;
+}
+
+ValueStrategy parseValueStrategy(const string& name) {
+    if (name == "lcv") {
+        return ValueStrategy::LCV;
+    } else if (name == "random") {
+        return ValueStrategy::RANDOM;
+    }
+    // Default to lexicographic
+    return ValueStrategy::LEXICOGRAPHIC;
+}
+
+bool isVariableStrategy(const string& name) {
+    return name == "mrv" || name == "degree" || name == "random";
+}
+
+bool isValueStrategy(const string& name) {
+    return name == "lcv" || name == "random" || name == "lexicographic";
+}
+
+string SelectionStrategies::getRngState() const {
+    ostringstream out;
+    out << rng;
+    return out.str();
+}
+
+bool SelectionStrategies::setRngState(const string& state) {
+    istringstream in(state);
+    mt19937 restored;
+    if (!(in >> restored)) {
+        return false;
+    }
+    rng = restored;
+    return true;
+}
 
 // Main function for variable selection
 int SelectionStrategies::selectVariable(const string& strategy) const {
-    if (strategy == "mrv") {
-        return mrvHeuristic();
-    } else if (strategy == "degree") {
-        return degreeHeuristic();
-    } else if (strategy == "random") {
-        return randomVariable();
+    switch (parseVariableStrategy(strategy)) {
+        case VariableStrategy::DEGREE: return selectVariable<VariableStrategy::DEGREE>();
+        case VariableStrategy::RANDOM: return selectVariable<VariableStrategy::RANDOM>();
+        default: return selectVariable<VariableStrategy::MRV>();
     }
-    // Default to MRV
-    return mrvHeuristic();
 }
 
 // Main function for value ordering
 vector<int> SelectionStrategies::orderValues(int var, const string& strategy) const {
-    if (strategy == "lcv") {
-        return lcvHeuristic(var);
-    } else if (strategy == "random") {
-        return randomValues(var);
-    } else if (strategy == "lexicographic") {
-        return lexicographicValues(var);
+    switch (parseValueStrategy(strategy)) {
+        case ValueStrategy::LCV: return orderValues<ValueStrategy::LCV>(var);
+        case ValueStrategy::RANDOM: return orderValues<ValueStrategy::RANDOM>(var);
+        default: return orderValues<ValueStrategy::LEXICOGRAPHIC>(var);
     }
-    // Default to lexicographic
-    return lexicographicValues(var);
 }
 
 
@@ -51,7 +110,7 @@ int SelectionStrategies::mrvHeuristic() const {
     size_t min_domain_size = std::numeric_limits<size_t>::max();
 
     for (int i = 0; i < csp.num_variables; i++) {
-        if (assignment.find(i) == assignment.end()) { // Unassigned
+        if (!assignment.isAssigned(i)) { // Unassigned
             if (domains[i].size() < min_domain_size) {
                 min_domain_size = domains[i].size();
                 selected_var = i;
@@ -66,7 +125,7 @@ int SelectionStrategies::degreeHeuristic() const {
     int max_degree = -1;
 
     for (int i = 0; i < csp.num_variables; i++) {
-        if (assignment.find(i) == assignment.end()) { // Unassigned
+        if (!assignment.isAssigned(i)) { // Unassigned
             int degree = var_interaction_graph[i].size();
             if (degree > max_degree) {
                 max_degree = degree;
@@ -78,9 +137,9 @@ int SelectionStrategies::degreeHeuristic() const {
 }
 
 int SelectionStrategies::randomVariable() const {
-    std::vector<int> unassigned_vars;
+    unassigned_vars.clear();
     for (int i = 0; i < csp.num_variables; i++) {
-        if (assignment.find(i) == assignment.end()) {
+        if (!assignment.isAssigned(i)) {
             unassigned_vars.push_back(i);
         }
     }
@@ -97,16 +156,7 @@ int SelectionStrategies::randomVariable() const {
 // --- Value Ordering Heuristics ---
 
 vector<int> SelectionStrategies::lcvHeuristic(int var) const {
-    std::vector<pair<int, int>> value_conflicts;
-    for (int value : domains[var]) {
-        value_conflicts.push_back({value, countConflicts(var, value)});
-    }
-
-    std::sort(value_conflicts.begin(), value_conflicts.end(), 
-              [](const pair<int, int>& a, const pair<int, int>& b) {
-        return a.second < b.second;
-    });
-
+    rankByConflicts(var);
     std::vector<int> sorted_values;
     for (const auto& pair : value_conflicts) {
         sorted_values.push_back(pair.first);
@@ -115,25 +165,39 @@ vector<int> SelectionStrategies::lcvHeuristic(int var) const {
 }
 
 vector<int> SelectionStrategies::randomValues(int var) const {
-    vector<int> values = domains[var];
+    vector<int> values = domains[var].values();
     std::shuffle(values.begin(), values.end(), rng);
     return values;
 }
 
 vector<int> SelectionStrategies::lexicographicValues(int var) const {
-    vector<int> values = domains[var];
-    // The domains are already sorted from initialization, but let's be safe.
-    std::sort(values.begin(), values.end());
-    return values;
+    // Domains iterate in increasing order
+    return domains[var].values();
 }
 
 
 // --- LCV Helper ---
 
+void SelectionStrategies::rankByConflicts(int var) const {
+    if (model) {
+        countConflictsWithBits(var);
+    } else {
+        value_conflicts.clear();
+        for (int value : domains[var]) {
+            value_conflicts.push_back({value, countConflicts(var, value)});
+        }
+    }
+
+    std::sort(value_conflicts.begin(), value_conflicts.end(), 
+              [](const pair<int, int>& a, const pair<int, int>& b) {
+        return a.second < b.second;
+    });
+}
+
 int SelectionStrategies::countConflicts(int var, int value) const {
     int conflicts = 0;
     for (int neighbor : var_interaction_graph[var]) {
-        if (assignment.find(neighbor) == assignment.end()) { // Unassigned
+        if (!assignment.isAssigned(neighbor)) { // Unassigned
             for (int neighbor_value : domains[neighbor]) {
                 if (!csp.isConsistent(var, value, neighbor, neighbor_value)) {
                     conflicts++;
@@ -142,4 +206,39 @@ int SelectionStrategies::countConflicts(int var, int value) const {
         }
     }
     return conflicts;
-}
\ No newline at end of file
+}
+
+// Same counts as countConflicts, from the compiled support rows: the
+// conflicts of var=value with a neighbor are the neighbor's values missing
+// from the row, i.e. |D(neighbor)| - popcount(row & D(neighbor))
+void SelectionStrategies::countConflictsWithBits(int var) const {
+    const vector<int>& arcs = model->getArcsFrom(var);
+    // neighbor_bits holds one row per arc of the densest variable
+    for (size_t i = 0; i < arcs.size(); i++) {
+        int neighbor = model->getArc(arcs[i]).neighbor;
+        DomainBits& bits = neighbor_bits[i];
+        bits.assign((model->getSize(neighbor) + 63) / 64, 0);
+        if (assignment.isAssigned(neighbor)) {
+            continue; // Assigned: no conflict counted
+        }
+        int offset = model->getOffset(neighbor);
+        for (int neighbor_value : domains[neighbor]) {
+            int index = neighbor_value - offset;
+            bits[index >> 6] |= 1ULL << (index & 63);
+        }
+    }
+
+    value_conflicts.clear();
+    int offset = model->getOffset(var);
+    for (int value : domains[var]) {
+        int conflicts = 0;
+        for (size_t i = 0; i < arcs.size(); i++) {
+            const DomainBits& bits = neighbor_bits[i];
+            const uint64_t* row = model->supports(model->getArc(arcs[i]), value - offset);
+            for (size_t w = 0; w < bits.size(); w++) {
+                conflicts += __builtin_popcountll(bits[w] & ~row[w]);
+            }
+        }
+        value_conflicts.push_back({value, conflicts});
+    }
+}
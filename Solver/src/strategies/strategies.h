@@ -6,16 +6,38 @@
 #include <map>
 #include <random>
 #include <chrono>
+#include <algorithm>
 #include "../parser/parser.h"
+#include "../core/compiled_model.h"
+#include "../core/assignment.h"
+#include "../core/search_arena.h"
+
+// Heuristiques disponibles (résolues une fois, avant la recherche)
+enum class VariableStrategy { MRV, DEGREE, RANDOM };
+enum class ValueStrategy { LCV, RANDOM, LEXICOGRAPHIC };
+
+// Strategy names as given on the command line ("mrv", "lcv", ...).
+// Unknown names fall back to MRV and lexicographic ordering.
+VariableStrategy parseVariableStrategy(const std::string& name);
+ValueStrategy parseValueStrategy(const std::string& name);
+// Exact names, for the interfaces that reject unknown ones
+bool isVariableStrategy(const std::string& name);
+bool isValueStrategy(const std::string& name);
 
 // Class for variable and value selection strategies
 class SelectionStrategies {
 private:
     const CSPInstance& csp;
-    const std::vector<std::vector<int>>& domains;
-    const std::map<int, int>& assignment;
+    const std::vector<Domain>& domains;
+    const Assignment& assignment;
     const std::vector<std::vector<int>>& var_interaction_graph; // Constraint graph
+    const CompiledModel* model; // Support matrices for LCV (optional)
     mutable std::mt19937 rng; // Mutable for random number generation in const methods
+    // Scratch space, sized once in the constructor: the heuristics do not
+    // allocate during the search
+    mutable std::vector<DomainBits> neighbor_bits;
+    mutable std::vector<std::pair<int, int>> value_conflicts;
+    mutable std::vector<int> unassigned_vars;
     
     // Heuristics for variable selection
     int mrvHeuristic() const;
@@ -27,20 +49,77 @@ private:
     std::vector<int> randomValues(int var) const;
     std::vector<int> lexicographicValues(int var) const;
 
-    // For LCV
+    // For LCV: (value, conflicts) of var sorted by conflicts in value_conflicts
+    void rankByConflicts(int var) const;
     int countConflicts(int var, int value) const;
+    void countConflictsWithBits(int var) const;
     
 public:
     SelectionStrategies(const CSPInstance& csp_instance, 
-                        const std::vector<std::vector<int>>& current_domains,
-                        const std::map<int, int>& current_assignment,
-                        const std::vector<std::vector<int>>& graph);
+                        const std::vector<Domain>& current_domains,
+                        const Assignment& current_assignment,
+                        const std::vector<std::vector<int>>& graph,
+                        const CompiledModel* compiled_model = nullptr);
+    
+    // State of the random generator (checkpoints of random strategies)
+    std::string getRngState() const;
+    bool setRngState(const std::string& state);
+    // Fixed seed, for reproducible runs of the random strategies
+    void seed(unsigned int value) { rng.seed(value); }
     
     // Variable selection
     int selectVariable(const std::string& strategy) const;
     
     // Value ordering
     std::vector<int> orderValues(int var, const std::string& strategy) const;
+    
+    // Same heuristics chosen at compile time (search kernels)
+    template <VariableStrategy S>
+    int selectVariable() const {
+        if constexpr (S == VariableStrategy::DEGREE) {
+            return degreeHeuristic();
+        } else if constexpr (S == VariableStrategy::RANDOM) {
+            return randomVariable();
+        } else {
+            return mrvHeuristic();
+        }
+    }
+    
+    template <ValueStrategy S>
+    std::vector<int> orderValues(int var) const {
+        if constexpr (S == ValueStrategy::LCV) {
+            return lcvHeuristic(var);
+        } else if constexpr (S == ValueStrategy::RANDOM) {
+            return randomValues(var);
+        } else {
+            return lexicographicValues(var);
+        }
+    }
+    
+    // Same orderings pushed on a preallocated stack; returns the number of values
+    template <ValueStrategy S>
+    size_t orderValues(int var, FixedStack<int>& out) const {
+        const Domain& domain = domains[var];
+        size_t begin = out.size();
+        if constexpr (S == ValueStrategy::LCV) {
+            rankByConflicts(var);
+            for (const auto& ranked : value_conflicts) {
+                out.push(ranked.first);
+            }
+        } else {
+            // Domains iterate in increasing order: lexicographic needs no sort
+            for (int value : domain) {
+                out.push(value);
+            }
+            if constexpr (S == ValueStrategy::RANDOM) {
+                if (!domain.empty()) {
+                    int* values = &out[begin];
+                    std::shuffle(values, values + domain.size(), rng);
+                }
+            }
+        }
+        return domain.size();
+    }
 };
 
 #endif // STRATEGIES_H
@@ -0,0 +1,777 @@
+// Native generator of the instance families of instances/generator.ipynb,
+// generate_nqueens.py and generate_nrooks.py, plus graph coloring and the
+// job-shop horizon encoding of the report, for stress-testing the parser
+// and the solver at sizes the Python scripts cannot reach. Instances are
+// streamed to the output through a large buffer, as text (.csp, same
+// layout as the scripts) or in the binary format of src/parser/parser.h.
+//
+//   cpgen <family> [options] [-o out.csp] [--binary] [--seed s]
+//
+//   inequality | equality | sum_even | sum_odd | greater_than
+//                 -n vars -d domain -m constraints
+//   sum_target    -n vars -d domain -m constraints [--target t]  (default: 2d)
+//   random        -n vars -d domain -m constraints [--density p]  (default: 0.5)
+//   nqueens       -n N
+//   nrooks        -n N
+//   coloring      -n vertices -m edges -k colors | --col graph.col -k colors
+//   jssp          --jobs J --machines M [--max-duration p] --horizon K
+//                 | --jssp-file instance.txt --horizon K
+//
+// The variable pairs of a constraint are distinct and drawn uniformly, as
+// random.sample does in the notebook; the same seed gives the same file.
+// The JSSP file is in the OR-Library layout: "jobs machines", then one line
+// per job of (machine, duration) pairs in processing order.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <unordered_set>
+#include <algorithm>
+#include <chrono>
+#include <charconv>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include "../src/parser/parser.h"
+
+using namespace std;
+
+namespace {
+
+struct Options {
+    string family;
+    string output;          // Empty: standard output
+    bool binary = false;
+    uint64_t seed = 1;
+    long long variables = 0;
+    long long domain = 0;
+    long long constraints = 0;
+    long long target = 0;
+    double density = 0.5;
+    int colors = 0;
+    string col_file;
+    int jobs = 0;
+    int machines = 0;
+    int max_duration = 99;
+    int horizon = 0;
+    string jssp_file;
+};
+
+void printUsage() {
+    cerr << "Usage: cpgen <family> [options] [-o out.csp] [--binary] [--seed s]" << endl;
+    cerr << "  inequality | equality | sum_even | sum_odd | greater_than  -n vars -d domain -m constraints" << endl;
+    cerr << "  sum_target  -n vars -d domain -m constraints [--target t]  (default: 2d)" << endl;
+    cerr << "  random      -n vars -d domain -m constraints [--density p]  (default: 0.5)" << endl;
+    cerr << "  nqueens     -n N" << endl;
+    cerr << "  nrooks      -n N" << endl;
+    cerr << "  coloring    -n vertices -m edges -k colors | --col graph.col -k colors" << endl;
+    cerr << "  jssp        --jobs J --machines M [--max-duration p] --horizon K" << endl;
+    cerr << "              | --jssp-file instance.txt --horizon K" << endl;
+    cerr << "Options:" << endl;
+    cerr << "  -o <file>   Output file (default: standard output)" << endl;
+    cerr << "  --binary    Binary instance, read by CPSolver like a .csp file" << endl;
+    cerr << "  --seed <s>  Random seed (default: 1)" << endl;
+}
+
+bool isPairFamily(const string& family) {
+    return family == "inequality" || family == "equality" || family == "sum_target" || family == "sum_even" ||
+           family == "sum_odd" || family == "greater_than" || family == "random";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    if (argc < 2) {
+        printUsage();
+        return false;
+    }
+    options.family = argv[1];
+    if (!isPairFamily(options.family) && options.family != "nqueens" && options.family != "nrooks" &&
+        options.family != "coloring" && options.family != "jssp") {
+        cerr << "Unknown family: " << options.family << endl;
+        printUsage();
+        return false;
+    }
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "-o" && has_value) {
+            options.output = argv[++i];
+        } else if (arg == "--binary") {
+            options.binary = true;
+        } else if (arg == "--seed" && has_value) {
+            options.seed = stoull(argv[++i]);
+        } else if (arg == "-n" && has_value) {
+            options.variables = stoll(argv[++i]);
+        } else if (arg == "-d" && has_value) {
+            options.domain = stoll(argv[++i]);
+        } else if (arg == "-m" && has_value) {
+            options.constraints = stoll(argv[++i]);
+        } else if (arg == "-k" && has_value) {
+            options.colors = stoi(argv[++i]);
+        } else if (arg == "--target" && has_value) {
+            options.target = stoll(argv[++i]);
+        } else if (arg == "--density" && has_value) {
+            options.density = stod(argv[++i]);
+        } else if (arg == "--col" && has_value) {
+            options.col_file = argv[++i];
+        } else if (arg == "--jobs" && has_value) {
+            options.jobs = stoi(argv[++i]);
+        } else if (arg == "--machines" && has_value) {
+            options.machines = stoi(argv[++i]);
+        } else if (arg == "--max-duration" && has_value) {
+            options.max_duration = stoi(argv[++i]);
+        } else if (arg == "--horizon" && has_value) {
+            options.horizon = stoi(argv[++i]);
+        } else if (arg == "--jssp-file" && has_value) {
+            options.jssp_file = argv[++i];
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            printUsage();
+            return false;
+        }
+    }
+
+    const string& family = options.family;
+    string error;
+    if (isPairFamily(family)) {
+        if (options.variables < 2) error = "-n must be at least 2";
+        else if (options.domain < 1) error = "-d must be at least 1";
+        else if (options.constraints < 0) error = "-m must be positive";
+        else if (family == "random" && (options.density <= 0.0 || options.density > 1.0)) error = "--density must be in ]0, 1]";
+    } else if (family == "nqueens" || family == "nrooks") {
+        if (options.variables < 1) error = "-n must be at least 1";
+    } else if (family == "coloring") {
+        if (options.colors < 1) error = "-k must be at least 1";
+        else if (options.col_file.empty() && options.variables < 2) error = "-n must be at least 2 (or --col)";
+    } else if (family == "jssp") {
+        if (options.horizon < 1) error = "--horizon is required";
+        else if (options.jssp_file.empty() && (options.jobs < 1 || options.machines < 1)) error = "--jobs and --machines are required (or --jssp-file)";
+        else if (options.max_duration < 1) error = "--max-duration must be at least 1";
+    }
+    if (options.variables > INT32_MAX || options.domain > INT32_MAX / 2 || options.constraints > UINT32_MAX) {
+        error = "sizes must fit in 32 bits";
+    }
+    if (!error.empty()) {
+        cerr << "Error: " << error << endl;
+        return false;
+    }
+    return true;
+}
+
+// splitmix64: several times faster than mt19937_64 for the billions of
+// draws of large random relations, and enough for instance generation
+struct Random {
+    using result_type = uint64_t;
+    uint64_t state;
+
+    explicit Random(uint64_t seed) : state(seed) {}
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return UINT64_MAX; }
+    uint64_t operator()() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+};
+
+// Allowed pairs of one constraint, with their text form cached when the
+// same relation is written many times
+struct Relation {
+    vector<int32_t> values;     // v1, v2, v1, v2, ...
+    string text;                // " (v1,v2) (v1,v2) ..."
+
+    size_t size() const { return values.size() / 2; }
+    void clear() {
+        values.clear();
+        text.clear();
+    }
+    void add(int a, int b) {
+        values.push_back(a);
+        values.push_back(b);
+    }
+};
+
+// Buffered writer of the text or binary layout
+class InstanceWriter {
+private:
+    FILE* file;
+    bool binary;
+    vector<char> buffer;
+    size_t used;
+    unsigned long long bytes;
+    unsigned long long tuples;
+    long long constraints;
+    vector<vector<LiteralImage>> symmetries; // Binary layout: written after the constraints
+
+    void flush() {
+        if (used > 0) {
+            fwrite(buffer.data(), 1, used, file);
+            bytes += used;
+            used = 0;
+        }
+    }
+    void put(const char* data, size_t size) {
+        if (used + size > buffer.size()) {
+            flush();
+            if (size > buffer.size()) {
+                fwrite(data, 1, size, file);
+                bytes += size;
+                return;
+            }
+        }
+        memcpy(buffer.data() + used, data, size);
+        used += size;
+    }
+    void put(const string& text) { put(text.data(), text.size()); }
+    void putChar(char c) {
+        if (used == buffer.size()) flush();
+        buffer[used++] = c;
+    }
+    void putInt(long long value) {
+        if (used + 24 > buffer.size()) flush();
+        used = to_chars(buffer.data() + used, buffer.data() + buffer.size(), value).ptr - buffer.data();
+    }
+    void putInt32(int32_t value) { put(reinterpret_cast<const char*>(&value), sizeof(value)); }
+
+public:
+    InstanceWriter(FILE* output, bool binary_format)
+        : file(output), binary(binary_format), buffer(1 << 22), used(0), bytes(0), tuples(0), constraints(0) {}
+
+    static void buildText(Relation& relation) {
+        relation.text.clear();
+        char number[16];
+        for (size_t i = 0; i < relation.values.size(); i += 2) {
+            relation.text += " (";
+            relation.text.append(number, to_chars(number, number + sizeof(number), relation.values[i]).ptr);
+            relation.text += ',';
+            relation.text.append(number, to_chars(number, number + sizeof(number), relation.values[i + 1]).ptr);
+            relation.text += ')';
+        }
+    }
+
+    // Header comments, declared symmetries, number of variables and domains;
+    // the text layout keeps the blank lines the parser expects between the
+    // sections
+    void variables(const vector<string>& comments, int count, const vector<pair<int, int>>& domains,
+                   const vector<vector<LiteralImage>>& declared_symmetries = {}) {
+        if (binary) {
+            symmetries = declared_symmetries;
+            put(CSP_BINARY_MAGIC, sizeof(CSP_BINARY_MAGIC));
+            putInt32(count);
+            for (const auto& domain : domains) {
+                putInt32(domain.first);
+                putInt32(domain.second);
+            }
+            return;
+        }
+        for (const string& comment : comments) {
+            put("# " + comment + "\n");
+        }
+        for (const auto& symmetry : declared_symmetries) {
+            put("# symmetry");
+            for (const LiteralImage& image : symmetry) {
+                put(" (", 2);
+                putInt(image.var);
+                putChar(',');
+                putInt(image.value);
+                put(")->(", 4);
+                putInt(image.image_var);
+                putChar(',');
+                putInt(image.image_value);
+                putChar(')');
+            }
+            putChar('\n');
+        }
+        putChar('\n');
+        putInt(count);
+        put("\n\n# Variable domains (variable_id min_value max_value)\n");
+        for (int var = 0; var < count; var++) {
+            putInt(var);
+            putChar(' ');
+            putInt(domains[var].first);
+            putChar(' ');
+            putInt(domains[var].second);
+            putChar('\n');
+        }
+        putChar('\n');
+    }
+
+    void constraintCount(long long count) {
+        if (binary) {
+            putInt32(static_cast<int32_t>(static_cast<uint32_t>(count)));
+            return;
+        }
+        putInt(count);
+        put("\n\n# Constraints (var1 var2 (value1,value2) (value3,value4) ...)\n");
+    }
+
+    // cache_text: keep the text of the relation for the next constraints
+    void constraint(int var1, int var2, Relation& relation, bool cache_text) {
+        constraints++;
+        tuples += relation.size();
+        if (binary) {
+            putInt32(var1);
+            putInt32(var2);
+            putInt32(static_cast<int32_t>(relation.size()));
+            put(reinterpret_cast<const char*>(relation.values.data()), relation.values.size() * sizeof(int32_t));
+            return;
+        }
+        putInt(var1);
+        putChar(' ');
+        putInt(var2);
+        if (cache_text) {
+            if (relation.text.empty() && !relation.values.empty()) buildText(relation);
+            put(relation.text);
+        } else {
+            for (size_t i = 0; i < relation.values.size(); i += 2) {
+                put(" (", 2);
+                putInt(relation.values[i]);
+                putChar(',');
+                putInt(relation.values[i + 1]);
+                putChar(')');
+            }
+        }
+        putChar('\n');
+    }
+
+    // Writes the symmetry section of the binary layout and flushes the
+    // buffer; false on a write error
+    bool finish() {
+        if (binary) {
+            putInt32(static_cast<int32_t>(symmetries.size()));
+            for (const auto& symmetry : symmetries) {
+                putInt32(static_cast<int32_t>(symmetry.size()));
+                for (const LiteralImage& image : symmetry) {
+                    putInt32(image.var);
+                    putInt32(image.value);
+                    putInt32(image.image_var);
+                    putInt32(image.image_value);
+                }
+            }
+        }
+        flush();
+        return fflush(file) == 0 && !ferror(file);
+    }
+
+    bool isBinary() const { return binary; }
+    unsigned long long getBytes() const { return bytes; }
+    unsigned long long getTuples() const { return tuples; }
+    long long getConstraints() const { return constraints; }
+};
+
+vector<pair<int, int>> sameDomains(int count, int min_value, int max_value) {
+    return vector<pair<int, int>>(count, make_pair(min_value, max_value));
+}
+
+// count distinct pairs (i, j), i < j < n, in random order
+vector<pair<int, int>> samplePairs(int n, long long count, Random& rng) {
+    long long total = static_cast<long long>(n) * (n - 1) / 2;
+    vector<pair<int, int>> pairs;
+    if (count * 2 > total) {
+        // Dense: shuffle the first count pairs of the full list
+        pairs.reserve(total);
+        for (int i = 0; i < n; i++) {
+            for (int j = i + 1; j < n; j++) {
+                pairs.emplace_back(i, j);
+            }
+        }
+        for (long long k = 0; k < count; k++) {
+            uniform_int_distribution<long long> pick(k, total - 1);
+            swap(pairs[k], pairs[pick(rng)]);
+        }
+        pairs.resize(count);
+        return pairs;
+    }
+    // Sparse: rejection of the pairs already drawn
+    pairs.reserve(count);
+    unordered_set<uint64_t> seen;
+    seen.reserve(count * 2);
+    uniform_int_distribution<int> pick(0, n - 1);
+    while (static_cast<long long>(pairs.size()) < count) {
+        int i = pick(rng);
+        int j = pick(rng);
+        if (i == j) continue;
+        if (i > j) swap(i, j);
+        if (seen.insert(static_cast<uint64_t>(i) << 32 | static_cast<uint32_t>(j)).second) {
+            pairs.emplace_back(i, j);
+        }
+    }
+    return pairs;
+}
+
+template <typename Allowed>
+void fillRelation(Relation& relation, int domain, Allowed allowed) {
+    relation.clear();
+    for (int a = 1; a <= domain; a++) {
+        for (int b = 1; b <= domain; b++) {
+            if (allowed(a, b)) relation.add(a, b);
+        }
+    }
+}
+
+// Families of the notebook: one relation over 1..d for every sampled pair
+void generatePairFamily(const Options& options, InstanceWriter& writer, Random& rng) {
+    int n = static_cast<int>(options.variables);
+    int d = static_cast<int>(options.domain);
+    long long max_constraints = static_cast<long long>(n) * (n - 1) / 2;
+    long long m = options.constraints;
+    if (m > max_constraints) {
+        cerr << "Warning: reducing the number of constraints from " << m << " to " << max_constraints << endl;
+        m = max_constraints;
+    }
+    vector<pair<int, int>> scopes = samplePairs(n, m, rng);
+
+    writer.variables({"CSP with " + options.family + " constraints", "Generated CSP instance",
+                      "Variables: " + to_string(n) + ", Domain size: " + to_string(d),
+                      "Constraints: " + to_string(m)},
+                     n, sameDomains(n, 1, d));
+    writer.constraintCount(m);
+
+    const string& family = options.family;
+    Relation relation;
+    if (family == "random") {
+        // Floyd's sampling of round(d² × density) of the d² pairs, written in order
+        long long cells = static_cast<long long>(d) * d;
+        long long count = max(1LL, llround(cells * options.density));
+        vector<char> chosen(cells);
+        // Text of each pair, so that a relation is written by concatenation
+        vector<string> cell_text;
+        if (!writer.isBinary() && cells <= (1 << 22)) {
+            cell_text.resize(cells);
+            for (long long cell = 0; cell < cells; cell++) {
+                cell_text[cell] = " (" + to_string(cell / d + 1) + "," + to_string(cell % d + 1) + ")";
+            }
+        }
+        for (const auto& scope : scopes) {
+            fill(chosen.begin(), chosen.end(), 0);
+            for (long long j = cells - count; j < cells; j++) {
+                // Multiply-shift draw in [0, j]: the bias is below 2^-40 for these ranges
+                long long t = static_cast<long long>((static_cast<unsigned __int128>(rng()) * (j + 1)) >> 64);
+                chosen[chosen[t] ? j : t] = 1;
+            }
+            relation.clear();
+            for (long long cell = 0; cell < cells; cell++) {
+                if (!chosen[cell]) continue;
+                relation.add(static_cast<int>(cell / d) + 1, static_cast<int>(cell % d) + 1);
+                if (!cell_text.empty()) relation.text += cell_text[cell];
+            }
+            writer.constraint(scope.first, scope.second, relation, !cell_text.empty());
+        }
+        return;
+    }
+
+    long long target = options.target != 0 ? options.target : 2LL * d;
+    if (family == "inequality") fillRelation(relation, d, [](int a, int b) { return a != b; });
+    else if (family == "equality") fillRelation(relation, d, [](int a, int b) { return a == b; });
+    else if (family == "sum_target") fillRelation(relation, d, [target](int a, int b) { return a + b == target; });
+    else if (family == "sum_even") fillRelation(relation, d, [](int a, int b) { return (a + b) % 2 == 0; });
+    else if (family == "sum_odd") fillRelation(relation, d, [](int a, int b) { return (a + b) % 2 == 1; });
+    else fillRelation(relation, d, [](int a, int b) { return a > b; });
+    for (const auto& scope : scopes) {
+        writer.constraint(scope.first, scope.second, relation, true);
+    }
+}
+
+// Symmetry (row, column) -> image(row, column) of the board, columns
+// numbered from 1; fixed squares are omitted
+template <typename Image>
+vector<LiteralImage> boardSymmetry(int n, Image image) {
+    vector<LiteralImage> symmetry;
+    for (int row = 0; row < n; row++) {
+        for (int column = 1; column <= n; column++) {
+            pair<int, int> target = image(row, column);
+            if (target != make_pair(row, column)) {
+                symmetry.push_back(LiteralImage{row, column, target.first, target.second});
+            }
+        }
+    }
+    return symmetry;
+}
+
+// Same model as generate_nqueens.py: for each pair of rows, one constraint
+// for the column and one for each diagonal. The header declares the
+// quarter turn and the mirror image of the board, which generate its 8
+// symmetries.
+void generateNQueens(int n, InstanceWriter& writer) {
+    writer.variables({"CSP pour le problème des n-reines",
+                      "Échiquier " + to_string(n) + "x" + to_string(n) + ", " + to_string(n) + " reines à placer",
+                      "Variables: " + to_string(n) + " (une par ligne)",
+                      "Domaines: [1, " + to_string(n) + "] (positions des colonnes)",
+                      "Contraintes: pas d'attaque entre reines"},
+                     n, sameDomains(n, 1, n),
+                     {boardSymmetry(n, [n](int row, int column) { return make_pair(column - 1, n - row); }),
+                      boardSymmetry(n, [n](int row, int column) { return make_pair(row, n + 1 - column); })});
+    writer.constraintCount(3LL * (static_cast<long long>(n) * (n - 1) / 2));
+
+    Relation column;
+    fillRelation(column, n, [](int a, int b) { return a != b; });
+    // The diagonal relations only depend on the distance between the rows
+    vector<Relation> rising(n), falling(n);
+    for (int distance = 1; distance < n; distance++) {
+        fillRelation(rising[distance], n, [distance](int a, int b) { return b - a != distance; });
+        fillRelation(falling[distance], n, [distance](int a, int b) { return a - b != distance; });
+    }
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) {
+            writer.constraint(i, j, column, true);
+            writer.constraint(i, j, rising[j - i], true);
+            writer.constraint(i, j, falling[j - i], true);
+        }
+    }
+}
+
+void generateNRooks(int n, InstanceWriter& writer) {
+    writer.variables({"CSP pour le problème des n-tours",
+                      "Échiquier " + to_string(n) + "x" + to_string(n) + ", " + to_string(n) + " tours à placer",
+                      "Variables: " + to_string(n) + " (une par ligne)",
+                      "Domaines: [1, " + to_string(n) + "] (positions des colonnes)",
+                      "Contraintes: pas d'attaque entre tours (lignes et colonnes)"},
+                     n, sameDomains(n, 1, n));
+    writer.constraintCount(static_cast<long long>(n) * (n - 1) / 2);
+
+    Relation relation;
+    fillRelation(relation, n, [](int a, int b) { return a != b; });
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) {
+            writer.constraint(i, j, relation, true);
+        }
+    }
+}
+
+// DIMACS graph: "p edge n m" then "e u v" lines, vertices numbered from 1
+bool readColFile(const string& filename, int& vertices, vector<pair<int, int>>& edges) {
+    ifstream file(filename);
+    if (!file) {
+        cerr << "Error: cannot open " << filename << endl;
+        return false;
+    }
+    vertices = 0;
+    string line;
+    while (getline(file, line)) {
+        istringstream fields(line);
+        string kind;
+        fields >> kind;
+        if (kind == "p") {
+            string format;
+            fields >> format >> vertices;
+        } else if (kind == "e") {
+            int u, v;
+            if (!(fields >> u >> v) || u < 1 || v < 1 || u > vertices || v > vertices) {
+                cerr << "Error: invalid edge in " << filename << ": " << line << endl;
+                return false;
+            }
+            edges.emplace_back(u - 1, v - 1);
+        }
+    }
+    if (vertices < 1) {
+        cerr << "Error: no \"p edge\" line in " << filename << endl;
+        return false;
+    }
+    return true;
+}
+
+// Graph coloring with k colors: one inequality per edge
+bool generateColoring(const Options& options, InstanceWriter& writer, Random& rng) {
+    int vertices;
+    vector<pair<int, int>> edges;
+    string source;
+    if (!options.col_file.empty()) {
+        if (!readColFile(options.col_file, vertices, edges)) return false;
+        source = options.col_file;
+    } else {
+        vertices = static_cast<int>(options.variables);
+        long long max_edges = static_cast<long long>(vertices) * (vertices - 1) / 2;
+        edges = samplePairs(vertices, min(options.constraints, max_edges), rng);
+        source = "random graph";
+    }
+    int k = options.colors;
+    writer.variables({"Graph coloring with " + to_string(k) + " colors (" + source + ")",
+                      "Variables: " + to_string(vertices) + " (one per vertex), Domain size: " + to_string(k),
+                      "Constraints: " + to_string(edges.size()) + " (one inequality per edge)"},
+                     vertices, sameDomains(vertices, 1, k));
+    writer.constraintCount(static_cast<long long>(edges.size()));
+
+    Relation relation;
+    fillRelation(relation, k, [](int a, int b) { return a != b; });
+    for (const auto& edge : edges) {
+        writer.constraint(edge.first, edge.second, relation, true);
+    }
+    return true;
+}
+
+struct Operation {
+    int machine;
+    int duration;
+};
+
+// OR-Library layout: "jobs machines" then, per job, (machine, duration)
+// pairs in processing order; lines starting with '#' are skipped
+bool readJsspFile(const string& filename, vector<vector<Operation>>& jobs) {
+    ifstream file(filename);
+    if (!file) {
+        cerr << "Error: cannot open " << filename << endl;
+        return false;
+    }
+    string content, line;
+    while (getline(file, line)) {
+        if (!line.empty() && line[0] == '#') continue;
+        content += line + "\n";
+    }
+    istringstream fields(content);
+    int num_jobs = 0, num_machines = 0;
+    if (!(fields >> num_jobs >> num_machines) || num_jobs < 1 || num_machines < 1) {
+        cerr << "Error: " << filename << " does not start with \"jobs machines\"" << endl;
+        return false;
+    }
+    jobs.assign(num_jobs, vector<Operation>(num_machines));
+    for (auto& job : jobs) {
+        for (auto& operation : job) {
+            if (!(fields >> operation.machine >> operation.duration) || operation.machine < 0 ||
+                operation.machine >= num_machines || operation.duration < 1) {
+                cerr << "Error: invalid or missing operation in " << filename << endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Taillard-style instance: each job visits every machine once in a random
+// order, durations uniform in [1, max_duration]
+vector<vector<Operation>> randomJssp(const Options& options, Random& rng) {
+    uniform_int_distribution<int> duration(1, options.max_duration);
+    vector<vector<Operation>> jobs(options.jobs);
+    vector<int> order(options.machines);
+    for (auto& job : jobs) {
+        for (int m = 0; m < options.machines; m++) order[m] = m;
+        shuffle(order.begin(), order.end(), rng);
+        for (int m = 0; m < options.machines; m++) {
+            job.push_back({order[m], duration(rng)});
+        }
+    }
+    return jobs;
+}
+
+// Start time s of each operation in [0, K - duration]; s_next >= s + d
+// within a job, and s_a + d_a <= s_b or s_b + d_b <= s_a for two operations
+// on the same machine. Satisfiable iff the makespan can be at most K.
+bool generateJssp(const Options& options, InstanceWriter& writer, Random& rng) {
+    vector<vector<Operation>> jobs;
+    string source;
+    if (!options.jssp_file.empty()) {
+        if (!readJsspFile(options.jssp_file, jobs)) return false;
+        source = options.jssp_file;
+    } else {
+        jobs = randomJssp(options, rng);
+        source = "random";
+    }
+    int horizon = options.horizon;
+    vector<int> duration;
+    vector<vector<int>> on_machine;
+    vector<pair<int, int>> domains;
+    for (const auto& job : jobs) {
+        for (const auto& operation : job) {
+            if (operation.duration > horizon) {
+                cerr << "Error: the horizon " << horizon << " is shorter than an operation (" << operation.duration << ")" << endl;
+                return false;
+            }
+            if (static_cast<size_t>(operation.machine) >= on_machine.size()) on_machine.resize(operation.machine + 1);
+            on_machine[operation.machine].push_back(static_cast<int>(duration.size()));
+            domains.emplace_back(0, horizon - operation.duration);
+            duration.push_back(operation.duration);
+        }
+    }
+    int num_variables = static_cast<int>(duration.size());
+    long long precedences = 0, disjunctions = 0;
+    for (const auto& job : jobs) precedences += static_cast<long long>(job.size()) - 1;
+    for (const auto& ops : on_machine) disjunctions += static_cast<long long>(ops.size()) * (static_cast<long long>(ops.size()) - 1) / 2;
+
+    writer.variables({"Job-shop scheduling (" + source + "), horizon " + to_string(horizon),
+                      "Jobs: " + to_string(jobs.size()) + ", Machines: " + to_string(on_machine.size()),
+                      "Variables: " + to_string(num_variables) + " (start time of each operation, job by job)",
+                      "Constraints: " + to_string(precedences) + " precedences, " + to_string(disjunctions) + " machine disjunctions"},
+                     num_variables, domains);
+    writer.constraintCount(precedences + disjunctions);
+
+    Relation relation;
+    int first = 0;
+    for (const auto& job : jobs) {
+        for (size_t k = 0; k + 1 < job.size(); k++) {
+            int a = first + static_cast<int>(k);
+            int b = a + 1;
+            relation.clear();
+            for (int sa = 0; sa <= domains[a].second; sa++) {
+                for (int sb = sa + duration[a]; sb <= domains[b].second; sb++) relation.add(sa, sb);
+            }
+            writer.constraint(a, b, relation, false);
+        }
+        first += static_cast<int>(job.size());
+    }
+    for (const auto& ops : on_machine) {
+        for (size_t x = 0; x < ops.size(); x++) {
+            for (size_t y = x + 1; y < ops.size(); y++) {
+                int a = ops[x], b = ops[y];
+                relation.clear();
+                for (int sa = 0; sa <= domains[a].second; sa++) {
+                    for (int sb = 0; sb <= domains[b].second; sb++) {
+                        if (sa + duration[a] <= sb || sb + duration[b] <= sa) relation.add(sa, sb);
+                    }
+                }
+                writer.constraint(a, b, relation, false);
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    FILE* file = stdout;
+    if (!options.output.empty()) {
+        file = fopen(options.output.c_str(), "wb");
+        if (!file) {
+            cerr << "Error: cannot write " << options.output << endl;
+            return 1;
+        }
+    }
+
+    auto start = chrono::steady_clock::now();
+    Random rng(options.seed);
+    InstanceWriter writer(file, options.binary);
+    bool ok = true;
+    if (isPairFamily(options.family)) {
+        generatePairFamily(options, writer, rng);
+    } else if (options.family == "nqueens") {
+        generateNQueens(static_cast<int>(options.variables), writer);
+    } else if (options.family == "nrooks") {
+        generateNRooks(static_cast<int>(options.variables), writer);
+    } else if (options.family == "coloring") {
+        ok = generateColoring(options, writer, rng);
+    } else {
+        ok = generateJssp(options, writer, rng);
+    }
+    ok = writer.finish() && ok;
+    if (file != stdout && fclose(file) != 0) {
+        ok = false;
+    }
+    if (!ok) {
+        cerr << "Error: generation failed" << endl;
+        return 1;
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    double megabytes = writer.getBytes() / 1e6;
+    cerr << "Generated " << options.family << ": " << writer.getConstraints() << " constraints, "
+         << writer.getTuples() << " tuples, " << megabytes << " MB in " << seconds << " s ("
+         << (seconds > 0 ? megabytes / seconds : 0.0) << " MB/s)" << endl;
+    return 0;
+}
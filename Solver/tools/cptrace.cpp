@@ -0,0 +1,206 @@
+// Converter of the binary search traces written by CPSolver --trace, for
+// notebooks and figures: a summary (events per kind and per depth), every
+// event as CSV, or the search tree as a Graphviz DOT graph.
+//
+//   cptrace summary <trace>
+//   cptrace csv <trace> [-o out.csv]
+//   cptrace dot <trace> [-o out.dot] [--max-nodes n]
+//
+// In the DOT graph, each accepted assignment is a node below its parent
+// decision; rejected values are red (conflict) or orange (wipeout) leaves,
+// solutions are green, AC-3 removals label the node they happened at and
+// CBJ backjumps are dashed blue edges to the decision they return to.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include "../src/io/trace_writer.h"
+
+using namespace std;
+
+namespace {
+
+struct Options {
+    string command;
+    string trace;
+    string output;          // Empty: standard output
+    long long max_nodes = 5000;
+};
+
+void printUsage() {
+    cerr << "Usage: cptrace summary <trace>" << endl;
+    cerr << "       cptrace csv <trace> [-o out.csv]" << endl;
+    cerr << "       cptrace dot <trace> [-o out.dot] [--max-nodes n]  (default: 5000 nodes)" << endl;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    if (argc < 3) {
+        printUsage();
+        return false;
+    }
+    options.command = argv[1];
+    options.trace = argv[2];
+    if (options.command != "summary" && options.command != "csv" && options.command != "dot") {
+        cerr << "Unknown command: " << options.command << endl;
+        printUsage();
+        return false;
+    }
+    for (int i = 3; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (arg == "--max-nodes" && i + 1 < argc) {
+            options.max_nodes = stoll(argv[++i]);
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+int summary(TraceReader& reader) {
+    long long kinds[TRACE_KIND_COUNT] = {};
+    vector<long long> assigns_per_depth;
+    long long events = 0;
+    long long pruned = 0;
+    int max_depth = 0;
+    map<int, long long> streams;
+    int stream;
+    TraceEvent event;
+    while (reader.next(stream, event)) {
+        events++;
+        streams[stream]++;
+        if (event.kind < TRACE_KIND_COUNT) kinds[event.kind]++;
+        pruned += event.pruned;
+        max_depth = max(max_depth, static_cast<int>(event.depth));
+        if (event.kind == static_cast<uint8_t>(TraceKind::ASSIGN)) {
+            if (assigns_per_depth.size() <= event.depth) assigns_per_depth.resize(event.depth + 1, 0);
+            assigns_per_depth[event.depth]++;
+        }
+    }
+    cout << "Variables: " << reader.getNumVariables() << endl;
+    cout << "Events: " << events << " in " << streams.size() << " stream(s)" << endl;
+    cout << "Maximum depth: " << max_depth << endl;
+    cout << "Values pruned: " << pruned << endl;
+    for (int k = 0; k < TRACE_KIND_COUNT; k++) {
+        cout << "  " << traceKindName(static_cast<TraceKind>(k)) << ": " << kinds[k] << endl;
+    }
+    cout << "Assignments per depth:" << endl;
+    for (size_t depth = 0; depth < assigns_per_depth.size(); depth++) {
+        cout << "  " << depth << ": " << assigns_per_depth[depth] << endl;
+    }
+    return 0;
+}
+
+int writeCsv(TraceReader& reader, ostream& out) {
+    out << "stream,event,kind,depth,var,value,pruned" << endl;
+    long long index = 0;
+    int stream;
+    TraceEvent event;
+    while (reader.next(stream, event)) {
+        out << stream << "," << index++ << "," << traceKindName(static_cast<TraceKind>(event.kind)) << ","
+            << event.depth << "," << event.var << "," << event.value << "," << event.pruned << "\n";
+    }
+    return out ? 0 : 1;
+}
+
+// The events of a stream are in depth-first order: the parent of an event
+// at depth d is the last assignment made at depth d - 1
+int writeDot(TraceReader& reader, ostream& out, long long max_nodes) {
+    out << "digraph search {" << endl;
+    out << "  node [shape=ellipse, fontsize=10];" << endl;
+    map<int, vector<string>> paths; // Node on the current branch at each depth, per stream
+    long long nodes = 0;
+    bool truncated = false;
+    int stream;
+    TraceEvent event;
+    while (reader.next(stream, event)) {
+        vector<string>& path = paths[stream];
+        if (path.empty()) {
+            path.push_back("s" + to_string(stream) + "_root");
+            out << "  " << path[0] << " [label=\"root\", shape=box];" << endl;
+        }
+        size_t depth = event.depth;
+        if (depth >= path.size()) continue; // Below a truncated branch
+        TraceKind kind = static_cast<TraceKind>(event.kind);
+        string label = "x" + to_string(event.var) + "=" + to_string(event.value);
+
+        switch (kind) {
+            case TraceKind::ASSIGN:
+            case TraceKind::CONFLICT:
+            case TraceKind::WIPEOUT: {
+                if (nodes >= max_nodes) {
+                    truncated = true;
+                    path.resize(depth + 1);
+                    continue;
+                }
+                string id = "n" + to_string(nodes++);
+                out << "  " << id << " [label=\"" << label;
+                if (event.pruned > 0) out << "\\n-" << event.pruned;
+                out << "\"";
+                if (kind == TraceKind::CONFLICT) out << ", color=red, fontcolor=red";
+                if (kind == TraceKind::WIPEOUT) out << ", color=orange, fontcolor=orange";
+                out << "];" << endl;
+                out << "  " << path[depth] << " -> " << id << ";" << endl;
+                path.resize(depth + 1);
+                if (kind == TraceKind::ASSIGN) path.push_back(id);
+                break;
+            }
+            case TraceKind::PROPAGATE:
+                out << "  " << path[depth] << " [xlabel=\"AC -" << event.pruned << "\"];" << endl;
+                break;
+            case TraceKind::PROPAGATE_FAIL:
+                out << "  " << path[depth] << " [color=red, xlabel=\"AC wipeout x" << event.var << "\"];" << endl;
+                break;
+            case TraceKind::SOLUTION:
+                out << "  " << path[depth] << " [style=filled, fillcolor=palegreen];" << endl;
+                break;
+            case TraceKind::BACKJUMP:
+                if (event.value >= 0 && static_cast<size_t>(event.value) + 1 < path.size()) {
+                    out << "  " << path[depth] << " -> " << path[event.value + 1]
+                        << " [style=dashed, color=blue, constraint=false];" << endl;
+                }
+                break;
+        }
+    }
+    out << "}" << endl;
+    if (truncated) {
+        cerr << "Warning: graph truncated to " << max_nodes << " nodes (--max-nodes)" << endl;
+    }
+    return out ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    TraceReader reader;
+    string error;
+    if (!reader.open(options.trace, error)) {
+        cerr << "Error: " << error << endl;
+        return 1;
+    }
+    if (options.command == "summary") {
+        return summary(reader);
+    }
+
+    ofstream file;
+    if (!options.output.empty()) {
+        file.open(options.output);
+        if (!file) {
+            cerr << "Error: cannot write " << options.output << endl;
+            return 1;
+        }
+    }
+    ostream& out = options.output.empty() ? cout : file;
+    return options.command == "csv" ? writeCsv(reader, out) : writeDot(reader, out, options.max_nodes);
+}
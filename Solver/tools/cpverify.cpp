@@ -0,0 +1,394 @@
+// Verifier of solution files: every solution of a .sol file (CPSolver or
+// Gurobi format, lines "var=value ...") is checked against the domains and
+// all the constraints of the instance, compiled into the bitset model. The
+// file is read in blocks that are parsed and checked on a thread pool;
+// duplicates are found from a 128-bit hash of each solution, and the count
+// can be compared with the file header and with a reference count. The file
+// of a resumed run lists only the solutions found after the resume; the
+// ones its header says were found by previous runs are added to the count.
+//
+//   cpverify <instance.csp> <solutions.sol> [-p threads] [--expect count]
+//            [--max-errors n]
+//
+// Exit status 0 when every solution is valid, none is repeated and the
+// counts match; 1 otherwise.
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <algorithm>
+#include <memory>
+#include <cstring>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include "../src/parser/parser.h"
+#include "../src/core/compiled_model.h"
+#include "../src/core/thread_pool.h"
+
+using namespace std;
+
+namespace {
+
+const size_t BLOCK_SIZE = 4 << 20; // Bytes of .sol text per task
+
+struct Options {
+    string instance;
+    string solutions;
+    int num_threads = 0;
+    long long expected = -1;   // --expect (-1: not checked)
+    int max_errors = 10;       // Invalid solutions and duplicates printed
+};
+
+// One solution, identified by its hash and its position in the block
+struct SolutionKey {
+    uint64_t h1;
+    uint64_t h2;
+    long long index;
+};
+
+struct Failure {
+    long long index;           // Solution number in the block (global once merged)
+    string message;
+};
+
+// Result of one block
+struct BlockResult {
+    long long solutions = 0;
+    long long invalid = 0;
+    long long declared = -1;   // "# Solutions found: n" seen in the block
+    long long resumed = 0;     // "# Resumed from: ... (solutions 1-k ...)" seen in the block
+    vector<Failure> failures;  // At most max_errors
+    vector<SolutionKey> keys;
+};
+
+void printUsage() {
+    cerr << "Usage: cpverify <instance.csp> <solutions.sol> [-p threads] [--expect count] [--max-errors n]" << endl;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    if (argc < 3) {
+        printUsage();
+        return false;
+    }
+    options.instance = argv[1];
+    options.solutions = argv[2];
+    for (int i = 3; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-p" && i + 1 < argc) {
+            options.num_threads = stoi(argv[++i]);
+        } else if (arg == "--expect" && i + 1 < argc) {
+            options.expected = stoll(argv[++i]);
+        } else if (arg == "--max-errors" && i + 1 < argc) {
+            options.max_errors = stoi(argv[++i]);
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+inline uint64_t mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Reads an integer at p (optional sign); false if there is none
+inline bool readInt(const char*& p, const char* end, long long& value) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    if (p == end || *p < '0' || *p > '9') return false;
+    value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        p++;
+    }
+    if (negative) value = -value;
+    return true;
+}
+
+// Relations of the model, each once, with its two variables
+struct CheckedRelation {
+    int var1;
+    int var2;
+    const CompiledRelation* relation;
+};
+
+class Verifier {
+private:
+    const CompiledModel& model;
+    vector<CheckedRelation> relations;
+    int max_errors;
+
+    void fail(BlockResult& result, long long index, const string& message) const {
+        if (static_cast<int>(result.failures.size()) < max_errors) {
+            result.failures.push_back(Failure{index, message});
+        }
+    }
+
+    // Header line: keeps the solution count it declares
+    static void readHeader(const char* p, const char* end, BlockResult& result) {
+        static const string LABELS[] = {"# Solutions found:", "# Number of solutions found:"};
+        for (const string& label : LABELS) {
+            if (static_cast<size_t>(end - p) > label.size() && equal(label.begin(), label.end(), p)) {
+                p += label.size();
+                while (p < end && *p == ' ') p++;
+                long long count;
+                if (readInt(p, end, count)) result.declared = count;
+            }
+        }
+        static const string RESUMED = "# Resumed from:";
+        static const string PREVIOUS = "(solutions 1-";
+        if (static_cast<size_t>(end - p) > RESUMED.size() && equal(RESUMED.begin(), RESUMED.end(), p)) {
+            const char* found = search(p, end, PREVIOUS.begin(), PREVIOUS.end());
+            long long count;
+            if (found != end && readInt(found += PREVIOUS.size(), end, count)) result.resumed = count;
+        }
+    }
+
+public:
+    Verifier(const CompiledModel& compiled_model, int errors) : model(compiled_model), max_errors(errors) {
+        for (int var = 0; var < model.getNumVariables(); var++) {
+            for (int index : model.getArcsFrom(var)) {
+                const CompiledArc& arc = model.getArc(index);
+                if (!arc.transposed) {
+                    relations.push_back(CheckedRelation{arc.var, arc.neighbor, &model.getRelation(arc.relation)});
+                }
+            }
+        }
+    }
+
+    // Parses and checks the solution lines of [begin, end)
+    void checkBlock(const char* begin, const char* end, BlockResult& result) const {
+        int n = model.getNumVariables();
+        vector<long long> values(n);
+        vector<char> assigned(n);
+
+        const char* line = begin;
+        while (line < end) {
+            const char* line_end = static_cast<const char*>(memchr(line, '\n', end - line));
+            if (!line_end) line_end = end;
+            const char* p = line;
+            line = line_end + 1;
+            while (p < line_end && (*p == ' ' || *p == '\t')) p++;
+            if (p < line_end && *p == '#') {
+                readHeader(p, line_end, result);
+                continue;
+            }
+            // Anything else than "var=value" pairs (logo, NO SOLUTION) is text
+            if (p == line_end || !((*p >= '0' && *p <= '9') || *p == '-') ||
+                !memchr(p, '=', line_end - p)) {
+                continue;
+            }
+
+            long long index = result.solutions++;
+            fill(assigned.begin(), assigned.end(), 0);
+            string error;
+            while (p < line_end && error.empty()) {
+                long long var, value;
+                if (!readInt(p, line_end, var) || p == line_end || *p != '=' || !readInt(++p, line_end, value)) {
+                    error = "malformed assignment";
+                    break;
+                }
+                if (var < 0 || var >= n) {
+                    error = "unknown variable " + to_string(var);
+                } else if (assigned[var]) {
+                    error = "variable " + to_string(var) + " assigned twice";
+                } else {
+                    assigned[var] = 1;
+                    values[var] = value;
+                }
+                while (p < line_end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+            }
+            for (int var = 0; var < n && error.empty(); var++) {
+                long long value_index = values[var] - model.getOffset(var);
+                if (!assigned[var]) {
+                    error = "variable " + to_string(var) + " missing";
+                } else if (value_index < 0 || value_index >= model.getSize(var)) {
+                    error = to_string(var) + "=" + to_string(values[var]) + " outside the domain [" +
+                            to_string(model.getOffset(var)) + ", " +
+                            to_string(model.getOffset(var) + model.getSize(var) - 1) + "]";
+                }
+            }
+            if (error.empty()) {
+                for (const CheckedRelation& checked : relations) {
+                    int a = static_cast<int>(values[checked.var1] - model.getOffset(checked.var1));
+                    int b = static_cast<int>(values[checked.var2] - model.getOffset(checked.var2));
+                    if (!checked.relation->allows(a, b)) {
+                        error = "constraint (" + to_string(checked.var1) + ", " + to_string(checked.var2) +
+                                ") violated by " + to_string(checked.var1) + "=" + to_string(values[checked.var1]) +
+                                ", " + to_string(checked.var2) + "=" + to_string(values[checked.var2]);
+                        break;
+                    }
+                }
+            }
+            if (!error.empty()) {
+                result.invalid++;
+                fail(result, index, error);
+                continue;
+            }
+
+            uint64_t h1 = 0x9e3779b97f4a7c15ULL;
+            uint64_t h2 = 0x6a09e667f3bcc909ULL;
+            for (int var = 0; var < n; var++) {
+                h1 = mix(h1 ^ static_cast<uint64_t>(values[var]));
+                h2 = mix(h2 + static_cast<uint64_t>(values[var]) * 0x100000001b3ULL);
+            }
+            result.keys.push_back(SolutionKey{h1, h2, index});
+        }
+    }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    CSPInstance csp;
+    try {
+        csp = parseCSPFile(options.instance);
+    } catch (const exception& e) {
+        cerr << "Error: cannot read " << options.instance << ": " << e.what() << endl;
+        return 1;
+    }
+    CompiledModel model(csp);
+    Verifier verifier(model, options.max_errors);
+
+    ifstream file(options.solutions, ios::binary);
+    if (!file) {
+        cerr << "Error: cannot open " << options.solutions << endl;
+        return 1;
+    }
+
+    // Blocks end at a line end; at most two per thread are in memory
+    auto start = chrono::steady_clock::now();
+    int num_threads = ThreadPool::resolveThreadCount(options.num_threads);
+    vector<BlockResult> results;
+    mutex results_mutex;
+    condition_variable block_done;
+    int in_flight = 0;
+    {
+        ThreadPool pool(num_threads);
+        string carry;
+        while (file || !carry.empty()) {
+            auto block = make_shared<string>(move(carry));
+            carry.clear();
+            size_t previous = block->size();
+            block->resize(previous + BLOCK_SIZE);
+            file.read(&(*block)[previous], BLOCK_SIZE);
+            block->resize(previous + file.gcount());
+            if (file) {
+                size_t last_line = block->rfind('\n');
+                if (last_line == string::npos) {
+                    carry = move(*block); // Line longer than a block: read on
+                    continue;
+                }
+                carry.assign(*block, last_line + 1, string::npos);
+                block->resize(last_line + 1);
+            }
+            if (block->empty()) break;
+
+            size_t slot;
+            {
+                unique_lock<mutex> lock(results_mutex);
+                block_done.wait(lock, [&] { return in_flight < 2 * num_threads; });
+                in_flight++;
+                slot = results.size();
+                results.emplace_back();
+            }
+            pool.submit([&, block, slot] {
+                BlockResult result;
+                verifier.checkBlock(block->data(), block->data() + block->size(), result);
+                {
+                    lock_guard<mutex> lock(results_mutex);
+                    results[slot] = move(result);
+                    in_flight--;
+                }
+                block_done.notify_one();
+            });
+        }
+        pool.wait();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Solution numbers of the file (1-based), then the duplicates by hash
+    long long solutions = 0, invalid = 0, declared = -1, resumed = 0;
+    vector<Failure> failures;
+    vector<SolutionKey> keys;
+    for (BlockResult& result : results) {
+        for (Failure& failure : result.failures) {
+            failure.index += solutions + 1;
+            failures.push_back(move(failure));
+        }
+        for (SolutionKey& key : result.keys) {
+            key.index += solutions + 1;
+            keys.push_back(key);
+        }
+        if (result.declared >= 0) declared = result.declared;
+        if (result.resumed > 0) resumed = result.resumed;
+        solutions += result.solutions;
+        invalid += result.invalid;
+    }
+    sort(keys.begin(), keys.end(), [](const SolutionKey& a, const SolutionKey& b) {
+        return tie(a.h1, a.h2, a.index) < tie(b.h1, b.h2, b.index);
+    });
+    long long duplicates = 0;
+    for (size_t i = 1; i < keys.size(); i++) {
+        if (keys[i].h1 == keys[i - 1].h1 && keys[i].h2 == keys[i - 1].h2) {
+            size_t first = i - 1;
+            while (first > 0 && keys[first - 1].h1 == keys[i].h1 && keys[first - 1].h2 == keys[i].h2) first--;
+            if (duplicates < options.max_errors) {
+                failures.push_back(Failure{keys[i].index, "duplicate of solution " + to_string(keys[first].index)});
+            }
+            duplicates++;
+        }
+    }
+    sort(failures.begin(), failures.end(), [](const Failure& a, const Failure& b) { return a.index < b.index; });
+    long long distinct = solutions - invalid - duplicates;
+    // The declared and expected counts include the solutions of previous runs
+    long long total = solutions + resumed;
+
+    cout << "Instance: " << options.instance << " (" << csp.num_variables << " variables, "
+         << model.getConstrainedPairCount() << " constrained pairs)" << endl;
+    cout << "Solutions: " << solutions << " checked in " << fixed << setprecision(3) << seconds << " s ("
+         << setprecision(0) << (seconds > 0 ? solutions / seconds : 0.0) << "/s) on " << num_threads << " threads" << endl;
+    for (const Failure& failure : failures) {
+        cout << "  Solution " << failure.index << ": " << failure.message << endl;
+    }
+    cout << "Invalid: " << invalid << endl;
+    cout << "Duplicates: " << duplicates << endl;
+    if (resumed > 0) {
+        cout << "Resumed: " << resumed << " solutions found by previous runs (not listed)" << endl;
+    }
+
+    bool ok = invalid == 0 && duplicates == 0;
+    if (declared >= 0) {
+        if (solutions == 0 && declared > 0) {
+            cout << "Declared: " << declared << " (solutions not listed, count-only run)" << endl;
+        } else {
+            cout << "Declared: " << declared << (declared == total ? " (matches)" : " (MISMATCH)") << endl;
+            ok = ok && declared == total;
+        }
+    }
+    if (options.expected >= 0) {
+        cout << "Expected: " << options.expected << (options.expected == distinct + resumed ? " (matches)" : " (MISMATCH)") << endl;
+        ok = ok && options.expected == distinct + resumed;
+    }
+    cout << "Result: " << (ok ? "OK" : "FAILED") << endl;
+    return ok ? 0 : 1;
+}